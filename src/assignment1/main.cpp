@@ -14,6 +14,7 @@
 #include "../utils/Camera.h"
 #include "../utils/Model.h"
 #include "../utils/Renderer.h"
+#include "../utils/StreamingGeometry.h"
 
 #include <iostream>
 #include <string>
@@ -36,7 +37,7 @@ float toon_edge_threshold = 0.2f;
 float cook_roughness = 0.3f;
 float cook_f0 = 0.6f;
 
-int main()
+int main(int argc, char** argv)
 {
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -78,6 +79,22 @@ int main()
     Model toonModel(modelPath, "teacup-toon.vs", "teacup-toon.fs");
     Model cookModel(modelPath, "teacup-cook.vs", "teacup-cook.fs");
 
+    // `--stream <model>` also draws a (large) model out of core, behind the
+    // teacups, with the Blinn-Phong material.
+    std::shared_ptr<StreamingGeometry> streamed;
+    glm::mat4 streamedModel(1.0f);
+    if (argc > 2 && std::string(argv[1]) == "--stream") {
+        streamed = StreamingGeometry::Open(argv[2]);
+        if (streamed) {
+            // Fit it into a sphere of radius 5 around streamedPos.
+            glm::vec3 streamedPos(0.0f, 1.0f, -8.0f);
+            float scale = 5.0f / std::max(streamed->BoundsRadius(), 1e-6f);
+            streamedModel = glm::translate(glm::mat4(1.0f), streamedPos);
+            streamedModel = glm::scale(streamedModel, glm::vec3(scale));
+            streamedModel = glm::translate(streamedModel, -streamed->BoundsCenter());
+        }
+    }
+
     glm::vec3 relativeLightPos(5.0f, 6.0f, 10.0f);
     glm::vec3 leftPos(-0.5f, 1.0f, 0.0f);
     glm::vec3 middlePos(0.0f, 1.0f, 0.0f);
@@ -97,7 +114,7 @@ int main()
 
         {
             ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_Always);
-            ImGui::SetNextWindowSize(ImVec2(380, 280), ImGuiCond_Always);
+            ImGui::SetNextWindowSize(ImVec2(380, streamed ? 330 : 280), ImGuiCond_Always);
 
             ImGui::Begin("Shading Parameters");
             ImGui::Text("Adjust real-time lighting parameters:");
@@ -114,6 +131,15 @@ int main()
             ImGui::SliderFloat("Roughness", &cook_roughness, 0.01f, 1.0f, "%.3f", ImGuiSliderFlags_NoInput);
             ImGui::SliderFloat("F0", &cook_f0, 0.0f, 1.0f, "%.3f", ImGuiSliderFlags_NoInput);
 
+            if (streamed) {
+                const StreamingGeometry::Stats& stats = streamed->GetStats();
+                ImGui::SeparatorText("Streaming");
+                ImGui::Text("Chunks: %zu visible, %zu resident, %zu loading of %zu", stats.visible, stats.resident,
+                            stats.loading, stats.chunks);
+                ImGui::Text("GPU %.1f MB (+%.1f MB proxies), staged %.1f MB", stats.residentBytes / 1048576.0,
+                            stats.proxyBytes / 1048576.0, stats.stagedBytes / 1048576.0);
+            }
+
             ImGui::Separator();
             ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
             ImGui::End();
@@ -165,6 +191,15 @@ int main()
             });
         }
 
+        if (streamed) {
+            Renderer::Submit(*streamed, *bpModel.material, streamedModel, [&](Shader* s) {
+                s->setVec3("viewPos", camera.Position);
+                s->setVec3("lightPos", relativeLightPos);
+                s->setFloat("powValue", bp_pow);
+                s->setFloat("ks", bp_ks);
+            });
+        }
+
         Renderer::EndScene();
 
         ImGui::Render();
@@ -174,6 +209,7 @@ int main()
         glfwPollEvents();
     }
 
+    streamed.reset();
     Renderer::Shutdown();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
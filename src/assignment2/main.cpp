@@ -11,10 +11,17 @@
 #include <imgui/backends/imgui_impl_opengl3.h>
 
 #include "stb_image.h"
+#include "utils/AssetPack.h"
+#include "utils/HotReload.h"
+#include "utils/LoadProfiler.h"
 #include "utils/Renderer.h"
 #include "utils/Skybox.h"
+#include "utils/SkyboxResidency.h"
+#include "utils/TextureBaker.h"
 #include "utils/Camera.h"
-#include "utils/Model.h"
+#include "utils/AssetLoader.h"
+#include "utils/Geometry.h"
+#include "utils/Material.h"
 
 const std::filesystem::path RESOURCE_ROOT = "/Users/dodge/programs/avr/rtr/rtr-opengl/src/assignment2";
 
@@ -114,8 +121,19 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
     cameraDistance = std::clamp(cameraDistance, 5.0f, 100.0f);
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    // `--bench-obj` compares the native OBJ loader with Assimp and exits.
+    if (argc > 1 && std::string(argv[1]) == "--bench-obj")
+    {
+        Geometry::BenchmarkImport(Path("discoball/discoball.obj"));
+        return 0;
+    }
+
+    // Built by the assignment2_pack target; without it everything is read
+    // loose, and edits to shaders, textures and models reload while running.
+    if (!AssetPack::Mount("assignment2.pack", RESOURCE_ROOT)) HotReload::Start(RESOURCE_ROOT);
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -154,34 +172,49 @@ int main()
 
     Renderer::Init();
 
-    Model cubeReflectModel(RE("cube/cube.obj"), RE("cube/cube.vs"), RE("cube/reflect.fs"));
-    Model cubeRefractModel(RE("cube/cube.obj"), RE("cube/cube.vs"), RE("cube/refract.fs"));
-    Model cubeFresnelModel(RE("cube/cube.obj"), RE("cube/cube.vs"), RE("cube/fresnel.fs"));
-    Model cubeChromaticModel(RE("cube/cube.obj"), RE("cube/cube.vs"), RE("cube/chromatic.fs"));
-
-    Model ringReflectModel(RE("ring/ring.obj"), RE("ring/ring.vs"), RE("ring/reflect.fs"));
-    Model ringRefractModel(RE("ring/ring.obj"), RE("ring/ring.vs"), RE("ring/refract.fs"));
-    Model ringFresnelModel(RE("ring/ring.obj"), RE("ring/ring.vs"), RE("ring/fresnel.fs"));
-    Model ringChromaticModel(RE("ring/ring.obj"), RE("ring/ring.vs"), RE("ring/chromatic.fs"));
-
-    Model discoReflectModel(RE("discoball/discoball.obj"), RE("discoball/discoball.vs"),RE("discoball/reflect.fs"));
-    Model discoRefractModel(RE("discoball/discoball.obj"), RE("discoball/discoball.vs"),RE("discoball/refract.fs"));
-    Model discoFresnelModel(RE("discoball/discoball.obj"), RE("discoball/discoball.vs"),RE("discoball/fresnel.fs"));
-    Model discoChromaticModel(RE("discoball/discoball.obj"), RE("discoball/discoball.vs"),RE("discoball/chromatic.fs"));
-
-    Model diamondReflectModel(RE("diamond/diamond.obj"), RE("diamond/diamond.vs"), RE("diamond/reflect.fs"));
-    Model diamondRefractModel(RE("diamond/diamond.obj"), RE("diamond/diamond.vs"), RE("diamond/refract.fs"));
-    Model diamondFresnelModel(RE("diamond/diamond.obj"), RE("diamond/diamond.vs"), RE("diamond/fresnel.fs"));
-    Model diamondChromaticModel(RE("diamond/diamond.obj"), RE("diamond/diamond.vs"),RE("diamond/chromatic.fs"));
-
+    // One imported copy of each mesh, drawn by four shader variants. They load
+    // in the background and show up as soon as they are uploaded.
+    std::shared_ptr<Geometry> cubeGeometry = AssetLoader::LoadModelAsync(RE("cube/cube.obj")).geometry;
+    std::shared_ptr<Geometry> ringGeometry = AssetLoader::LoadModelAsync(RE("ring/ring.obj")).geometry;
+    std::shared_ptr<Geometry> discoGeometry = AssetLoader::LoadModelAsync(RE("discoball/discoball.obj")).geometry;
+    std::shared_ptr<Geometry> diamondGeometry = AssetLoader::LoadModelAsync(RE("diamond/diamond.obj")).geometry;
+
+    Material cubeReflectMaterial(RE("cube/cube.vs"), RE("cube/reflect.fs"));
+    Material cubeRefractMaterial(RE("cube/cube.vs"), RE("cube/refract.fs"));
+    Material cubeFresnelMaterial(RE("cube/cube.vs"), RE("cube/fresnel.fs"));
+    Material cubeChromaticMaterial(RE("cube/cube.vs"), RE("cube/chromatic.fs"));
+
+    Material ringReflectMaterial(RE("ring/ring.vs"), RE("ring/reflect.fs"));
+    Material ringRefractMaterial(RE("ring/ring.vs"), RE("ring/refract.fs"));
+    Material ringFresnelMaterial(RE("ring/ring.vs"), RE("ring/fresnel.fs"));
+    Material ringChromaticMaterial(RE("ring/ring.vs"), RE("ring/chromatic.fs"));
+
+    Material discoReflectMaterial(RE("discoball/discoball.vs"), RE("discoball/reflect.fs"));
+    Material discoRefractMaterial(RE("discoball/discoball.vs"), RE("discoball/refract.fs"));
+    Material discoFresnelMaterial(RE("discoball/discoball.vs"), RE("discoball/fresnel.fs"));
+    Material discoChromaticMaterial(RE("discoball/discoball.vs"), RE("discoball/chromatic.fs"));
+    // The disco ball is closed, so meshlets facing away can be skipped.
+    for (Material* material : {&discoReflectMaterial, &discoRefractMaterial, &discoFresnelMaterial,
+                               &discoChromaticMaterial})
+        material->cullBackfaces = true;
+
+    Material diamondReflectMaterial(RE("diamond/diamond.vs"), RE("diamond/reflect.fs"));
+    Material diamondRefractMaterial(RE("diamond/diamond.vs"), RE("diamond/refract.fs"));
+    Material diamondFresnelMaterial(RE("diamond/diamond.vs"), RE("diamond/fresnel.fs"));
+    Material diamondChromaticMaterial(RE("diamond/diamond.vs"), RE("diamond/chromatic.fs"));
+
+    // Only the first skybox is decoded before the first frame. The residency
+    // manager prefetches the next one in the TAB cycle and evicts the least
+    // recently shown ones once the budget (three or four cube maps) is exceeded.
     std::vector<Skybox> skyboxes;
     skyboxes.reserve(skybox_dirs.size());
     for (const auto& dirName : skybox_dirs)
     {
         auto faces = create_skybox_paths(dirName, "posx.jpg", "negx.jpg", "posy.jpg", "negy.jpg", "posz.jpg",
                                          "negz.jpg");
-        skyboxes.emplace_back(faces, RE("urban-skyboxes/skybox.vs"), RE("urban-skyboxes/skybox.fs"));
+        skyboxes.emplace_back(faces, RE("urban-skyboxes/skybox.vs"), RE("urban-skyboxes/skybox.fs"), false);
     }
+    SkyboxResidency residency(skyboxes, size_t(320) << 20, currentSkybox);
 
     while (!glfwWindowShouldClose(window))
     {
@@ -195,7 +228,7 @@ int main()
 
         {
             ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_Always);
-            ImGui::SetNextWindowSize(ImVec2(380, 280), ImGuiCond_Always);
+            ImGui::SetNextWindowSize(ImVec2(380, 385), ImGuiCond_Always);
             ImGui::Begin("Shading Parameters");
             ImGui::Text("Shading Parameters:");
 
@@ -224,6 +257,22 @@ int main()
                 ImGui::SliderFloat("Dispersion Value", &chromatic_dispersion, .0f, 1.f, "%.3f",
                                    ImGuiSliderFlags_NoInput);
             }
+
+            const RenderStats& stats = Renderer::GetStats();
+            ImGui::Text("Meshlets: %zu / %zu, triangles: %zu / %zu", stats.visibleMeshlets, stats.meshlets,
+                        stats.drawnTriangles, stats.triangles);
+            ImGui::Text("Meshes per LOD: %zu %zu %zu %zu", stats.lodMeshes[0], stats.lodMeshes[1], stats.lodMeshes[2],
+                        stats.lodMeshes[3]);
+            const SkyboxResidency::Stats& sky = residency.GetStats();
+            ImGui::Text("Skyboxes: %zu resident, %.0f / %.0f MB", sky.resident, sky.residentBytes / 1048576.0,
+                        residency.GetBudget() / 1048576.0);
+            ImGui::Text("Hits %zu, misses %zu, evictions %zu, switch %.1f ms (max %.1f)", sky.hits, sky.misses,
+                        sky.evictions, sky.lastSwitchMs, sky.maxSwitchMs);
+            if (ImGui::Button("Dump load profile"))
+            {
+                LoadProfiler::LogReport();
+                LoadProfiler::WriteChromeTrace("load-trace.json");
+            }
             ImGui::End();
         }
 
@@ -232,7 +281,7 @@ int main()
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        Skybox& skybox = skyboxes[currentSkybox % skyboxes.size()];
+        Skybox& skybox = residency.Select(currentSkybox);
 
         Renderer::BeginScene(camera, (float)window_width / (float)window_height);
         Renderer::SetSkybox(skybox);
@@ -243,7 +292,7 @@ int main()
             // Cube Row (Remains unchanged as baseline)
             {
                 glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(-6.0f, 10.0f, -5.0f));
-                Renderer::Submit(cubeReflectModel, model, [&](Shader* s)
+                Renderer::Submit(*cubeGeometry, cubeReflectMaterial, model, [&](Shader* s)
                 {
                     s->setVec3("cameraPos", camera.Position);
                     glActiveTexture(GL_TEXTURE1);
@@ -253,7 +302,7 @@ int main()
             }
             {
                 glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(-4.0f, 10.0f, -5.0f));
-                Renderer::Submit(cubeRefractModel, model, [&](Shader* s)
+                Renderer::Submit(*cubeGeometry, cubeRefractMaterial, model, [&](Shader* s)
                 {
                     s->setVec3("cameraPos", camera.Position);
                     glActiveTexture(GL_TEXTURE2);
@@ -263,7 +312,7 @@ int main()
             }
             {
                 glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(-2.0f, 10.0f, -5.0f));
-                Renderer::Submit(cubeFresnelModel, model, [&](Shader* s)
+                Renderer::Submit(*cubeGeometry, cubeFresnelMaterial, model, [&](Shader* s)
                 {
                     s->setVec3("cameraPos", camera.Position);
                     glActiveTexture(GL_TEXTURE3);
@@ -273,7 +322,7 @@ int main()
             }
             {
                 glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 10.0f, -5.0f));
-                Renderer::Submit(cubeChromaticModel, model, [&](Shader* s)
+                Renderer::Submit(*cubeGeometry, cubeChromaticMaterial, model, [&](Shader* s)
                 {
                     s->setVec3("cameraPos", camera.Position);
                     glActiveTexture(GL_TEXTURE4);
@@ -288,7 +337,7 @@ int main()
             model = glm::rotate(model, glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
             if (renderMode == 1)
             {
-                Renderer::Submit(ringReflectModel, model, [&](Shader* s)
+                Renderer::Submit(*ringGeometry, ringReflectMaterial, model, [&](Shader* s)
                 {
                     s->setVec3("cameraPos", camera.Position);
                     glActiveTexture(GL_TEXTURE5);
@@ -298,7 +347,7 @@ int main()
             }
             else if (renderMode == 2)
             {
-                Renderer::Submit(ringRefractModel, model, [&](Shader* s)
+                Renderer::Submit(*ringGeometry, ringRefractMaterial, model, [&](Shader* s)
                 {
                     s->setVec3("cameraPos", camera.Position);
                     glActiveTexture(GL_TEXTURE5);
@@ -309,7 +358,7 @@ int main()
             }
             else if (renderMode == 3)
             {
-                Renderer::Submit(ringFresnelModel, model, [&](Shader* s)
+                Renderer::Submit(*ringGeometry, ringFresnelMaterial, model, [&](Shader* s)
                 {
                     s->setVec3("cameraPos", camera.Position);
                     glActiveTexture(GL_TEXTURE5);
@@ -320,7 +369,7 @@ int main()
             }
             else if (renderMode == 4)
             {
-                Renderer::Submit(ringChromaticModel, model, [&](Shader* s)
+                Renderer::Submit(*ringGeometry, ringChromaticMaterial, model, [&](Shader* s)
                 {
                     s->setVec3("cameraPos", camera.Position);
                     glActiveTexture(GL_TEXTURE5);
@@ -338,7 +387,7 @@ int main()
             // Disco Row
             if (renderMode == 1)
             {
-                Renderer::Submit(discoReflectModel, model, [&](Shader* s)
+                Renderer::Submit(*discoGeometry, discoReflectMaterial, model, [&](Shader* s)
                 {
                     s->setVec3("cameraPos", camera.Position);
                     glActiveTexture(GL_TEXTURE6);
@@ -348,7 +397,7 @@ int main()
             }
             else if (renderMode == 2)
             {
-                Renderer::Submit(discoRefractModel, model, [&](Shader* s)
+                Renderer::Submit(*discoGeometry, discoRefractMaterial, model, [&](Shader* s)
                 {
                     s->setVec3("cameraPos", camera.Position);
                     glActiveTexture(GL_TEXTURE6);
@@ -359,7 +408,7 @@ int main()
             }
             else if (renderMode == 3)
             {
-                Renderer::Submit(discoFresnelModel, model, [&](Shader* s)
+                Renderer::Submit(*discoGeometry, discoFresnelMaterial, model, [&](Shader* s)
                 {
                     s->setVec3("cameraPos", camera.Position);
                     glActiveTexture(GL_TEXTURE6);
@@ -370,7 +419,7 @@ int main()
             }
             else if (renderMode == 4)
             {
-                Renderer::Submit(discoChromaticModel, model, [&](Shader* s)
+                Renderer::Submit(*discoGeometry, discoChromaticMaterial, model, [&](Shader* s)
                 {
                     s->setVec3("cameraPos", camera.Position);
                     glActiveTexture(GL_TEXTURE6);
@@ -388,7 +437,7 @@ int main()
             diamondModel = glm::scale(diamondModel, glm::vec3(0.01f));
             if (renderMode == 1)
             {
-                Renderer::Submit(diamondReflectModel, diamondModel, [&](Shader* s)
+                Renderer::Submit(*diamondGeometry, diamondReflectMaterial, diamondModel, [&](Shader* s)
                 {
                     s->setVec3("cameraPos", camera.Position);
                     glActiveTexture(GL_TEXTURE7);
@@ -398,7 +447,7 @@ int main()
             }
             else if (renderMode == 2)
             {
-                Renderer::Submit(diamondRefractModel, diamondModel, [&](Shader* s)
+                Renderer::Submit(*diamondGeometry, diamondRefractMaterial, diamondModel, [&](Shader* s)
                 {
                     s->setVec3("cameraPos", camera.Position);
                     glActiveTexture(GL_TEXTURE7);
@@ -409,7 +458,7 @@ int main()
             }
             else if (renderMode == 3)
             {
-                Renderer::Submit(diamondFresnelModel, diamondModel, [&](Shader* s)
+                Renderer::Submit(*diamondGeometry, diamondFresnelMaterial, diamondModel, [&](Shader* s)
                 {
                     s->setVec3("cameraPos", camera.Position);
                     glActiveTexture(GL_TEXTURE7);
@@ -420,7 +469,7 @@ int main()
             }
             else if (renderMode == 4)
             {
-                Renderer::Submit(diamondChromaticModel, diamondModel, [&](Shader* s)
+                Renderer::Submit(*diamondGeometry, diamondChromaticMaterial, diamondModel, [&](Shader* s)
                 {
                     s->setVec3("cameraPos", camera.Position);
                     glActiveTexture(GL_TEXTURE7);
@@ -440,6 +489,9 @@ int main()
         glfwPollEvents();
     }
 
+    TextureBaker::LogReport();
+    LoadProfiler::LogReport();
+    LoadProfiler::WriteChromeTrace("load-trace.json");
     Renderer::Shutdown();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -30,6 +30,19 @@ uniform float shininess;
 
 const float PI = 3.14159265359;
 
+// Diffuse irradiance of the skybox over pi as L2 spherical harmonics, filled
+// in by the Renderer.
+layout(std140) uniform EnvironmentSH {
+    vec4 u_SH[9];
+};
+
+vec3 shIrradiance(vec3 n) {
+    return u_SH[0].rgb
+         + u_SH[1].rgb * n.y + u_SH[2].rgb * n.z + u_SH[3].rgb * n.x
+         + u_SH[4].rgb * (n.x * n.y) + u_SH[5].rgb * (n.y * n.z) + u_SH[6].rgb * (3.0 * n.z * n.z - 1.0)
+         + u_SH[7].rgb * (n.x * n.z) + u_SH[8].rgb * (n.x * n.x - n.y * n.y);
+}
+
 float getHeight(vec2 uv) {
     return texture(material.texture_diffuse1, uv).r;
 }
@@ -141,8 +154,9 @@ void main()
         normal = normalize(fs_in.TBN * tangentNormal);
     }
     else if (mappingMode == 2) { // Normal Map
-        normal = texture(material.texture_normal1, fs_in.TexCoords).rgb;
-        normal = normal * 2.0 - 1.0;
+        // Normal maps are baked to BC5 (two channels), so z is rebuilt from xy.
+        normal.xy = texture(material.texture_normal1, fs_in.TexCoords).rg * 2.0 - 1.0;
+        normal.z = sqrt(max(1.0 - dot(normal.xy, normal.xy), 0.0));
         normal = normalize(fs_in.TBN * normal);
     }
     else { // None
@@ -165,7 +179,10 @@ void main()
         resultColor = ambient + CalculateBlinnPhong(normal, viewDir, lightDir, albedo, specularMap, lightColor);
     }
     else {
-        // Cook-Torrance
+        // Cook-Torrance, with the skybox as diffuse ambient
+        vec3 F0 = mix(vec3(0.04), albedo, metallic);
+        vec3 kD = (vec3(1.0) - fresnelSchlick(max(dot(normal, viewDir), 0.0), F0)) * (1.0 - metallic);
+        ambient = kD * albedo * shIrradiance(normal);
         vec3 Lo = CalculateCookTorrance(normal, viewDir, lightDir, albedo, lightColor * 2.0);
         resultColor = ambient + Lo;
 
@@ -2,8 +2,7 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
-layout (location = 3) in vec3 aTangent;
-layout (location = 4) in vec3 aBitangent;
+layout (location = 3) in vec4 aTangent; // w = bitangent handedness
 
 out VS_OUT {
     vec3 FragPos;
@@ -20,8 +19,10 @@ void main()
     vs_out.FragPos = vec3(model * vec4(aPos, 1.0));
     vs_out.TexCoords = aTexCoords;
 
-    vec3 T = normalize(vec3(model * vec4(aTangent,   0.0)));
-    vec3 B = normalize(vec3(model * vec4(aBitangent, 0.0)));
+    float handedness = aTangent.w < 0.0 ? -1.0 : 1.0;
+    vec3 aBitangent = cross(aNormal, aTangent.xyz) * handedness;
+    vec3 T = normalize(vec3(model * vec4(aTangent.xyz, 0.0)));
+    vec3 B = normalize(vec3(model * vec4(aBitangent,   0.0)));
     vec3 N = normalize(vec3(model * vec4(aNormal,    0.0)));
 
     vs_out.TBN = mat3(T, B, N);
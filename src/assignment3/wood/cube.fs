@@ -22,10 +22,13 @@ void main()
 {
     // --- 臣之核心逻辑：Normal Mapping ---
     // 1. 采样法线贴图 [0, 1]
-    vec3 normal = texture(material.texture_normal1, fs_in.TexCoords).rgb;
+    // BC5 只保存 xy 两个通道
+    vec3 normal;
+    normal.xy = texture(material.texture_normal1, fs_in.TexCoords).rg;
 
-    // 2. 将范围从 [0, 1] 映射回 [-1, 1]
-    normal = normal * 2.0 - 1.0;
+    // 2. 将范围从 [0, 1] 映射回 [-1, 1]，再由 xy 重建 z
+    normal.xy = normal.xy * 2.0 - 1.0;
+    normal.z = sqrt(max(1.0 - dot(normal.xy, normal.xy), 0.0));
 
     // 3. 将切线空间的法线转换到世界空间
     // 此时的 normal 已经包含了物体表面的微小凹凸细节
@@ -2,8 +2,7 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
-layout (location = 3) in vec3 aTangent;
-layout (location = 4) in vec3 aBitangent;
+layout (location = 3) in vec4 aTangent; // w = bitangent handedness
 
 out VS_OUT {
     vec3 FragPos;
@@ -23,8 +22,10 @@ void main()
     // --- 臣之核心逻辑：构建 TBN 矩阵 ---
     // 将法线、切线、副切线从模型空间转换到世界空间
     // 这里的 normal matrix 简化为 model 矩阵，若有非均匀缩放需使用 transpose(inverse(mat3(model)))
-    vec3 T = normalize(vec3(model * vec4(aTangent,   0.0)));
-    vec3 B = normalize(vec3(model * vec4(aBitangent, 0.0)));
+    float handedness = aTangent.w < 0.0 ? -1.0 : 1.0;
+    vec3 aBitangent = cross(aNormal, aTangent.xyz) * handedness;
+    vec3 T = normalize(vec3(model * vec4(aTangent.xyz, 0.0)));
+    vec3 B = normalize(vec3(model * vec4(aBitangent,   0.0)));
     vec3 N = normalize(vec3(model * vec4(aNormal,    0.0)));
 
     // 构建正交矩阵，用于将切线空间的向量转到世界空间
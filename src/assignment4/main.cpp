@@ -3,6 +3,9 @@
 #include <imgui/imgui.h>
 #include <imgui/backends/imgui_impl_glfw.h>
 #include <imgui/backends/imgui_impl_opengl3.h>
+#include "utils/AssetPack.h"
+#include "utils/HotReload.h"
+#include "utils/LoadProfiler.h"
 #include "utils/Model.h"
 #include "utils/Renderer.h"
 #include "utils/Camera.h"
@@ -100,6 +103,10 @@ void processInput(GLFWwindow* window)
 
 int main()
 {
+    // Built by the assignment4_pack target; without it everything is read
+    // loose, and edits to shaders, textures and models reload while running.
+    if (!AssetPack::Mount("assignment4.pack", RESOURCE_ROOT)) HotReload::Start(RESOURCE_ROOT);
+
     if (!glfwInit()) return -1;
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -203,6 +210,8 @@ int main()
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
+    LoadProfiler::LogReport();
+    LoadProfiler::WriteChromeTrace("load-trace.json");
     Renderer::Shutdown();
     glfwTerminate();
     return 0;
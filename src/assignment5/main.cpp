@@ -8,6 +8,9 @@
 #include <filesystem>
 #include <algorithm>
 
+#include "utils/AssetPack.h"
+#include "utils/HotReload.h"
+#include "utils/LoadProfiler.h"
 #include "utils/Renderer.h"
 #include "utils/Model.h"
 #include "utils/Mesh.h"
@@ -126,6 +129,10 @@ float timespec = 1.2f;
 
 int main()
 {
+    // Built by the assignment5_pack target; without it everything is read
+    // loose, and edits to shaders, textures and models reload while running.
+    if (!AssetPack::Mount("assignment5.pack", RESOURCE_ROOT)) HotReload::Start(RESOURCE_ROOT);
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -165,7 +172,7 @@ int main()
 
     Renderer::Init();
 
-    Model oceanModel("dummy", "ocean-BRDF.vs", "ocean-BRDF.fs", false);
+    Model oceanModel(Geometry::Create(), "ocean-BRDF.vs", "ocean-BRDF.fs", false);
 
     oceanModel.meshes.push_back(createOceanGrid(512, 200.0f));
 
@@ -217,6 +224,7 @@ int main()
         {
             shader->setFloat("u_Time", oceanTime);
             shader->setVec3("u_CameraPos", camera.Position);
+            skybox.BindEnvironment(*shader, "u_Skybox", 1);
         });
 
         Renderer::EndScene();
@@ -225,6 +233,8 @@ int main()
         glfwPollEvents();
     }
 
+    LoadProfiler::LogReport();
+    LoadProfiler::WriteChromeTrace("load-trace.json");
     Renderer::Shutdown();
     glfwTerminate();
     return 0;
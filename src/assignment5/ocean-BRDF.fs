@@ -15,7 +15,21 @@ uniform vec3 u_CameraPos;
 uniform vec3 u_SunDir;
 uniform vec3 u_SunColor;
 
-uniform samplerCube u_Skybox;
+uniform samplerCube u_Skybox;     // GGX-prefiltered: level = roughness * u_SkyboxMaxLod
+uniform float u_SkyboxMaxLod;
+
+// Diffuse irradiance of the skybox over pi as L2 spherical harmonics, filled
+// in by the Renderer.
+layout(std140) uniform EnvironmentSH {
+    vec4 u_SH[9];
+};
+
+vec3 shIrradiance(vec3 n) {
+    return u_SH[0].rgb
+         + u_SH[1].rgb * n.y + u_SH[2].rgb * n.z + u_SH[3].rgb * n.x
+         + u_SH[4].rgb * (n.x * n.y) + u_SH[5].rgb * (n.y * n.z) + u_SH[6].rgb * (3.0 * n.z * n.z - 1.0)
+         + u_SH[7].rgb * (n.x * n.z) + u_SH[8].rgb * (n.x * n.x - n.y * n.y);
+}
 
 const float N_min = 1.0;
 const float N_max = 2.5;
@@ -163,9 +177,11 @@ void main() {
     vec3 I_sun = u_SunColor * specular_mag;
     //#endregion Sun BRDF
 
-    // check mipmap level by variance value
+    // check mipmap level by variance value: slope variance gives the
+    // Beckmann/GGX alpha, and the prefiltered levels step in sqrt(alpha)
     float variance = max(sigma_x + sigma_y, 0.001);
-    float mipLevel = 3.0 * sqrt(variance);
+    float roughness = sqrt(min(sqrt(variance), 1.0));
+    float mipLevel = roughness * u_SkyboxMaxLod;
 
     vec3 skyColor = textureLod(u_Skybox, reflectDir, mipLevel).rgb;
     skyColor = pow(skyColor, vec3(2.2)); // sRGB to linear space
@@ -173,7 +189,9 @@ void main() {
     float skyboxIntensity = 1.0;
     vec3 I_sky = skyColor * skyboxIntensity * fresnel_sky;
 
-    vec3 waterBaseColor = vec3(0.005, 0.02, 0.04) * (1.0 - fresnel_sky);
+    // Light scattered back up out of the water, lit by the sky's irradiance
+    vec3 waterAlbedo = vec3(0.025, 0.07, 0.11);
+    vec3 waterBaseColor = waterAlbedo * shIrradiance(Normal) * (1.0 - fresnel_sky);
 
     // Final color = sky reflection + water base color + sun specular
     vec3 color = I_sky + waterBaseColor + I_sun;
@@ -0,0 +1,129 @@
+// Builds an assignment's AssetPack: every shader, model and image under its
+// directory, plus the MeshCache and TextureBaker entries baked for them, so a
+// warm start reads one mapped file. Run through the <chapter>_pack target:
+//
+//   asset_packer <out.pack> <assignment directory>
+//
+// Cache entries are keyed by the canonical source path, so the pack only
+// serves them to a build whose RESOURCE_ROOT is the directory packed here.
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "utils/AssetPack.h"
+#include "utils/Geometry.h"
+#include "utils/MeshCache.h"
+#include "utils/TextureBaker.h"
+#include "utils/TextureLoader.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    const std::set<std::string> kShaders = {".vs", ".fs", ".tcs", ".tes", ".gs", ".cs"};
+    const std::set<std::string> kModels = {".obj", ".gltf", ".glb"};
+    const std::set<std::string> kImages = {".tga", ".jpg", ".png", ".exr"};
+    const std::set<std::string> kOther = {".mtl", ".bin"};
+
+    std::string extensionOf(const fs::path& path)
+    {
+        std::string ext = path.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+        return ext;
+    }
+
+    // Bakes one image the way the loaders will ask for it; a failure only
+    // means the runtime bakes it itself.
+    void bakeImage(const fs::path& path, TexturePlaceholder usage, bool wrap, std::set<std::string>& baked)
+    {
+        TextureImage image;
+        if (TextureBaker::LoadOrBake(path.string(), usage, wrap, image)) baked.insert(path.generic_string());
+        else std::cout << "ERROR::ASSET_PACKER:: cannot bake " << path.string() << std::endl;
+    }
+
+    void addDirectory(const fs::path& dir, const std::string& prefix, std::vector<AssetPack::Input>& inputs)
+    {
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(dir, ec))
+        {
+            if (!entry.is_regular_file() || entry.path().extension() == ".tmp") continue;
+            inputs.push_back({prefix + entry.path().filename().generic_string(), entry.path()});
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cout << "usage: asset_packer <out.pack> <assignment directory>" << std::endl;
+        return 1;
+    }
+    const fs::path packPath = fs::absolute(argv[1]);
+    const fs::path root = fs::weakly_canonical(argv[2]);
+
+    // Bake into a per-pack directory so only this assignment's entries are
+    // collected; it persists, so rebuilding the pack only bakes what changed.
+    const fs::path stage = fs::temp_directory_path() / "rtr-opengl" / ("pack-" + packPath.stem().string());
+    TextureBaker::SetDirectory(stage / "texture-cache");
+    MeshCache::SetDirectory(stage / "mesh-cache");
+
+    std::vector<fs::path> files;
+    std::error_code ec;
+    for (const auto& entry : fs::recursive_directory_iterator(root, ec))
+    {
+        if (!entry.is_regular_file()) continue;
+        std::string ext = extensionOf(entry.path());
+        if (kShaders.count(ext) || kModels.count(ext) || kImages.count(ext) || kOther.count(ext))
+            files.push_back(entry.path());
+    }
+    if (ec || files.empty())
+    {
+        std::cout << "ERROR::ASSET_PACKER:: no assets under " << root.string() << std::endl;
+        return 1;
+    }
+    std::sort(files.begin(), files.end());
+
+    // Models first: their materials say how each texture is used.
+    std::set<std::string> baked;
+    for (const fs::path& file : files)
+    {
+        if (!kModels.count(extensionOf(file))) continue;
+        Geometry::ImportData data;
+        if (!Geometry::Bake(file.string(), data))
+            std::cout << "AssetPack:: " << file.string() << " is packed without a mesh cache entry" << std::endl;
+        for (const Geometry::ImportedMesh& mesh : data.meshes)
+        {
+            for (const Geometry::ImportedTexture& texture : mesh.textures)
+            {
+                if (texture.embedded >= 0) continue;
+                fs::path path = fs::weakly_canonical(file.parent_path() / texture.path, ec);
+                if (!baked.count(path.generic_string()))
+                    bakeImage(path, TextureLoader::PlaceholderFor(texture.type), true, baked);
+            }
+        }
+    }
+    // Everything else is a colour map or, in a skybox directory, a cube face.
+    for (const fs::path& file : files)
+    {
+        if (!kImages.count(extensionOf(file)) || baked.count(file.generic_string())) continue;
+        bakeImage(file, TexturePlaceholder::Grey, true, baked);
+        if (file.generic_string().find("skybox") != std::string::npos)
+            bakeImage(file, TexturePlaceholder::Grey, false, baked);
+    }
+
+    std::vector<AssetPack::Input> inputs;
+    for (const fs::path& file : files)
+        inputs.push_back({file.lexically_relative(root).generic_string(), file});
+    addDirectory(TextureBaker::GetDirectory(), AssetPack::TextureCachePrefix, inputs);
+    addDirectory(MeshCache::GetDirectory(), AssetPack::MeshCachePrefix, inputs);
+
+    if (!AssetPack::Write(packPath.string(), inputs)) return 1;
+    std::cout << "AssetPack:: " << inputs.size() << " entries, " << fs::file_size(packPath, ec) / (1024 * 1024)
+              << " MiB -> " << packPath.string() << std::endl;
+    return 0;
+}
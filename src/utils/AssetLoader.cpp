@@ -0,0 +1,137 @@
+#include "AssetLoader.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    struct LoadJob {
+        std::string key;
+        std::shared_ptr<Geometry> geometry;
+        Geometry::ImportData data;
+        bool imported = false;
+
+        std::promise<std::shared_ptr<Geometry>> promise;
+        std::shared_future<std::shared_ptr<Geometry>> future;
+        std::vector<AssetLoader::Callback> callbacks;
+    };
+
+    struct AssetLoaderData {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<LoadJob>> imported; // filled by workers
+
+        // Render thread only.
+        std::unordered_map<std::string, std::shared_ptr<LoadJob>> active;
+        std::deque<std::shared_ptr<LoadJob>> uploading;
+    };
+
+    AssetLoaderData s_Data;
+
+    void complete(LoadJob& job)
+    {
+        s_Data.active.erase(job.key);
+        job.promise.set_value(job.geometry);
+        for (auto& callback : job.callbacks)
+            callback(job.geometry);
+    }
+}
+
+bool AssetLoader::ModelHandle::IsReady() const
+{
+    return future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+AssetLoader::ModelHandle AssetLoader::LoadModelAsync(const std::string& path, Callback onLoaded)
+{
+    std::string key = Geometry::registryKey(path);
+
+    auto pending = s_Data.active.find(key);
+    if (pending != s_Data.active.end())
+    {
+        if (onLoaded) pending->second->callbacks.push_back(std::move(onLoaded));
+        return {pending->second->geometry, pending->second->future};
+    }
+
+    if (auto existing = Geometry::findLoaded(key))
+    {
+        std::promise<std::shared_ptr<Geometry>> done;
+        done.set_value(existing);
+        if (onLoaded) onLoaded(existing);
+        return {existing, done.get_future().share()};
+    }
+
+    auto job = std::make_shared<LoadJob>();
+    job->key = key;
+    job->geometry = std::shared_ptr<Geometry>(new Geometry());
+    job->future = job->promise.get_future().share();
+    if (onLoaded) job->callbacks.push_back(std::move(onLoaded));
+
+    Geometry::registerLoaded(key, job->geometry);
+    s_Data.active[key] = job;
+
+    ThreadPool::Get().Submit([job, path]() {
+        job->imported = Geometry::Import(path, job->data);
+        std::lock_guard<std::mutex> lock(s_Data.mutex);
+        s_Data.imported.push_back(job);
+    });
+    return {job->geometry, job->future};
+}
+
+void AssetLoader::Update(double budgetMs)
+{
+    {
+        std::lock_guard<std::mutex> lock(s_Data.mutex);
+        for (auto& job : s_Data.imported)
+            s_Data.uploading.push_back(std::move(job));
+        s_Data.imported.clear();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [&start]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    bool first = true;
+    while (!s_Data.uploading.empty() && (first || elapsedMs() < budgetMs))
+    {
+        first = false;
+        std::shared_ptr<LoadJob> job = s_Data.uploading.front();
+
+        // One mesh per step keeps the slices short; a single huge mesh still
+        // goes up in one piece.
+        if (!job->imported || job->geometry->Upload(job->data, 1))
+        {
+            s_Data.uploading.pop_front();
+            job->data = Geometry::ImportData{};
+            complete(*job);
+        }
+    }
+}
+
+void AssetLoader::Wait(const ModelHandle& handle)
+{
+    while (!handle.IsReady())
+    {
+        Update();
+        if (!handle.IsReady()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+size_t AssetLoader::PendingCount()
+{
+    return s_Data.active.size();
+}
+
+void AssetLoader::Shutdown()
+{
+    // Workers still importing keep their job alive; it is dropped when they finish.
+    std::lock_guard<std::mutex> lock(s_Data.mutex);
+    s_Data.imported.clear();
+    s_Data.uploading.clear();
+    s_Data.active.clear();
+}
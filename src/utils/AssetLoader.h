@@ -1,89 +1,40 @@
 #pragma once
 
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
-#include <iostream>
-#include <vector>
-
-#include "Mesh.h"
-#include "RenderTypes.h"
-
-// 简单的资源加载器，封装 Assimp
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+
+#include "Geometry.h"
+
+// 异步模型加载器
+// Import (mesh cache / Assimp, vertex conversion) runs on the ThreadPool; the
+// GL objects are created by Update() on the render thread, a few meshes per
+// call within a time budget. The Geometry is usable straight away: meshes
+// appear in it as they are uploaded, so a scene can start drawing while later
+// assets are still arriving.
 class AssetLoader {
 public:
-    static std::vector<Mesh> LoadModel(const std::string& path) {
-        Assimp::Importer importer;
-        // 常用后期处理：三角化、生成法线、翻转UV、计算切线空间
-        const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
-
-        std::vector<Mesh> meshes;
-
-        if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-            std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
-            return meshes;
-        }
-
-        ProcessNode(scene->mRootNode, scene, meshes);
-        return meshes;
-    }
-
-private:
-    static void ProcessNode(aiNode *node, const aiScene *scene, std::vector<Mesh>& meshes) {
-        for(unsigned int i = 0; i < node->mNumMeshes; i++) {
-            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            meshes.push_back(ProcessMesh(mesh, scene));
-        }
-        for(unsigned int i = 0; i < node->mNumChildren; i++) {
-            ProcessNode(node->mChildren[i], scene, meshes);
-        }
-    }
-
-    static Mesh ProcessMesh(aiMesh *mesh, const aiScene *scene) {
-        std::vector<Vertex> vertices;
-        std::vector<unsigned int> indices;
-        std::vector<TextureInfo> textures;
-
-        // 1. 处理顶点
-        for(unsigned int i = 0; i < mesh->mNumVertices; i++) {
-            Vertex vertex;
-            // 位置
-            vertex.Position = {mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z};
-            
-            // 法线
-            if(mesh->HasNormals())
-                vertex.Normal = {mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z};
-            
-            // UV
-            if(mesh->mTextureCoords[0]) {
-                vertex.TexCoords = {mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y};
-            } else {
-                vertex.TexCoords = {0.0f, 0.0f};
-            }
-
-            // 切线与副切线 (用于法线贴图)
-            if (mesh->HasTangentsAndBitangents()) {
-                vertex.Tangent = {mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z};
-                vertex.Bitangent = {mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z};
-            }
-
-            vertices.push_back(vertex);
-        }
-
-        // 2. 处理索引
-        for(unsigned int i = 0; i < mesh->mNumFaces; i++) {
-            aiFace face = mesh->mFaces[i];
-            for(unsigned int j = 0; j < face.mNumIndices; j++)
-                indices.push_back(face.mIndices[j]);
-        }
-
-        // 3. 处理纹理 (简化版：只记录材质名称或路径，实际加载交给 Renderer 懒加载)
-        if(mesh->mMaterialIndex >= 0) {
-            aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-            // 这里可以添加逻辑提取漫反射贴图路径等
-            // 为了代码简洁，暂时留空，你可以根据 Model.cpp 把 loadMaterialTextures 逻辑移过来
-        }
-
-        return Mesh(vertices, indices, textures);
-    }
-};
\ No newline at end of file
+    using Callback = std::function<void(const std::shared_ptr<Geometry>&)>;
+
+    struct ModelHandle {
+        std::shared_ptr<Geometry> geometry;
+        // Resolves on the render thread once every mesh has been uploaded.
+        std::shared_future<std::shared_ptr<Geometry>> future;
+
+        bool IsReady() const;
+    };
+
+    // Same registry as Geometry::Load, so repeated requests for a file share
+    // one Geometry and one import. `onLoaded` runs on the render thread.
+    static ModelHandle LoadModelAsync(const std::string& path, Callback onLoaded = nullptr);
+
+    // Render thread, once per frame (Renderer::BeginScene calls it). Creates
+    // meshes until `budgetMs` is used up, always at least one.
+    static void Update(double budgetMs = 2.0);
+    // Pumps Update() until the handle is ready. Don't call future.get() on the
+    // render thread before that, the upload would never run.
+    static void Wait(const ModelHandle& handle);
+    static size_t PendingCount();
+    static void Shutdown();
+};
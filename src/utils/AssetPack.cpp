@@ -0,0 +1,343 @@
+#include "AssetPack.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "TextureBaker.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <system_error>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+    const char kMagic[4] = {'R', 'T', 'R', 'P'};
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t bucketBits;
+        uint64_t bucketOffset;
+        uint64_t entryOffset;
+        uint64_t namesOffset;
+        uint64_t namesSize;
+    };
+
+    struct Entry {
+        uint64_t hash;
+        uint64_t offset;
+        uint64_t size;
+        uint64_t sourceSize;
+        int64_t sourceMtime;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+    };
+
+    // A directory whose files are looked up under `prefix` + their relative path.
+    struct Root {
+        std::filesystem::path dir;
+        std::string prefix;
+    };
+
+    struct MountedPack {
+        MappedFile file;
+        uint32_t bucketBits = 0;
+        const uint32_t* buckets = nullptr;
+        const Entry* entries = nullptr;
+        const char* names = nullptr;
+        std::vector<Root> roots;
+    };
+
+    struct AssetPackData {
+        std::vector<std::unique_ptr<MountedPack>> packs;
+    };
+
+    AssetPackData s_Data;
+
+    uint64_t alignUp(uint64_t v, uint64_t alignment)
+    {
+        return (v + alignment - 1) & ~(alignment - 1);
+    }
+
+    bool inBounds(uint64_t offset, uint64_t bytes, size_t fileSize)
+    {
+        return offset <= fileSize && bytes <= fileSize - offset;
+    }
+
+    uint32_t bucketOf(uint64_t hash, uint32_t bits)
+    {
+        return bits == 0 ? 0 : static_cast<uint32_t>(hash >> (64 - bits));
+    }
+
+    std::filesystem::path normalizedDirectory(const std::filesystem::path& dir)
+    {
+        std::error_code ec;
+        std::filesystem::path normal = std::filesystem::absolute(dir, ec).lexically_normal();
+        return normal.has_filename() ? normal : normal.parent_path();
+    }
+
+    bool keyFor(const std::filesystem::path& path, const Root& root, std::string& key)
+    {
+        std::filesystem::path relative = path.lexically_relative(root.dir);
+        if (relative.empty() || *relative.begin() == "..") return false;
+        key = root.prefix + relative.generic_string();
+        return true;
+    }
+
+    const Entry* lookup(const MountedPack& pack, const std::string& key)
+    {
+        uint64_t hash = HashString(key);
+        uint32_t bucket = bucketOf(hash, pack.bucketBits);
+        for (uint32_t i = pack.buckets[bucket]; i < pack.buckets[bucket + 1]; i++)
+        {
+            const Entry& entry = pack.entries[i];
+            if (entry.hash == hash && entry.nameLength == key.size() &&
+                std::memcmp(pack.names + entry.nameOffset, key.data(), key.size()) == 0)
+                return &entry;
+        }
+        return nullptr;
+    }
+
+    bool statFile(const std::filesystem::path& path, unsigned long long& size, long long& mtime)
+    {
+        std::error_code ec;
+        auto fileSize = std::filesystem::file_size(path, ec);
+        if (ec) return false;
+        auto time = std::filesystem::last_write_time(path, ec);
+        if (ec) return false;
+        size = static_cast<unsigned long long>(fileSize);
+        mtime = static_cast<long long>(time.time_since_epoch().count());
+        return true;
+    }
+}
+
+bool AssetPack::Mount(const std::string& packPath, const std::filesystem::path& root)
+{
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(packPath, ec)) return false;
+
+    auto pack = std::make_unique<MountedPack>();
+    if (!pack->file.Open(packPath) || pack->file.Size() < sizeof(Header))
+    {
+        std::cout << "ERROR::ASSET_PACK:: cannot map " << packPath << std::endl;
+        return false;
+    }
+
+    const unsigned char* base = pack->file.Data();
+    const size_t size = pack->file.Size();
+    Header header;
+    std::memcpy(&header, base, sizeof(header));
+    const uint64_t bucketCount = (uint64_t(1) << header.bucketBits) + 1;
+    bool valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == Version &&
+                 header.bucketBits < 32 && inBounds(header.bucketOffset, bucketCount * sizeof(uint32_t), size) &&
+                 inBounds(header.entryOffset, uint64_t(header.entryCount) * sizeof(Entry), size) &&
+                 inBounds(header.namesOffset, header.namesSize, size) && header.bucketOffset % 4 == 0 &&
+                 header.entryOffset % 8 == 0;
+    if (valid)
+    {
+        pack->bucketBits = header.bucketBits;
+        pack->buckets = reinterpret_cast<const uint32_t*>(base + header.bucketOffset);
+        pack->entries = reinterpret_cast<const Entry*>(base + header.entryOffset);
+        pack->names = reinterpret_cast<const char*>(base + header.namesOffset);
+        valid = pack->buckets[bucketCount - 1] == header.entryCount;
+        for (uint64_t b = 0; valid && b + 1 < bucketCount; b++) valid = pack->buckets[b] <= pack->buckets[b + 1];
+        for (uint32_t i = 0; valid && i < header.entryCount; i++)
+        {
+            const Entry& entry = pack->entries[i];
+            valid = inBounds(entry.offset, entry.size, size) &&
+                    inBounds(entry.nameOffset, entry.nameLength, header.namesSize);
+        }
+    }
+    if (!valid)
+    {
+        std::cout << "ERROR::ASSET_PACK:: invalid or outdated pack " << packPath << std::endl;
+        return false;
+    }
+
+#ifndef _WIN32
+    // Start reading the whole pack in one sequential pass before the loaders
+    // fault its pages in out of order.
+    posix_madvise(const_cast<unsigned char*>(base), size, POSIX_MADV_WILLNEED);
+#endif
+
+    pack->roots.push_back({normalizedDirectory(root), ""});
+    pack->roots.push_back({normalizedDirectory(TextureBaker::GetDirectory()), TextureCachePrefix});
+    pack->roots.push_back({normalizedDirectory(MeshCache::GetDirectory()), MeshCachePrefix});
+    s_Data.packs.push_back(std::move(pack));
+    return true;
+}
+
+void AssetPack::Unmount()
+{
+    s_Data.packs.clear();
+}
+
+bool AssetPack::IsMounted()
+{
+    return !s_Data.packs.empty();
+}
+
+bool AssetPack::Find(const std::string& path, Blob& out)
+{
+    if (s_Data.packs.empty()) return false;
+
+    std::error_code ec;
+    std::filesystem::path absolute = std::filesystem::absolute(path, ec).lexically_normal();
+    if (ec) return false;
+
+    std::string key;
+    for (const auto& pack : s_Data.packs)
+    {
+        for (const Root& root : pack->roots)
+        {
+            if (!keyFor(absolute, root, key)) continue;
+            const Entry* entry = lookup(*pack, key);
+            if (!entry) continue;
+
+            out.data = pack->file.Data() + entry->offset;
+            out.size = static_cast<size_t>(entry->size);
+            out.sourceSize = entry->sourceSize;
+            out.sourceMtime = entry->sourceMtime;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AssetPack::Stat(const std::string& path, unsigned long long& size, long long& mtime)
+{
+    Blob blob;
+    if (!Find(path, blob)) return false;
+    size = blob.sourceSize;
+    mtime = blob.sourceMtime;
+    return true;
+}
+
+bool AssetPack::Write(const std::string& packPath, const std::vector<Input>& inputs)
+{
+    struct Pending {
+        const Input* input;
+        uint64_t hash;
+        unsigned long long size;
+        long long mtime;
+    };
+
+    std::vector<Pending> pending;
+    pending.reserve(inputs.size());
+    for (const Input& input : inputs)
+    {
+        Pending p{&input, HashString(input.key), 0, 0};
+        if (!statFile(input.file, p.size, p.mtime))
+        {
+            std::cout << "ERROR::ASSET_PACK:: cannot read " << input.file.string() << std::endl;
+            return false;
+        }
+        pending.push_back(p);
+    }
+    std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.input->key < b.input->key;
+    });
+    for (size_t i = 1; i < pending.size(); i++)
+    {
+        if (pending[i].input->key == pending[i - 1].input->key)
+        {
+            std::cout << "ERROR::ASSET_PACK:: duplicate key " << pending[i].input->key << std::endl;
+            return false;
+        }
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = Version;
+    header.entryCount = static_cast<uint32_t>(pending.size());
+    while ((uint64_t(1) << header.bucketBits) < pending.size()) header.bucketBits++;
+
+    std::vector<uint32_t> buckets((size_t(1) << header.bucketBits) + 1, 0);
+    for (const Pending& p : pending) buckets[bucketOf(p.hash, header.bucketBits) + 1]++;
+    for (size_t b = 1; b < buckets.size(); b++) buckets[b] += buckets[b - 1];
+
+    std::string names;
+    std::vector<Entry> entries(pending.size());
+    header.bucketOffset = alignUp(sizeof(Header), 8);
+    header.entryOffset = alignUp(header.bucketOffset + buckets.size() * sizeof(uint32_t), 8);
+    header.namesOffset = header.entryOffset + entries.size() * sizeof(Entry);
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        entries[i].hash = pending[i].hash;
+        entries[i].nameOffset = static_cast<uint32_t>(names.size());
+        entries[i].nameLength = static_cast<uint32_t>(pending[i].input->key.size());
+        names += pending[i].input->key;
+    }
+    header.namesSize = names.size();
+
+    uint64_t cursor = alignUp(header.namesOffset + header.namesSize, BlobAlignment);
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        entries[i].offset = cursor;
+        entries[i].size = pending[i].size;
+        entries[i].sourceSize = pending[i].size;
+        entries[i].sourceMtime = pending[i].mtime;
+        cursor = alignUp(cursor + pending[i].size, BlobAlignment);
+    }
+
+    std::error_code ec;
+    std::filesystem::path target(packPath);
+    if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path(), ec);
+    std::filesystem::path temp = target;
+    temp += ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            std::cout << "ERROR::ASSET_PACK:: cannot write " << temp.string() << std::endl;
+            return false;
+        }
+
+        auto padTo = [&out](uint64_t offset) {
+            static const char zeros[BlobAlignment] = {};
+            uint64_t pos = static_cast<uint64_t>(out.tellp());
+            while (pos < offset)
+            {
+                uint64_t n = std::min<uint64_t>(offset - pos, BlobAlignment);
+                out.write(zeros, static_cast<std::streamsize>(n));
+                pos += n;
+            }
+        };
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        padTo(header.bucketOffset);
+        out.write(reinterpret_cast<const char*>(buckets.data()), buckets.size() * sizeof(uint32_t));
+        padTo(header.entryOffset);
+        out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+        out.write(names.data(), static_cast<std::streamsize>(names.size()));
+        for (size_t i = 0; i < pending.size(); i++)
+        {
+            padTo(entries[i].offset);
+            if (pending[i].size == 0) continue;
+            MappedFile file(pending[i].input->file.string());
+            if (!file.IsOpen() || file.Size() != pending[i].size)
+            {
+                std::cout << "ERROR::ASSET_PACK:: " << pending[i].input->file.string() << " changed while packing"
+                          << std::endl;
+                return false;
+            }
+            out.write(reinterpret_cast<const char*>(file.Data()), static_cast<std::streamsize>(file.Size()));
+        }
+        if (!out) return false;
+    }
+
+    std::filesystem::rename(temp, target, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Read-only archive of an assignment's assets in one file, built by the
+// asset_packer tool (the <chapter>_pack CMake target). A mounted pack is
+// memory mapped once and consulted before the file system by MappedFile, so
+// shaders, models, images and the TextureBaker/MeshCache entries baked for
+// them are served straight from the mapping: no open() per asset and no copy.
+//
+// Layout, all little endian:
+//   Header
+//   bucket table   uint32[2^bucketBits + 1], first entry of each hash bucket
+//   entries        Entry[entryCount], sorted by the 64-bit hash of their key
+//   names          keys back to back, for collision checks
+//   blobs          each aligned to BlobAlignment
+// Keys are paths relative to the mounted root with '/' separators. Cache
+// entries use "@texture-cache/<file>" and "@mesh-cache/<file>". A lookup
+// hashes the key, takes the top bucketBits as the bucket and scans its few
+// entries, so it is O(1) on average.
+class AssetPack
+{
+public:
+    static constexpr uint32_t Version = 1;
+    static constexpr uint64_t BlobAlignment = 64;
+    static constexpr const char* TextureCachePrefix = "@texture-cache/";
+    static constexpr const char* MeshCachePrefix = "@mesh-cache/";
+
+    struct Blob {
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+        // The packed file's size and mtime when it was packed, which cache
+        // entries are validated against instead of the loose file.
+        unsigned long long sourceSize = 0;
+        long long sourceMtime = 0;
+    };
+
+    struct Input {
+        std::string key;
+        std::filesystem::path file;
+    };
+
+    // Maps `packPath` and serves its entries for paths under `root`, and for
+    // the current TextureBaker and MeshCache directories. Mount before any
+    // loading starts: lookups are not synchronized with Mount/Unmount, and
+    // blobs handed out stay valid until Unmount. Returns false, quietly, if
+    // there is no pack at `packPath`.
+    static bool Mount(const std::string& packPath, const std::filesystem::path& root);
+    static void Unmount();
+    static bool IsMounted();
+
+    // `path` as the loaders see it, absolute or relative to the working directory.
+    static bool Find(const std::string& path, Blob& out);
+    static bool Stat(const std::string& path, unsigned long long& size, long long& mtime);
+
+    // Packs `inputs` (key plus the file holding its bytes) into `packPath`.
+    static bool Write(const std::string& packPath, const std::vector<Input>& inputs);
+};
@@ -0,0 +1,600 @@
+#include "EnvironmentPrefilter.h"
+#include "AssetPack.h"
+#include "Hash.h"
+#include "LoadProfiler.h"
+#include "MappedFile.h"
+#include "SrgbTables.h"
+#include "ThreadPool.h"
+#include "stb_image.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENV_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // Taps per output texel at the roughest levels; smoother levels use fewer
+    // since their lobe covers fewer source texels.
+    const int kMaxSamples = 128;
+
+    struct alignas(16) Texel {
+        float v[4];
+    };
+
+    // One level of a float cube map, faces back to back.
+    struct CubeLevel {
+        int size = 0;
+        std::vector<Texel> texels;
+
+        Texel* Row(int face, int y) { return texels.data() + (size_t(face) * size + y) * size; }
+        const Texel& At(int face, int x, int y) const { return texels[(size_t(face) * size + y) * size + x]; }
+    };
+
+    struct Sample {
+        glm::vec3 direction; // tangent space, z along the normal
+        float weight;        // N.L
+        float lod;           // source level whose texels match the sample's solid angle
+    };
+
+#if ENV_USE_SSE
+    using Vec4 = __m128;
+    inline Vec4 zero() { return _mm_setzero_ps(); }
+    inline Vec4 load(const Texel& t) { return _mm_load_ps(t.v); }
+    inline Vec4 madd(Vec4 acc, Vec4 a, float w) { return _mm_add_ps(acc, _mm_mul_ps(a, _mm_set1_ps(w))); }
+    inline void store(Vec4 a, Texel& t) { _mm_store_ps(t.v, a); }
+#else
+    struct Vec4 {
+        float v[4];
+    };
+    inline Vec4 zero() { return {{0.0f, 0.0f, 0.0f, 0.0f}}; }
+    inline Vec4 load(const Texel& t) { return {{t.v[0], t.v[1], t.v[2], t.v[3]}}; }
+    inline Vec4 madd(Vec4 acc, Vec4 a, float w)
+    {
+        for (int c = 0; c < 4; c++) acc.v[c] += a.v[c] * w;
+        return acc;
+    }
+    inline void store(Vec4 a, Texel& t) { for (int c = 0; c < 4; c++) t.v[c] = a.v[c]; }
+#endif
+
+    // GL cube map addressing (face order +X -X +Y -Y +Z -Z), s and t in [0, 1].
+    void faceCoords(const glm::vec3& d, int& face, float& s, float& t)
+    {
+        glm::vec3 a = glm::abs(d);
+        float sc, tc, ma;
+        if (a.x >= a.y && a.x >= a.z)
+        {
+            ma = a.x;
+            face = d.x > 0.0f ? 0 : 1;
+            sc = d.x > 0.0f ? -d.z : d.z;
+            tc = -d.y;
+        }
+        else if (a.y >= a.z)
+        {
+            ma = a.y;
+            face = d.y > 0.0f ? 2 : 3;
+            sc = d.x;
+            tc = d.y > 0.0f ? d.z : -d.z;
+        }
+        else
+        {
+            ma = a.z;
+            face = d.z > 0.0f ? 4 : 5;
+            sc = d.z > 0.0f ? d.x : -d.x;
+            tc = -d.y;
+        }
+        s = 0.5f * (sc / ma + 1.0f);
+        t = 0.5f * (tc / ma + 1.0f);
+    }
+
+    glm::vec3 texelDirection(int face, float s, float t)
+    {
+        float sc = 2.0f * s - 1.0f;
+        float tc = 2.0f * t - 1.0f;
+        switch (face)
+        {
+        case 0: return glm::normalize(glm::vec3(1.0f, -tc, -sc));
+        case 1: return glm::normalize(glm::vec3(-1.0f, -tc, sc));
+        case 2: return glm::normalize(glm::vec3(sc, 1.0f, tc));
+        case 3: return glm::normalize(glm::vec3(sc, -1.0f, -tc));
+        case 4: return glm::normalize(glm::vec3(sc, -tc, 1.0f));
+        default: return glm::normalize(glm::vec3(-sc, -tc, -1.0f));
+        }
+    }
+
+    // Bilinear within the face; edges clamp, which only shows at the
+    // smallest source levels.
+    Vec4 sampleLevel(const CubeLevel& level, int face, float s, float t)
+    {
+        float x = std::clamp(s * level.size - 0.5f, 0.0f, float(level.size - 1));
+        float y = std::clamp(t * level.size - 0.5f, 0.0f, float(level.size - 1));
+        int x0 = static_cast<int>(x), y0 = static_cast<int>(y);
+        int x1 = std::min(x0 + 1, level.size - 1), y1 = std::min(y0 + 1, level.size - 1);
+        float fx = x - x0, fy = y - y0;
+
+        Vec4 r = madd(zero(), load(level.At(face, x0, y0)), (1.0f - fx) * (1.0f - fy));
+        r = madd(r, load(level.At(face, x1, y0)), fx * (1.0f - fy));
+        r = madd(r, load(level.At(face, x0, y1)), (1.0f - fx) * fy);
+        return madd(r, load(level.At(face, x1, y1)), fx * fy);
+    }
+
+    Vec4 sampleCube(const std::vector<CubeLevel>& chain, const glm::vec3& direction, float lod)
+    {
+        int face;
+        float s, t;
+        faceCoords(direction, face, s, t);
+
+        lod = std::clamp(lod, 0.0f, float(chain.size() - 1));
+        int l0 = static_cast<int>(lod);
+        int l1 = std::min(l0 + 1, static_cast<int>(chain.size()) - 1);
+        float f = lod - l0;
+        Vec4 r = sampleLevel(chain[l0], face, s, t);
+        if (f <= 0.0f || l1 == l0) return r;
+        return madd(madd(zero(), r, 1.0f - f), sampleLevel(chain[l1], face, s, t), f);
+    }
+
+    float radicalInverse(unsigned int bits)
+    {
+        bits = (bits << 16u) | (bits >> 16u);
+        bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+        bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+        bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+        bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+        return float(bits) * 2.3283064365386963e-10f;
+    }
+
+    // Hammersley points through the GGX half-vector distribution, reflected
+    // about the normal with N = V = R. The same set serves every texel of a
+    // level, so the PDF-derived source LOD is computed once per sample.
+    std::vector<Sample> ggxSamples(float roughness, int count, int sourceSize)
+    {
+        const float alpha2 = std::max(roughness * roughness * roughness * roughness, 1e-8f);
+        const float texelSolidAngle = 4.0f * glm::pi<float>() / (6.0f * sourceSize * sourceSize);
+
+        std::vector<Sample> samples;
+        samples.reserve(count);
+        for (int i = 0; i < count; i++)
+        {
+            float u = (i + 0.5f) / count;
+            float phi = 2.0f * glm::pi<float>() * radicalInverse(static_cast<unsigned int>(i));
+            float cosTheta = std::sqrt((1.0f - u) / (1.0f + (alpha2 - 1.0f) * u));
+            float sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+            glm::vec3 h(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+            glm::vec3 l = 2.0f * cosTheta * h - glm::vec3(0.0f, 0.0f, 1.0f);
+            if (l.z <= 0.0f) continue;
+
+            // pdf(L) = D(H) * (N.H) / (4 * V.H), and N.H == V.H here.
+            float d = cosTheta * cosTheta * (alpha2 - 1.0f) + 1.0f;
+            float pdf = alpha2 / (glm::pi<float>() * d * d) / 4.0f;
+            float sampleSolidAngle = 1.0f / (count * pdf);
+            float lod = std::max(0.0f, 0.5f * std::log2(sampleSolidAngle / texelSolidAngle) + 1.0f);
+            samples.push_back({l, l.z, lod});
+        }
+        return samples;
+    }
+
+    // sRGB faces to linear float, box-filtered down to at most `maxSize`.
+    CubeLevel baseLevel(const unsigned char* const faces[6], int size, int maxSize)
+    {
+        int factor = 1;
+        while (size / (factor * 2) >= 1 && size / factor > maxSize) factor *= 2;
+
+        CubeLevel level;
+        level.size = std::max(1, size / factor);
+        level.texels.resize(size_t(6) * level.size * level.size);
+        const float* toLinear = GetSrgbTables().srgbToLinear;
+        const float scale = 1.0f / (factor * factor);
+        ThreadPool::Get().ParallelFor(size_t(6) * level.size, 16, [&](size_t begin, size_t end) {
+            for (size_t row = begin; row < end; row++)
+            {
+                int face = static_cast<int>(row / level.size), y = static_cast<int>(row % level.size);
+                Texel* dst = level.Row(face, y);
+                for (int x = 0; x < level.size; x++)
+                {
+                    float sum[3] = {0.0f, 0.0f, 0.0f};
+                    for (int sy = 0; sy < factor; sy++)
+                    {
+                        const unsigned char* src =
+                            faces[face] + (size_t(std::min(y * factor + sy, size - 1)) * size + size_t(x) * factor) * 3;
+                        for (int sx = 0; sx < factor; sx++, src += 3)
+                            for (int c = 0; c < 3; c++) sum[c] += toLinear[src[c]];
+                    }
+                    dst[x] = {{sum[0] * scale, sum[1] * scale, sum[2] * scale, 1.0f}};
+                }
+            }
+        });
+        return level;
+    }
+
+    CubeLevel halve(const CubeLevel& src)
+    {
+        CubeLevel dst;
+        dst.size = std::max(1, src.size / 2);
+        dst.texels.resize(size_t(6) * dst.size * dst.size);
+        ThreadPool::Get().ParallelFor(size_t(6) * dst.size, 16, [&](size_t begin, size_t end) {
+            for (size_t row = begin; row < end; row++)
+            {
+                int face = static_cast<int>(row / dst.size), y = static_cast<int>(row % dst.size);
+                int y0 = std::min(2 * y, src.size - 1), y1 = std::min(2 * y + 1, src.size - 1);
+                Texel* out = dst.Row(face, y);
+                for (int x = 0; x < dst.size; x++)
+                {
+                    int x0 = std::min(2 * x, src.size - 1), x1 = std::min(2 * x + 1, src.size - 1);
+                    Vec4 sum = madd(zero(), load(src.At(face, x0, y0)), 0.25f);
+                    sum = madd(sum, load(src.At(face, x1, y0)), 0.25f);
+                    sum = madd(sum, load(src.At(face, x0, y1)), 0.25f);
+                    store(madd(sum, load(src.At(face, x1, y1)), 0.25f), out[x]);
+                }
+            }
+        });
+        return dst;
+    }
+
+    CubeLevel convolve(const std::vector<CubeLevel>& source, int size, float roughness, int sampleCount)
+    {
+        std::vector<Sample> samples = ggxSamples(roughness, sampleCount, source[0].size);
+        float totalWeight = 0.0f;
+        for (const Sample& sample : samples) totalWeight += sample.weight;
+        const float normalize = totalWeight > 0.0f ? 1.0f / totalWeight : 0.0f;
+
+        CubeLevel level;
+        level.size = size;
+        level.texels.resize(size_t(6) * size * size);
+        ThreadPool::Get().ParallelFor(size_t(6) * size, 1, [&](size_t begin, size_t end) {
+            for (size_t row = begin; row < end; row++)
+            {
+                int face = static_cast<int>(row / size), y = static_cast<int>(row % size);
+                Texel* out = level.Row(face, y);
+                for (int x = 0; x < size; x++)
+                {
+                    glm::vec3 n = texelDirection(face, (x + 0.5f) / size, (y + 0.5f) / size);
+                    glm::vec3 up = std::abs(n.z) < 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+                    glm::vec3 tangent = glm::normalize(glm::cross(up, n));
+                    glm::vec3 bitangent = glm::cross(n, tangent);
+
+                    Vec4 sum = zero();
+                    for (const Sample& sample : samples)
+                    {
+                        glm::vec3 l = tangent * sample.direction.x + bitangent * sample.direction.y +
+                                      n * sample.direction.z;
+                        sum = madd(sum, sampleCube(source, l, sample.lod), sample.weight);
+                    }
+                    store(madd(zero(), sum, normalize), out[x]);
+                }
+            }
+        });
+        return level;
+    }
+
+    void encode(const CubeLevel& level, std::vector<TextureImage>& out)
+    {
+        const unsigned char* toSrgb = GetSrgbTables().linearToSrgb;
+        for (int face = 0; face < 6; face++)
+        {
+            TextureImage& image = out[face];
+            size_t offset = image.data.size();
+            size_t bytes = size_t(level.size) * level.size * 3;
+            image.levels.push_back({level.size, level.size, offset, bytes});
+            image.data.resize(offset + bytes);
+
+            unsigned char* dst = image.data.data() + offset;
+            for (int y = 0; y < level.size; y++)
+                for (int x = 0; x < level.size; x++, dst += 3)
+                {
+                    const Texel& texel = level.At(face, x, y);
+                    for (int c = 0; c < 3; c++)
+                        dst[c] = toSrgb[static_cast<int>(std::clamp(texel.v[c], 0.0f, 1.0f) * 4095.0f + 0.5f)];
+                }
+        }
+    }
+
+    // Solid angle of the cube face region from (0, 0) to (x, y), face coordinates in [-1, 1].
+    float areaElement(float x, float y)
+    {
+        return std::atan2(x * y, std::sqrt(x * x + y * y + 1.0f));
+    }
+
+    float texelSolidAngle(int x, int y, int size)
+    {
+        float x0 = 2.0f * x / size - 1.0f, x1 = 2.0f * (x + 1) / size - 1.0f;
+        float y0 = 2.0f * y / size - 1.0f, y1 = 2.0f * (y + 1) / size - 1.0f;
+        return areaElement(x0, y0) - areaElement(x0, y1) - areaElement(x1, y0) + areaElement(x1, y1);
+    }
+
+    // Real SH basis without its constants, in IrradianceSH order.
+    void shPolynomials(const glm::vec3& n, float out[9])
+    {
+        out[0] = 1.0f;
+        out[1] = n.y;
+        out[2] = n.z;
+        out[3] = n.x;
+        out[4] = n.x * n.y;
+        out[5] = n.y * n.z;
+        out[6] = 3.0f * n.z * n.z - 1.0f;
+        out[7] = n.x * n.z;
+        out[8] = n.x * n.x - n.y * n.y;
+    }
+
+    // Basis constants, and the clamped-cosine convolution A_l / pi per band.
+    const float kShBasis[9] = {0.282095f, 0.488603f, 0.488603f, 0.488603f, 1.092548f,
+                               1.092548f, 0.315392f, 1.092548f, 0.546274f};
+    const float kShCosine[9] = {1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f};
+
+    // The projection only needs the low frequencies.
+    const int kShMaxSize = 64;
+
+    struct ShCacheFile {
+        unsigned int tag;
+        unsigned int version;
+        unsigned long long stamp;
+        long long newest;
+        float coefficients[9][4];
+    };
+
+    const unsigned int kShTag = 0x53525452; // "RTRS"
+
+    bool statSource(const std::string& path, unsigned long long& size, long long& mtime)
+    {
+        if (AssetPack::Stat(path, size, mtime)) return true;
+
+        std::error_code ec;
+        auto fileSize = std::filesystem::file_size(path, ec);
+        if (ec) return false;
+        auto time = std::filesystem::last_write_time(path, ec);
+        if (ec) return false;
+        size = static_cast<unsigned long long>(fileSize);
+        mtime = static_cast<long long>(time.time_since_epoch().count());
+        return true;
+    }
+
+    // Cache identity of a face set: `name` hashes the canonical paths, and the
+    // six source sizes and mtimes fold into `stamp`/`newest` for validation.
+    struct FaceSetStamp {
+        uint64_t name = 0;
+        unsigned long long stamp = EnvironmentPrefilter::Version;
+        long long newest = 0;
+    };
+
+    bool stampFaces(const std::vector<std::string>& faces, FaceSetStamp& out)
+    {
+        if (faces.size() != 6) return false;
+        std::string key;
+        for (const std::string& face : faces)
+        {
+            unsigned long long size;
+            long long mtime;
+            if (!statSource(face, size, mtime)) return false;
+            std::error_code ec;
+            std::string canonical = std::filesystem::weakly_canonical(face, ec).generic_string();
+            key += (ec ? face : canonical) + ";";
+            out.stamp = HashCombine(HashCombine(out.stamp, size), static_cast<uint64_t>(mtime));
+            out.newest = std::max(out.newest, mtime);
+        }
+        out.name = HashCombine(HashString(key), (uint64_t(EnvironmentPrefilter::Version) << 32) |
+                                                    EnvironmentPrefilter::MaxBaseSize);
+        return true;
+    }
+
+    std::filesystem::path cacheEntry(const FaceSetStamp& stamp, const char* suffix)
+    {
+        char name[48];
+        std::snprintf(name, sizeof(name), "%016llx-%s", static_cast<unsigned long long>(stamp.name), suffix);
+        return TextureBaker::GetDirectory() / name;
+    }
+
+    // All six faces as RGB8, decoded in parallel.
+    struct DecodedFaces {
+        std::unique_ptr<unsigned char, void (*)(void*)> pixels[6] = {
+            {nullptr, stbi_image_free}, {nullptr, stbi_image_free}, {nullptr, stbi_image_free},
+            {nullptr, stbi_image_free}, {nullptr, stbi_image_free}, {nullptr, stbi_image_free}};
+        const unsigned char* data[6] = {};
+        int size = 0;
+    };
+
+    bool decodeFaces(const std::vector<std::string>& faces, DecodedFaces& out)
+    {
+        int widths[6] = {}, heights[6] = {};
+        ThreadPool::Get().ParallelFor(6, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                int channels;
+                out.pixels[i].reset(TextureBaker::DecodeFile(faces[i], widths[i], heights[i], channels, 3));
+            }
+        });
+
+        for (int i = 0; i < 6; i++)
+        {
+            if (!out.pixels[i] || widths[i] != heights[i] || widths[i] != widths[0])
+            {
+                std::cout << "ERROR::ENVIRONMENT_PREFILTER:: faces must be square and the same size: " << faces[i]
+                          << std::endl;
+                return false;
+            }
+            out.data[i] = out.pixels[i].get();
+        }
+        out.size = widths[0];
+        return true;
+    }
+}
+
+void EnvironmentPrefilter::Prefilter(const unsigned char* const faces[6], int size, std::vector<TextureImage>& out)
+{
+    std::vector<CubeLevel> source;
+    source.push_back(baseLevel(faces, size, MaxBaseSize));
+    while (source.back().size > 1) source.push_back(halve(source.back()));
+
+    const int base = source[0].size;
+    int levels = 1;
+    while ((base >> levels) >= MinLevelSize) levels++;
+
+    out.assign(6, TextureImage());
+    for (TextureImage& image : out)
+    {
+        image.width = image.height = base;
+        image.channels = 3;
+        image.compression = TextureCompression::None;
+    }
+
+    // Roughness 0 is a mirror, so level 0 is the source itself.
+    encode(source[0], out);
+    for (int m = 1; m < levels; m++)
+    {
+        float roughness = float(m) / float(levels - 1);
+        int samples = std::min(kMaxSamples, 32 << (m - 1));
+        encode(convolve(source, base >> m, roughness, samples), out);
+    }
+}
+
+bool EnvironmentPrefilter::LoadOrBake(const std::vector<std::string>& faces, std::vector<TextureImage>& out)
+{
+    FaceSetStamp stamp;
+    if (!stampFaces(faces, stamp)) return false;
+
+    std::filesystem::path entries[6];
+    for (int i = 0; i < 6; i++)
+        entries[i] = cacheEntry(stamp, ("ggx" + std::to_string(i) + ".dds").c_str());
+
+    const bool cached = TextureBaker::IsEnabled();
+    if (cached)
+    {
+        LoadProfiler::Scope scope("dds-read", faces[0]);
+        out.assign(6, TextureImage());
+        bool hit = true;
+        for (int i = 0; i < 6 && hit; i++) hit = TextureBaker::ReadDDS(entries[i], out[i], stamp.stamp, stamp.newest);
+        if (hit && std::all_of(out.begin(), out.end(), [&](const TextureImage& image) {
+                return image.width == out[0].width && image.levels.size() == out[0].levels.size();
+            }))
+        {
+            for (const TextureImage& image : out) scope.AddBytes(image.data.size());
+            return true;
+        }
+    }
+
+    DecodedFaces decoded;
+    if (!decodeFaces(faces, decoded)) return false;
+    {
+        LoadProfiler::Scope scope("ggx-prefilter", faces[0]);
+        Prefilter(decoded.data, decoded.size, out);
+        for (const TextureImage& image : out) scope.AddBytes(image.data.size());
+    }
+
+    if (cached)
+    {
+        LoadProfiler::Scope scope("dds-write", faces[0]);
+        for (int i = 0; i < 6; i++)
+        {
+            if (!TextureBaker::WriteDDS(entries[i], out[i], stamp.stamp, stamp.newest))
+                std::cout << "ERROR::ENVIRONMENT_PREFILTER:: cannot write " << entries[i].string() << std::endl;
+        }
+    }
+    return true;
+}
+
+glm::vec3 IrradianceSH::Eval(const glm::vec3& n) const
+{
+    float y[9];
+    shPolynomials(n, y);
+    glm::vec3 e(0.0f);
+    for (int i = 0; i < 9; i++) e += glm::vec3(coefficients[i]) * y[i];
+    return e;
+}
+
+void EnvironmentPrefilter::ProjectIrradiance(const unsigned char* const faces[6], int size, IrradianceSH& out)
+{
+    CubeLevel level = baseLevel(faces, size, kShMaxSize);
+
+    // One partial sum per row, added up in row order afterwards so the result
+    // doesn't depend on how the rows were split across threads.
+    struct RowSum {
+        glm::vec3 sh[9];
+        float weight;
+    };
+    std::vector<RowSum> rows(size_t(6) * level.size);
+    ThreadPool::Get().ParallelFor(rows.size(), 8, [&](size_t begin, size_t end) {
+        for (size_t row = begin; row < end; row++)
+        {
+            int face = static_cast<int>(row / level.size), y = static_cast<int>(row % level.size);
+            RowSum sum = {};
+            for (int x = 0; x < level.size; x++)
+            {
+                glm::vec3 n = texelDirection(face, (x + 0.5f) / level.size, (y + 0.5f) / level.size);
+                float w = texelSolidAngle(x, y, level.size);
+                const Texel& texel = level.At(face, x, y);
+                glm::vec3 radiance = glm::vec3(texel.v[0], texel.v[1], texel.v[2]) * w;
+
+                float basis[9];
+                shPolynomials(n, basis);
+                for (int i = 0; i < 9; i++) sum.sh[i] += radiance * (basis[i] * kShBasis[i]);
+                sum.weight += w;
+            }
+            rows[row] = sum;
+        }
+    });
+
+    RowSum total = {};
+    for (const RowSum& row : rows)
+    {
+        for (int i = 0; i < 9; i++) total.sh[i] += row.sh[i];
+        total.weight += row.weight;
+    }
+    // The texel solid angles add up to 4 pi up to rounding; renormalize.
+    float scale = total.weight > 0.0f ? 4.0f * glm::pi<float>() / total.weight : 0.0f;
+    for (int i = 0; i < 9; i++)
+        out.coefficients[i] = glm::vec4(total.sh[i] * (scale * kShCosine[i] * kShBasis[i]), 0.0f);
+}
+
+bool EnvironmentPrefilter::LoadOrProjectIrradiance(const std::vector<std::string>& faces, IrradianceSH& out)
+{
+    FaceSetStamp stamp;
+    if (!stampFaces(faces, stamp)) return false;
+    std::filesystem::path entry = cacheEntry(stamp, "sh9.bin");
+
+    const bool cached = TextureBaker::IsEnabled();
+    if (cached)
+    {
+        ShCacheFile file;
+        MappedFile in(entry.string());
+        if (in.IsOpen() && in.Size() == sizeof(file) && std::memcpy(&file, in.Data(), sizeof(file)) &&
+            file.tag == kShTag && file.version == Version && file.stamp == stamp.stamp && file.newest == stamp.newest)
+        {
+            for (int i = 0; i < 9; i++)
+                out.coefficients[i] = glm::vec4(file.coefficients[i][0], file.coefficients[i][1],
+                                                file.coefficients[i][2], 0.0f);
+            return true;
+        }
+    }
+
+    DecodedFaces decoded;
+    if (!decodeFaces(faces, decoded)) return false;
+    {
+        LoadProfiler::Scope scope("sh-project", faces[0]);
+        ProjectIrradiance(decoded.data, decoded.size, out);
+    }
+
+    if (cached)
+    {
+        ShCacheFile file = {kShTag, Version, stamp.stamp, stamp.newest, {}};
+        for (int i = 0; i < 9; i++)
+            for (int c = 0; c < 4; c++) file.coefficients[i][c] = out.coefficients[i][c];
+
+        std::error_code ec;
+        std::filesystem::create_directories(entry.parent_path(), ec);
+        std::ofstream outFile(entry, std::ios::binary | std::ios::trunc);
+        if (!outFile.write(reinterpret_cast<const char*>(&file), sizeof(file)))
+            std::cout << "ERROR::ENVIRONMENT_PREFILTER:: cannot write " << entry.string() << std::endl;
+    }
+    return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+#include "TextureBaker.h"
+
+// Diffuse irradiance of an environment as nine L2 spherical-harmonic RGB
+// coefficients, already convolved with the clamped cosine and divided by pi,
+// so a Lambertian surface with normal n reflects albedo * Eval(n). The basis
+// constants are folded in; shaders evaluate
+//   c0 + c1 y + c2 z + c3 x + c4 xy + c5 yz + c6 (3z^2 - 1) + c7 xz + c8 (x^2 - y^2).
+// vec4s so the array uploads as-is into a std140 block (w is unused).
+struct IrradianceSH {
+    glm::vec4 coefficients[9] = {};
+
+    glm::vec3 Eval(const glm::vec3& n) const;
+};
+
+// Convolves a cube map with the GGX distribution into a roughness mip chain
+// for glossy reflections: level m holds perceptual roughness m / (levels - 1),
+// so shaders pick a level with roughness * maxLod. Each level is importance
+// sampled from a float mip chain of the source (filtered importance sampling),
+// rows are split across the ThreadPool and every tap is one SSE vector, with a
+// scalar path for other targets. It also projects the faces onto L2 spherical
+// harmonics for diffuse lighting. Results live next to the TextureBaker's
+// entries: one uncompressed DDS chain per face, and the SH coefficients.
+class EnvironmentPrefilter
+{
+public:
+    static constexpr unsigned int Version = 1;
+    // Level 0 is the source box-filtered down to at most this size.
+    static constexpr int MaxBaseSize = 512;
+    // The chain stops before faces get smaller than this.
+    static constexpr int MinLevelSize = 8;
+
+    // Thread-safe. Fills `out` with one sRGB RGB8 chain per face, in
+    // GL_TEXTURE_CUBE_MAP_POSITIVE_X order. Reads the bake cache when the
+    // faces are unchanged since they were prefiltered; bypasses it when the
+    // TextureBaker is disabled.
+    static bool LoadOrBake(const std::vector<std::string>& faces, std::vector<TextureImage>& out);
+
+    // Square sRGB RGB8 faces of `size` texels.
+    static void Prefilter(const unsigned char* const faces[6], int size, std::vector<TextureImage>& out);
+
+    // Thread-safe. Same caching as LoadOrBake.
+    static bool LoadOrProjectIrradiance(const std::vector<std::string>& faces, IrradianceSH& out);
+    // Solid-angle weighted projection, rows reduced in parallel.
+    static void ProjectIrradiance(const unsigned char* const faces[6], int size, IrradianceSH& out);
+};
@@ -0,0 +1,589 @@
+#include "Geometry.h"
+#include "GltfLoader.h"
+#include "LoadProfiler.h"
+#include "MeshSimplifier.h"
+#include "ObjLoader.h"
+#include "TextureCache.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <unordered_map>
+
+namespace
+{
+    std::unordered_map<std::string, std::weak_ptr<Geometry>> s_Registry;
+    std::atomic<bool> s_AnalyzeOverdraw{false};
+    std::atomic<bool> s_NativeLoaders{true};
+
+    size_t meshBytes(const MeshData& data)
+    {
+        return data.vertices.size() * sizeof(Vertex) + data.indices.size() * sizeof(unsigned int);
+    }
+
+    // Files that bring their own tangents (glTF TANGENT) keep them.
+    bool needsTangents(const Geometry::ImportedMesh& mesh, bool tangentsForAll)
+    {
+        const std::vector<Vertex>& vertices = mesh.data.vertices;
+        if (std::any_of(vertices.begin(), vertices.end(), [](const Vertex& v) { return v.Tangent != glm::vec3(0.0f); }))
+            return false;
+        return tangentsForAll || std::any_of(mesh.textures.begin(), mesh.textures.end(), [](const auto& texture) {
+                   return texture.type == "texture_normal";
+               });
+    }
+
+    size_t importedBytes(const Geometry::ImportData& data)
+    {
+        size_t bytes = 0;
+        for (const Geometry::ImportedMesh& mesh : data.meshes) bytes += meshBytes(mesh.data);
+        return bytes;
+    }
+}
+
+std::shared_ptr<Geometry> Geometry::Load(const std::string& path)
+{
+    std::string key = registryKey(path);
+    if (auto existing = findLoaded(key))
+        return existing;
+
+    std::shared_ptr<Geometry> geometry(new Geometry());
+    ImportData data;
+    if (Import(path, data))
+        geometry->Upload(data, data.meshes.size());
+    registerLoaded(key, geometry);
+    return geometry;
+}
+
+std::shared_ptr<Geometry> Geometry::Find(const std::string& path)
+{
+    return findLoaded(registryKey(path));
+}
+
+std::string Geometry::registryKey(const std::string& path)
+{
+    std::error_code ec;
+    std::string key = std::filesystem::weakly_canonical(path, ec).generic_string();
+    return ec ? path : key;
+}
+
+std::shared_ptr<Geometry> Geometry::findLoaded(const std::string& key)
+{
+    auto it = s_Registry.find(key);
+    return it == s_Registry.end() ? nullptr : it->second.lock();
+}
+
+void Geometry::registerLoaded(const std::string& key, const std::shared_ptr<Geometry>& geometry)
+{
+    s_Registry[key] = geometry;
+}
+
+std::shared_ptr<Geometry> Geometry::Create()
+{
+    return std::shared_ptr<Geometry>(new Geometry());
+}
+
+Geometry::~Geometry()
+{
+    for (const Texture& texture : textures_loaded)
+        TextureCache::Release(texture.id);
+}
+
+void Geometry::Draw(Shader& shader, const std::vector<Texture>& extraTextures, const glm::mat4* model,
+                    const unsigned char* visibleMeshlets, float maxLodError)
+{
+    for (unsigned int i = 0; i < meshes.size(); i++)
+    {
+        meshes[i].Draw(shader, extraTextures, model, visibleMeshlets, meshes[i].SelectLod(maxLodError));
+        if (visibleMeshlets) visibleMeshlets += meshes[i].meshlets.size();
+    }
+}
+
+size_t Geometry::MeshletCount() const
+{
+    size_t count = 0;
+    for (const Mesh& mesh : meshes)
+        count += mesh.meshlets.size();
+    return count;
+}
+
+bool Geometry::Import(const std::string& path, ImportData& out, bool tangentsForAll)
+{
+    out = ImportData{};
+    out.path = path;
+    out.tangentsForAll = tangentsForAll;
+
+    // Warm start: the cached streams are uploaded directly from the mapping.
+    LoadProfiler::Clock::time_point start = LoadProfiler::Clock::now();
+    bool cached = MeshCache::Load(path, cacheFlags(tangentsForAll), out.cached);
+    LoadProfiler::Record("mesh-cache-read", path, start, LoadProfiler::Clock::now(),
+                         cached ? out.cached.file->Size() : 0);
+    if (cached)
+    {
+        out.fromCache = true;
+        out.meshes.resize(out.cached.meshes.size());
+        for (size_t i = 0; i < out.cached.meshes.size(); i++)
+        {
+            for (const auto& binding : out.cached.meshes[i].textures)
+                out.meshes[i].textures.push_back({binding.type, binding.path, -1});
+        }
+        return true;
+    }
+
+    // OBJ and glTF skip Assimp; anything their loaders turn down (sparse or
+    // compressed glTF accessors, say) still goes through it.
+    if (s_NativeLoaders)
+    {
+        start = LoadProfiler::Clock::now();
+        bool parsed = importNative(path, out);
+        LoadProfiler::Record("parse-native", path, start, LoadProfiler::Clock::now(), importedBytes(out));
+        if (parsed)
+        {
+            optimizeImported(path, out);
+            return true;
+        }
+    }
+
+    start = LoadProfiler::Clock::now();
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(path, ImportFlags);
+    LoadProfiler::Record("parse-assimp", path, start, LoadProfiler::Clock::now(), 0);
+
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+    {
+        std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
+        return false;
+    }
+
+    std::vector<const aiMesh*> order;
+    processNode(scene->mRootNode, scene, order);
+
+    // Convert every aiMesh in parallel into its own pre-sized slot, so the
+    // result is independent of scheduling.
+    start = LoadProfiler::Clock::now();
+    out.meshes.resize(order.size());
+    ThreadPool::Get().ParallelFor(order.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            processMesh(order[i], out.meshes[i].data);
+    });
+    LoadProfiler::Record("process-mesh", path, start, LoadProfiler::Clock::now(), importedBytes(out));
+
+    // The importer owns the scene, so texture references (and embedded image
+    // bytes) are copied out before it goes away. Tangents depend on them.
+    std::unordered_map<std::string, int> embeddedIndex;
+    for (ImportedMesh& mesh : out.meshes)
+        mesh.textures = importMeshTextures(scene, scene->mMaterials[mesh.data.materialIndex], out, embeddedIndex);
+    optimizeImported(path, out);
+    return true;
+}
+
+bool Geometry::Upload(ImportData& data, size_t maxMeshes)
+{
+    if (data.uploaded == 0)
+    {
+        sourcePath = data.path;
+        directory = std::filesystem::path(data.path).parent_path().string();
+        meshes.reserve(data.meshes.size());
+    }
+
+    // Textures and buffers are created on the context thread, in node traversal order.
+    size_t end = std::min(data.meshes.size(), data.uploaded + maxMeshes);
+    for (; data.uploaded < end; data.uploaded++)
+    {
+        ImportedMesh& mesh = data.meshes[data.uploaded];
+        std::vector<Texture> textures = loadTextures(data, mesh.textures);
+        LoadProfiler::Scope scope("mesh-upload", data.path);
+        if (data.fromCache)
+        {
+            const MeshCache::CachedMesh& cached = data.cached.meshes[data.uploaded];
+            scope.AddBytes(cached.vertexCount * sizeof(Vertex) + cached.indexCount * sizeof(unsigned int));
+            meshes.emplace_back(cached.vertices, cached.vertexCount, cached.indices, cached.indexCount,
+                                cached.meshlets, cached.meshletCount, cached.lods, cached.lodCount,
+                                std::move(textures));
+        }
+        else
+        {
+            scope.AddBytes(meshBytes(mesh.data));
+            meshes.emplace_back(std::move(mesh.data.vertices), std::move(mesh.data.indices), std::move(textures),
+                                std::move(mesh.data.meshlets), std::move(mesh.data.lods));
+        }
+    }
+    if (data.uploaded < data.meshes.size()) return false;
+    complete = true;
+    tangentsForAll = data.tangentsForAll;
+
+    // Embedded textures live inside the source file, so those scenes can't be
+    // rebuilt from the cache alone.
+    if (!data.fromCache && data.embedded.empty())
+    {
+        LoadProfiler::Scope scope("mesh-cache-write", data.path);
+        MeshCache::Store(data.path, cacheFlags(data.tangentsForAll), meshes);
+    }
+    data.cached = MeshCache::CachedModel{};
+    // A Material asked for tangents while this was still loading.
+    if (tangentsRequested && !tangentsForAll) reimportWithTangents();
+    return true;
+}
+
+void Geometry::Replace(ImportData& data)
+{
+    Geometry fresh;
+    fresh.Upload(data, data.meshes.size());
+    meshes.swap(fresh.meshes);
+    textures_loaded.swap(fresh.textures_loaded);
+    tangentsForAll = fresh.tangentsForAll;
+    // Meshes never free their buffers on their own; `fresh` releases the old
+    // textures when it goes.
+    for (Mesh& mesh : fresh.meshes) mesh.Release();
+}
+
+bool Geometry::Bake(const std::string& path, ImportData& out)
+{
+    if (!Import(path, out)) return false;
+    if (out.fromCache) return true;
+    if (!out.embedded.empty()) return false;
+
+    // Fill in what the Mesh constructor would, so the entry matches one
+    // written by Upload().
+    std::vector<MeshCache::CachedMesh> views(out.meshes.size());
+    for (size_t i = 0; i < out.meshes.size(); i++)
+    {
+        MeshData& data = out.meshes[i].data;
+        if (data.lods.empty()) data.lods.push_back({0, static_cast<uint32_t>(data.indices.size()), 0.0f});
+        if (data.meshlets.empty())
+            data.meshlets = MeshOptimizer::SplitMeshlets(data.vertices.data(), data.vertices.size(),
+                                                         data.indices.data(), data.lods[0].indexCount);
+        views[i] = {data.vertices.data(), static_cast<uint32_t>(data.vertices.size()),
+                    data.indices.data(), static_cast<uint32_t>(data.indices.size()),
+                    data.meshlets.data(), static_cast<uint32_t>(data.meshlets.size()),
+                    data.lods.data(), static_cast<uint32_t>(data.lods.size()), {}};
+        for (const ImportedTexture& texture : out.meshes[i].textures)
+            views[i].textures.push_back({texture.type, texture.path});
+    }
+    return MeshCache::Store(path, cacheFlags(out.tangentsForAll), views);
+}
+
+unsigned int Geometry::cacheFlags(bool tangentsForAll)
+{
+    // Assimp no longer computes tangents, so its flag is free to mean "on every mesh".
+    return tangentsForAll ? ImportFlags | aiProcess_CalcTangentSpace : ImportFlags;
+}
+
+void Geometry::RequireTangents()
+{
+    if (tangentsForAll || tangentsRequested) return;
+    tangentsRequested = true;
+    if (complete) reimportWithTangents();
+}
+
+void Geometry::reimportWithTangents()
+{
+    // Imported meshes only have tangents where their own material has a
+    // normal map. Usually runs at setup, and the mesh cache keeps the result
+    // (under its own key) for the next start.
+    if (sourcePath.empty()) return;
+    ImportData data;
+    if (Import(sourcePath, data, true)) Replace(data);
+}
+
+void Geometry::SetOverdrawAnalysis(bool enabled)
+{
+    s_AnalyzeOverdraw = enabled;
+}
+
+void Geometry::SetNativeLoaders(bool enabled)
+{
+    s_NativeLoaders = enabled;
+}
+
+void Geometry::BenchmarkImport(const std::string& path, int runs)
+{
+    // Both sides stop at raw MeshData; welding and optimization are shared
+    // and would only dilute the comparison.
+    auto best = [runs](const std::function<bool()>& load) {
+        double bestMs = -1.0;
+        for (int i = 0; i < runs; i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            if (!load()) return -1.0;
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            bestMs = bestMs < 0.0 ? ms : std::min(bestMs, ms);
+        }
+        return bestMs;
+    };
+    auto triangles = [](const ImportData& data) {
+        size_t count = 0;
+        for (const ImportedMesh& mesh : data.meshes) count += mesh.data.indices.size() / 3;
+        return count;
+    };
+
+    size_t nativeTriangles = 0, assimpTriangles = 0;
+    double nativeMs = best([&]() {
+        ImportData data;
+        if (!importNative(path, data)) return false;
+        nativeTriangles = triangles(data);
+        return true;
+    });
+    double assimpMs = best([&]() {
+        Assimp::Importer importer;
+        const aiScene* scene = importer.ReadFile(path, ImportFlags);
+        if (!scene || !scene->mRootNode) return false;
+        std::vector<const aiMesh*> order;
+        processNode(scene->mRootNode, scene, order);
+        ImportData data;
+        data.meshes.resize(order.size());
+        for (size_t i = 0; i < order.size(); i++)
+            processMesh(order[i], data.meshes[i].data);
+        assimpTriangles = triangles(data);
+        return true;
+    });
+
+    std::cout << "Geometry:: " << std::filesystem::path(path).filename().string() << " best of " << runs
+              << ": native " << nativeMs << " ms (" << nativeTriangles << " triangles), Assimp " << assimpMs
+              << " ms (" << assimpTriangles << " triangles)";
+    if (nativeMs > 0.0 && assimpMs > 0.0) std::cout << ", " << assimpMs / nativeMs << "x";
+    std::cout << std::endl;
+}
+
+bool Geometry::importNative(const std::string& path, ImportData& out)
+{
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (extension == ".obj")
+    {
+        std::vector<ObjLoader::Mesh> meshes;
+        if (!ObjLoader::Load(path, meshes)) return false;
+        out.meshes.resize(meshes.size());
+        for (size_t i = 0; i < meshes.size(); i++)
+        {
+            out.meshes[i].data = std::move(meshes[i].data);
+            for (const auto& texture : meshes[i].textures)
+                out.meshes[i].textures.push_back({texture.type, texture.path, -1});
+        }
+        return true;
+    }
+
+    if (extension == ".gltf" || extension == ".glb")
+    {
+        std::vector<GltfLoader::Mesh> meshes;
+        if (!GltfLoader::Load(path, meshes, out.embedded))
+        {
+            out.embedded.clear();
+            return false;
+        }
+        out.meshes.resize(meshes.size());
+        for (size_t i = 0; i < meshes.size(); i++)
+        {
+            out.meshes[i].data = std::move(meshes[i].data);
+            for (const auto& texture : meshes[i].textures)
+                out.meshes[i].textures.push_back({texture.type, texture.path, texture.embedded});
+        }
+        return true;
+    }
+    return false;
+}
+
+void Geometry::optimizeImported(const std::string& path, ImportData& out)
+{
+    // Face-corner vertices (Assimp emits one per corner) are welded, given
+    // tangents if a normal map needs them, then reordered for the vertex
+    // cache, overdraw and vertex fetch, and given coarser LODs. The mesh cache
+    // stores the result. Tangents come after the weld so corners share frames
+    // the way MikkTSpace expects, and with V up (the UVs are flipped by now),
+    // the convention the normal maps are baked in.
+    LoadProfiler::Scope scope("optimize", path);
+    std::vector<MeshOptimizer::WeldStats> welds(out.meshes.size());
+    std::vector<MeshOptimizer::OptimizeStats> optimized(out.meshes.size());
+    bool analyzeOverdraw = s_AnalyzeOverdraw;
+    ThreadPool::Get().ParallelFor(out.meshes.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            welds[i] = MeshOptimizer::Weld(out.meshes[i].data, WeldEpsilon);
+            if (needsTangents(out.meshes[i], out.tangentsForAll))
+                MeshOptimizer::GenerateTangents(out.meshes[i].data, true);
+            optimized[i] = MeshOptimizer::Optimize(out.meshes[i].data, analyzeOverdraw);
+            MeshSimplifier::BuildLods(out.meshes[i].data);
+        }
+    });
+    scope.AddBytes(importedBytes(out));
+    logImportStats(path, welds, optimized);
+}
+
+void Geometry::logImportStats(const std::string& path, const std::vector<MeshOptimizer::WeldStats>& welds,
+                              const std::vector<MeshOptimizer::OptimizeStats>& optimized)
+{
+    // Per-mesh ratios are weighted by triangles (ACMR, overdraw) or welded
+    // vertices (ATVR) so the totals describe the whole file.
+    size_t before = 0, after = 0, triangles = 0;
+    double acmrWeld = 0.0, acmrBefore = 0.0, acmrAfter = 0.0;
+    double atvrBefore = 0.0, atvrAfter = 0.0;
+    double overdrawBefore = 0.0, overdrawAfter = 0.0;
+    for (size_t i = 0; i < welds.size(); i++)
+    {
+        const auto& weld = welds[i];
+        const auto& opt = optimized[i];
+        before += weld.verticesBefore;
+        after += weld.verticesAfter;
+        triangles += weld.triangles;
+        acmrWeld += double(weld.acmrBefore) * weld.triangles;
+        acmrBefore += double(opt.acmrBefore) * weld.triangles;
+        acmrAfter += double(opt.acmrAfter) * weld.triangles;
+        atvrBefore += double(opt.atvrBefore) * weld.verticesAfter;
+        atvrAfter += double(opt.atvrAfter) * weld.verticesAfter;
+        overdrawBefore += double(opt.overdrawBefore) * weld.triangles;
+        overdrawAfter += double(opt.overdrawAfter) * weld.triangles;
+    }
+    if (triangles == 0) return;
+
+    std::cout << "Geometry:: " << std::filesystem::path(path).filename().string() << " welded " << before << " -> "
+              << after << " vertices, ACMR " << acmrWeld / triangles << " -> " << acmrBefore / triangles << " -> "
+              << acmrAfter / triangles << ", ATVR " << atvrBefore / std::max<size_t>(after, 1) << " -> "
+              << atvrAfter / std::max<size_t>(after, 1);
+    if (overdrawAfter > 0.0)
+        std::cout << ", overdraw " << overdrawBefore / triangles << " -> " << overdrawAfter / triangles;
+    std::cout << std::endl;
+}
+
+void Geometry::processNode(aiNode* node, const aiScene* scene, std::vector<const aiMesh*>& order)
+{
+    for (unsigned int i = 0; i < node->mNumMeshes; i++)
+    {
+        order.push_back(scene->mMeshes[node->mMeshes[i]]);
+    }
+    for (unsigned int i = 0; i < node->mNumChildren; i++)
+    {
+        processNode(node->mChildren[i], scene, order);
+    }
+}
+
+void Geometry::processMesh(const aiMesh* mesh, MeshData& out)
+{
+    const bool hasNormals = mesh->HasNormals();
+    const bool hasTexCoords = mesh->mTextureCoords[0] != nullptr;
+    const bool hasTangents = hasTexCoords && mesh->HasTangentsAndBitangents();
+
+    // 1. Vertices. Large single-mesh files (discoball.obj) would otherwise keep
+    // one core busy, so the copy itself is also split into ranges.
+    out.vertices.resize(mesh->mNumVertices);
+    ThreadPool::Get().ParallelFor(mesh->mNumVertices, 16384, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            Vertex& vertex = out.vertices[i];
+            vertex = Vertex{};
+
+            vertex.Position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+
+            if (hasNormals)
+                vertex.Normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+
+            if (hasTexCoords)
+                vertex.TexCoords = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+
+            if (hasTangents)
+            {
+                vertex.Tangent = glm::vec3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
+                vertex.Bitangent =
+                    glm::vec3(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z);
+            }
+        }
+    });
+
+    // 2. Indices
+    size_t indexCount = 0;
+    for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+        indexCount += mesh->mFaces[i].mNumIndices;
+
+    out.indices.resize(indexCount);
+    unsigned int* dst = out.indices.data();
+    for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+    {
+        const aiFace& face = mesh->mFaces[i];
+        for (unsigned int j = 0; j < face.mNumIndices; j++)
+            *dst++ = face.mIndices[j];
+    }
+
+    out.materialIndex = mesh->mMaterialIndex;
+}
+
+std::vector<Geometry::ImportedTexture> Geometry::importMeshTextures(const aiScene* scene, aiMaterial* material,
+                                                                    ImportData& data,
+                                                                    std::unordered_map<std::string, int>& embeddedIndex)
+{
+    std::vector<ImportedTexture> textures;
+    importMaterialTextures(scene, material, aiTextureType_DIFFUSE, "texture_diffuse", data, embeddedIndex, textures);
+    importMaterialTextures(scene, material, aiTextureType_SPECULAR, "texture_specular", data, embeddedIndex, textures);
+    importMaterialTextures(scene, material, aiTextureType_HEIGHT, "texture_normal", data, embeddedIndex, textures);
+    importMaterialTextures(scene, material, aiTextureType_AMBIENT, "texture_height", data, embeddedIndex, textures);
+    return textures;
+}
+
+void Geometry::importMaterialTextures(const aiScene* scene, aiMaterial* mat, aiTextureType type,
+                                      const std::string& typeName, ImportData& data,
+                                      std::unordered_map<std::string, int>& embeddedIndex,
+                                      std::vector<ImportedTexture>& out)
+{
+    for (unsigned int i = 0; i < mat->GetTextureCount(type); i++)
+    {
+        aiString str;
+        mat->GetTexture(type, i, &str);
+
+        ImportedTexture texture;
+        texture.type = typeName;
+        texture.path = str.C_Str();
+
+        const aiTexture* embeddedTex = scene->GetEmbeddedTexture(str.C_Str());
+        if (embeddedTex)
+        {
+            auto it = embeddedIndex.find(texture.path);
+            if (it == embeddedIndex.end())
+            {
+                size_t size = embeddedTex->mHeight == 0 ? embeddedTex->mWidth
+                                                        : size_t(embeddedTex->mWidth) * embeddedTex->mHeight;
+                const unsigned char* bytes = reinterpret_cast<const unsigned char*>(embeddedTex->pcData);
+                data.embedded.emplace_back(bytes, bytes + size);
+                it = embeddedIndex.emplace(texture.path, static_cast<int>(data.embedded.size()) - 1).first;
+            }
+            texture.embedded = it->second;
+        }
+        out.push_back(texture);
+    }
+}
+
+std::vector<Texture> Geometry::loadTextures(const ImportData& data, const std::vector<ImportedTexture>& imported)
+{
+    std::vector<Texture> textures;
+    for (const ImportedTexture& source : imported)
+    {
+        Texture texture;
+        if (source.embedded >= 0)
+            texture.id = TextureFromMemory(data.embedded[source.embedded], source.path, source.type);
+        else
+            texture.id = TextureFromFile(source.path.c_str(), this->directory, source.type);
+        if (texture.id == 0) continue;
+
+        texture.type = source.type;
+        texture.path = source.path;
+        textures.push_back(texture);
+        textures_loaded.push_back(texture);
+    }
+    return textures;
+}
+
+unsigned int Geometry::TextureFromMemory(const std::vector<unsigned char>& bytes, const std::string& name,
+                                         const std::string& typeName)
+{
+    return TextureCache::AcquireFromMemory(sourcePath + "#" + name, bytes.data(), bytes.size(), TextureSettings{},
+                                           TextureLoader::PlaceholderFor(typeName));
+}
+
+unsigned int Geometry::TextureFromFile(const char* path, const std::string& directory, const std::string& typeName)
+{
+    std::filesystem::path fullPath = std::filesystem::path(directory) / path;
+    return TextureCache::Acquire(fullPath.string(), TextureSettings{}, TextureLoader::PlaceholderFor(typeName));
+}
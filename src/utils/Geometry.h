@@ -0,0 +1,147 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include "Mesh.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "Shader.h"
+#include "RenderTypes.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Imported meshes plus the textures their materials reference. Geometry is
+// shader-agnostic and shared: Load() hands every caller asking for the same
+// file the same instance, so a mesh drawn with several programs is imported,
+// kept in RAM and uploaded to VRAM once.
+class Geometry
+{
+public:
+    std::vector<Texture> textures_loaded;
+    std::vector<Mesh>    meshes;
+    std::string directory;
+
+    struct ImportedTexture {
+        std::string type;
+        std::string path;
+        int embedded = -1; // index into ImportData::embedded
+    };
+
+    struct ImportedMesh {
+        MeshData data; // empty when the streams come from the mesh cache
+        std::vector<ImportedTexture> textures;
+    };
+
+    // Everything Load() needs from disk, produced without touching GL.
+    struct ImportData {
+        std::string path;
+        MeshCache::CachedModel cached;
+        std::vector<ImportedMesh> meshes;
+        std::vector<std::vector<unsigned char>> embedded;
+        bool fromCache = false;
+        bool tangentsForAll = false;
+        size_t uploaded = 0;
+    };
+
+    static std::shared_ptr<Geometry> Load(const std::string& path);
+    // The live Geometry loaded from `path`, if any.
+    static std::shared_ptr<Geometry> Find(const std::string& path);
+    // Empty geometry for procedurally generated meshes; never shared.
+    static std::shared_ptr<Geometry> Create();
+
+    ~Geometry();
+
+    Geometry(const Geometry&) = delete;
+    Geometry& operator=(const Geometry&) = delete;
+
+    // `extraTextures` are bound after each mesh's own textures, continuing the
+    // texture_diffuseN/texture_normalN numbering. `visibleMeshlets` holds one
+    // byte per meshlet, meshes back to back (see Mesh::Draw). Each mesh draws
+    // its coarsest LOD within `maxLodError` mesh units.
+    void Draw(Shader& shader, const std::vector<Texture>& extraTextures = {}, const glm::mat4* model = nullptr,
+              const unsigned char* visibleMeshlets = nullptr, float maxLodError = 0.0f);
+    size_t MeshletCount() const;
+
+    // CPU half of Load(): maps the mesh cache entry or parses the file, with
+    // ObjLoader for .obj, GltfLoader for .gltf/.glb and Assimp for everything
+    // else. Safe to call from any thread. Tangents are generated only for
+    // meshes whose own material has a texture_normal, or for every mesh with
+    // `tangentsForAll`; files that bring their own keep those.
+    static bool Import(const std::string& path, ImportData& out, bool tangentsForAll = false);
+    // GPU half: creates at most `maxMeshes` of the imported meshes (and their
+    // textures) on the GL thread. Returns true once every mesh exists.
+    bool Upload(ImportData& data, size_t maxMeshes);
+    // Import() plus the MeshCache entry Upload() would write, without GL, for
+    // the asset packer. False if the file can't be cached (embedded textures).
+    static bool Bake(const std::string& path, ImportData& out);
+    // GL thread. Uploads a fresh import and swaps its meshes and textures in,
+    // so this instance, and every Model's reference to its meshes, stays valid.
+    void Replace(ImportData& data);
+    // Whether every mesh was imported with tangents.
+    bool TangentsForAll() const { return tangentsForAll; }
+    // For a Material bringing its own normal map: reimports with tangents on
+    // every mesh and swaps them in. GL thread, never while drawing, since the
+    // meshlet counts may change (Model::AddTexture and Renderer::Submit call
+    // it). A geometry still loading is reimported once its upload completes.
+    void RequireTangents();
+
+    // Also measure overdraw before/after optimization on import. It rasterizes
+    // every mesh a dozen times, so it is off unless you are checking the gains.
+    static void SetOverdrawAnalysis(bool enabled);
+    // Route .obj and glTF files through Assimp again (native loaders are on by
+    // default), e.g. to compare imports.
+    static void SetNativeLoaders(bool enabled);
+    // Times the native loader against Assimp (best of `runs`, parse and
+    // conversion only) on one file and prints both.
+    static void BenchmarkImport(const std::string& path, int runs = 5);
+
+private:
+    friend class AssetLoader;
+
+    static constexpr unsigned int ImportFlags =
+        aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs;
+    // Attribute tolerance for merging duplicated face-corner vertices.
+    static constexpr float WeldEpsilon = 1e-5f;
+
+    std::string sourcePath;
+    bool complete = false;
+    bool tangentsForAll = false;
+    bool tangentsRequested = false;
+
+    Geometry() = default;
+
+    // Mesh cache key: ImportFlags, plus a bit for imports with tangents on
+    // every mesh, whose vertices differ.
+    static unsigned int cacheFlags(bool tangentsForAll);
+    void reimportWithTangents();
+
+    static std::string registryKey(const std::string& path);
+    static std::shared_ptr<Geometry> findLoaded(const std::string& key);
+    static void registerLoaded(const std::string& key, const std::shared_ptr<Geometry>& geometry);
+
+    static bool importNative(const std::string& path, ImportData& out);
+    static void optimizeImported(const std::string& path, ImportData& out);
+    static void logImportStats(const std::string& path, const std::vector<MeshOptimizer::WeldStats>& welds,
+                               const std::vector<MeshOptimizer::OptimizeStats>& optimized);
+    static void processNode(aiNode *node, const aiScene *scene, std::vector<const aiMesh*>& order);
+    static void processMesh(const aiMesh *mesh, MeshData& out);
+    static std::vector<ImportedTexture> importMeshTextures(const aiScene* scene, aiMaterial* material,
+                                                           ImportData& data,
+                                                           std::unordered_map<std::string, int>& embeddedIndex);
+    static void importMaterialTextures(const aiScene* scene, aiMaterial* mat, aiTextureType type,
+                                       const std::string& typeName, ImportData& data,
+                                       std::unordered_map<std::string, int>& embeddedIndex,
+                                       std::vector<ImportedTexture>& out);
+    std::vector<Texture> loadTextures(const ImportData& data, const std::vector<ImportedTexture>& imported);
+
+    unsigned int TextureFromMemory(const std::vector<unsigned char>& bytes, const std::string& name,
+                                   const std::string& typeName);
+    unsigned int TextureFromFile(const char *path, const std::string &directory, const std::string &typeName);
+};
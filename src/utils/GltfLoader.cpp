@@ -0,0 +1,612 @@
+#include "GltfLoader.h"
+#include "Json.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <numeric>
+#include <unordered_map>
+
+namespace
+{
+    constexpr uint32_t GlbMagic = 0x46546C67;     // "glTF"
+    constexpr uint32_t GlbChunkJson = 0x4E4F534A; // "JSON"
+    constexpr uint32_t GlbChunkBin = 0x004E4942;  // "BIN\0"
+
+    enum ComponentType {
+        Byte = 5120,
+        UnsignedByte = 5121,
+        Short = 5122,
+        UnsignedShort = 5123,
+        UnsignedInt = 5125,
+        Float = 5126,
+    };
+
+    enum PrimitiveMode { Triangles = 4, TriangleStrip = 5, TriangleFan = 6 };
+
+    struct Buffer {
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+    };
+
+    struct Document {
+        Json json;
+        std::filesystem::path directory;
+        std::vector<MappedFile> files;                   // the .gltf/.glb itself and external .bin files
+        std::vector<std::vector<unsigned char>> decoded; // data: URI buffers
+        std::vector<Buffer> buffers;
+    };
+
+    // A typed, strided view into a mapped buffer. `data` is null for
+    // accessors without a bufferView, which read as zeros.
+    struct Accessor {
+        const unsigned char* data = nullptr;
+        size_t count = 0;
+        size_t stride = 0;
+        int componentType = 0;
+        int components = 0;
+        bool normalized = false;
+    };
+
+    bool fail(const std::string& message)
+    {
+        std::cout << "ERROR::GLTF:: " << message << std::endl;
+        return false;
+    }
+
+    uint32_t read32(const unsigned char* p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, 4);
+        return value;
+    }
+
+    size_t componentSize(int componentType)
+    {
+        switch (componentType)
+        {
+        case Byte:
+        case UnsignedByte: return 1;
+        case Short:
+        case UnsignedShort: return 2;
+        case UnsignedInt:
+        case Float: return 4;
+        default: return 0;
+        }
+    }
+
+    int componentCount(const std::string& type)
+    {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4" || type == "MAT2") return 4;
+        if (type == "MAT3") return 9;
+        if (type == "MAT4") return 16;
+        return 0;
+    }
+
+    float readComponent(const unsigned char* p, int componentType, bool normalized)
+    {
+        switch (componentType)
+        {
+        case Float:
+        {
+            float value;
+            std::memcpy(&value, p, 4);
+            return value;
+        }
+        case UnsignedByte: return normalized ? p[0] / 255.0f : float(p[0]);
+        case Byte:
+        {
+            int8_t value = static_cast<int8_t>(p[0]);
+            return normalized ? std::max(value / 127.0f, -1.0f) : float(value);
+        }
+        case UnsignedShort:
+        {
+            uint16_t value;
+            std::memcpy(&value, p, 2);
+            return normalized ? value / 65535.0f : float(value);
+        }
+        case Short:
+        {
+            int16_t value;
+            std::memcpy(&value, p, 2);
+            return normalized ? std::max(value / 32767.0f, -1.0f) : float(value);
+        }
+        case UnsignedInt:
+        {
+            uint32_t value;
+            std::memcpy(&value, p, 4);
+            return float(value);
+        }
+        default: return 0.0f;
+        }
+    }
+
+    // The first four components of element `i` over `value`'s defaults.
+    // Float data, by far the common case, is copied without conversion.
+    glm::vec4 readElement(const Accessor& accessor, size_t i, glm::vec4 value)
+    {
+        const int components = std::min(accessor.components, 4);
+        if (!accessor.data)
+        {
+            for (int c = 0; c < components; c++) value[c] = 0.0f;
+            return value;
+        }
+        const unsigned char* p = accessor.data + i * accessor.stride;
+        if (accessor.componentType == Float)
+        {
+            std::memcpy(&value[0], p, size_t(components) * 4);
+            return value;
+        }
+        const size_t size = componentSize(accessor.componentType);
+        for (int c = 0; c < components; c++)
+            value[c] = readComponent(p + c * size, accessor.componentType, accessor.normalized);
+        return value;
+    }
+
+    bool resolveAccessor(const Document& doc, int index, Accessor& out)
+    {
+        const Json& accessor = doc.json["accessors"][index];
+        if (!accessor.IsObject()) return fail("missing accessor " + std::to_string(index));
+        if (accessor.Has("sparse")) return fail("sparse accessors are not supported");
+
+        out.componentType = accessor["componentType"].AsInt();
+        out.components = componentCount(accessor["type"].AsString());
+        out.count = static_cast<size_t>(accessor["count"].AsNumber());
+        out.normalized = accessor["normalized"].AsBool();
+        const size_t elementSize = componentSize(out.componentType) * out.components;
+        if (elementSize == 0) return fail("accessor " + std::to_string(index) + " has an unknown layout");
+        out.stride = elementSize;
+        out.data = nullptr;
+        if (!accessor.Has("bufferView")) return true;
+
+        const Json& view = doc.json["bufferViews"][accessor["bufferView"].AsInt(-1)];
+        const int buffer = view["buffer"].AsInt(-1);
+        if (buffer < 0 || size_t(buffer) >= doc.buffers.size()) return fail("bufferView without a buffer");
+        const size_t viewOffset = static_cast<size_t>(view["byteOffset"].AsNumber());
+        const size_t viewLength = static_cast<size_t>(view["byteLength"].AsNumber());
+        const size_t offset = static_cast<size_t>(accessor["byteOffset"].AsNumber());
+        if (view.Has("byteStride")) out.stride = static_cast<size_t>(view["byteStride"].AsNumber());
+
+        const Buffer& data = doc.buffers[buffer];
+        const size_t last = out.count == 0 ? 0 : offset + out.stride * (out.count - 1) + elementSize;
+        if (viewOffset + viewLength > data.size || last > viewLength || out.stride < elementSize)
+            return fail("accessor " + std::to_string(index) + " lies outside its buffer");
+        out.data = data.data + viewOffset + offset;
+        return true;
+    }
+
+    std::vector<unsigned char> decodeBase64(const std::string& text, size_t begin)
+    {
+        static const auto table = []() {
+            std::array<int8_t, 256> t;
+            t.fill(-1);
+            const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for (int i = 0; i < 64; i++) t[static_cast<unsigned char>(alphabet[i])] = static_cast<int8_t>(i);
+            return t;
+        }();
+
+        std::vector<unsigned char> out;
+        out.reserve((text.size() - begin) * 3 / 4);
+        uint32_t bits = 0;
+        int count = 0;
+        for (size_t i = begin; i < text.size(); i++)
+        {
+            int8_t value = table[static_cast<unsigned char>(text[i])];
+            if (value < 0) continue; // padding and whitespace
+            bits = (bits << 6) | uint32_t(value);
+            if (++count == 4)
+            {
+                out.push_back(static_cast<unsigned char>(bits >> 16));
+                out.push_back(static_cast<unsigned char>(bits >> 8));
+                out.push_back(static_cast<unsigned char>(bits));
+                bits = 0;
+                count = 0;
+            }
+        }
+        if (count == 3)
+        {
+            out.push_back(static_cast<unsigned char>(bits >> 10));
+            out.push_back(static_cast<unsigned char>(bits >> 2));
+        }
+        else if (count == 2)
+        {
+            out.push_back(static_cast<unsigned char>(bits >> 4));
+        }
+        return out;
+    }
+
+    bool isDataUri(const std::string& uri) { return uri.compare(0, 5, "data:") == 0; }
+
+    // data:[<mime>][;base64],<payload>
+    bool decodeDataUri(const std::string& uri, std::vector<unsigned char>& out)
+    {
+        size_t comma = uri.find(',');
+        if (comma == std::string::npos || uri.rfind(";base64", comma) == std::string::npos) return false;
+        out = decodeBase64(uri, comma + 1);
+        return true;
+    }
+
+    // Relative URIs may percent-encode spaces and other reserved characters.
+    std::string decodeUri(const std::string& uri)
+    {
+        std::string out;
+        out.reserve(uri.size());
+        for (size_t i = 0; i < uri.size(); i++)
+        {
+            if (uri[i] == '%' && i + 2 < uri.size() && std::isxdigit(static_cast<unsigned char>(uri[i + 1])) &&
+                std::isxdigit(static_cast<unsigned char>(uri[i + 2])))
+            {
+                out += static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16));
+                i += 2;
+            }
+            else
+            {
+                out += uri[i];
+            }
+        }
+        return out;
+    }
+
+    bool loadBuffers(Document& doc, const Buffer& glbBinary)
+    {
+        const Json& buffers = doc.json["buffers"];
+        doc.buffers.resize(buffers.Size());
+        for (size_t i = 0; i < buffers.Size(); i++)
+        {
+            const std::string& uri = buffers[i]["uri"].AsString();
+            const size_t length = static_cast<size_t>(buffers[i]["byteLength"].AsNumber());
+            Buffer& buffer = doc.buffers[i];
+            if (uri.empty())
+            {
+                if (i != 0 || !glbBinary.data) return fail("buffer " + std::to_string(i) + " has no data");
+                buffer = glbBinary;
+            }
+            else if (isDataUri(uri))
+            {
+                doc.decoded.emplace_back();
+                if (!decodeDataUri(uri, doc.decoded.back()))
+                    return fail("unsupported data URI in buffer " + std::to_string(i));
+                buffer = {doc.decoded.back().data(), doc.decoded.back().size()};
+            }
+            else
+            {
+                doc.files.emplace_back();
+                std::filesystem::path file = doc.directory / decodeUri(uri);
+                if (!doc.files.back().Open(file.string())) return fail("could not map " + file.string());
+                buffer = {doc.files.back().Data(), doc.files.back().Size()};
+            }
+            if (buffer.size < length) return fail("buffer " + std::to_string(i) + " is truncated");
+        }
+        return true;
+    }
+
+    glm::mat4 localTransform(const Json& node)
+    {
+        const Json& matrix = node["matrix"];
+        if (matrix.Size() == 16)
+        {
+            float values[16];
+            for (int i = 0; i < 16; i++) values[i] = static_cast<float>(matrix[i].AsNumber());
+            return glm::make_mat4(values); // both column-major
+        }
+
+        const Json& t = node["translation"];
+        const Json& r = node["rotation"];
+        const Json& s = node["scale"];
+        glm::mat4 transform(1.0f);
+        if (t.Size() == 3)
+            transform = glm::translate(transform, glm::vec3(t[0].AsNumber(), t[1].AsNumber(), t[2].AsNumber()));
+        if (r.Size() == 4)
+        {
+            glm::quat rotation(static_cast<float>(r[3].AsNumber()), static_cast<float>(r[0].AsNumber()),
+                               static_cast<float>(r[1].AsNumber()), static_cast<float>(r[2].AsNumber()));
+            transform *= glm::mat4_cast(rotation);
+        }
+        if (s.Size() == 3)
+            transform = glm::scale(transform, glm::vec3(s[0].AsNumber(), s[1].AsNumber(), s[2].AsNumber()));
+        return transform;
+    }
+
+    bool readIndices(const Document& doc, const Json& primitive, size_t vertexCount, std::vector<unsigned int>& out)
+    {
+        if (!primitive.Has("indices"))
+        {
+            out.resize(vertexCount);
+            std::iota(out.begin(), out.end(), 0u);
+            return true;
+        }
+
+        Accessor accessor;
+        if (!resolveAccessor(doc, primitive["indices"].AsInt(-1), accessor)) return false;
+        bool unsignedType = accessor.componentType == UnsignedByte || accessor.componentType == UnsignedShort ||
+                            accessor.componentType == UnsignedInt;
+        if (accessor.components != 1 || !unsignedType || !accessor.data)
+            return fail("invalid index accessor");
+        out.resize(accessor.count);
+        for (size_t i = 0; i < accessor.count; i++)
+        {
+            const unsigned char* p = accessor.data + i * accessor.stride;
+            uint32_t index = 0;
+            switch (accessor.componentType)
+            {
+            case UnsignedByte: index = p[0]; break;
+            case UnsignedShort:
+            {
+                uint16_t value;
+                std::memcpy(&value, p, 2);
+                index = value;
+                break;
+            }
+            case UnsignedInt: std::memcpy(&index, p, 4); break;
+            default: return fail("invalid index accessor");
+            }
+            if (index >= vertexCount) return fail("index out of range");
+            out[i] = index;
+        }
+        return true;
+    }
+
+    // Strips and fans become plain triangle lists.
+    void triangulate(int mode, std::vector<unsigned int>& indices)
+    {
+        if (mode == Triangles)
+        {
+            indices.resize(indices.size() / 3 * 3);
+            return;
+        }
+        std::vector<unsigned int> list;
+        for (size_t i = 2; i < indices.size(); i++)
+        {
+            if (mode == TriangleFan)
+                list.insert(list.end(), {indices[0], indices[i - 1], indices[i]});
+            else if (i % 2 == 0)
+                list.insert(list.end(), {indices[i - 2], indices[i - 1], indices[i]});
+            else
+                list.insert(list.end(), {indices[i - 1], indices[i - 2], indices[i]});
+        }
+        indices.swap(list);
+    }
+
+    // Returns false (without an error) for primitives with nothing to draw.
+    bool loadPrimitive(const Document& doc, const Json& primitive, const glm::mat4& world, MeshData& out)
+    {
+        const int mode = primitive["mode"].AsInt(Triangles);
+        if (mode != Triangles && mode != TriangleStrip && mode != TriangleFan) return false;
+
+        const Json& attributes = primitive["attributes"];
+        Accessor position, normal, texcoord, tangent;
+        if (!attributes.Has("POSITION") || !resolveAccessor(doc, attributes["POSITION"].AsInt(-1), position))
+            return false;
+        const size_t count = position.count;
+        auto optional = [&](const char* name, Accessor& accessor) {
+            return attributes.Has(name) && resolveAccessor(doc, attributes[name].AsInt(-1), accessor) &&
+                   accessor.count == count;
+        };
+        const bool hasNormals = optional("NORMAL", normal);
+        const bool hasTexCoords = optional("TEXCOORD_0", texcoord);
+        const bool hasTangents = hasNormals && optional("TANGENT", tangent);
+
+        if (!readIndices(doc, primitive, count, out.indices)) return false;
+        triangulate(mode, out.indices);
+        if (out.indices.empty()) return false;
+
+        // One pass from the mapped accessors into Vertex. Transforms are only
+        // applied for nodes that have one.
+        const bool identity = world == glm::mat4(1.0f);
+        const glm::mat3 linear(world);
+        const glm::mat3 normalMatrix = glm::transpose(glm::inverse(linear));
+        out.vertices.resize(count);
+        ThreadPool::Get().ParallelFor(count, 16384, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                Vertex& vertex = out.vertices[i];
+                vertex = Vertex{};
+                vertex.Position = glm::vec3(readElement(position, i, glm::vec4(0.0f)));
+                if (!identity) vertex.Position = glm::vec3(world * glm::vec4(vertex.Position, 1.0f));
+                if (hasNormals)
+                {
+                    vertex.Normal = glm::vec3(readElement(normal, i, glm::vec4(0.0f)));
+                    if (!identity) vertex.Normal = normalMatrix * vertex.Normal;
+                    float length = glm::length(vertex.Normal);
+                    if (length > 0.0f) vertex.Normal /= length;
+                }
+                if (hasTexCoords) vertex.TexCoords = glm::vec2(readElement(texcoord, i, glm::vec4(0.0f)));
+                if (hasTangents)
+                {
+                    glm::vec4 t = readElement(tangent, i, glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+                    glm::vec3 axis = identity ? glm::vec3(t) : linear * glm::vec3(t);
+                    float length = glm::length(axis);
+                    if (length > 0.0f) vertex.Tangent = axis / length;
+                    vertex.Bitangent = glm::cross(vertex.Normal, vertex.Tangent) * (t.w < 0.0f ? -1.0f : 1.0f);
+                }
+            }
+        });
+
+        // Mirroring transforms flip the winding; keep front faces in front.
+        if (glm::determinant(linear) < 0.0f)
+        {
+            for (size_t i = 0; i + 2 < out.indices.size(); i += 3)
+                std::swap(out.indices[i + 1], out.indices[i + 2]);
+        }
+
+        // The spec asks for flat normals when none are given, so every corner
+        // gets its own vertex; the weld pass merges what it can again.
+        if (!hasNormals)
+        {
+            std::vector<Vertex> corners(out.indices.size());
+            for (size_t i = 0; i + 2 < out.indices.size(); i += 3)
+            {
+                const Vertex* v[3] = {&out.vertices[out.indices[i]], &out.vertices[out.indices[i + 1]],
+                                      &out.vertices[out.indices[i + 2]]};
+                glm::vec3 n = glm::cross(v[1]->Position - v[0]->Position, v[2]->Position - v[0]->Position);
+                float length = glm::length(n);
+                for (int k = 0; k < 3; k++)
+                {
+                    corners[i + k] = *v[k];
+                    corners[i + k].Normal = length > 0.0f ? n / length : glm::vec3(0.0f);
+                    out.indices[i + k] = static_cast<unsigned int>(i + k);
+                }
+            }
+            out.vertices.swap(corners);
+        }
+
+        // glTF puts the UV origin top-left, which is what the other loaders
+        // produce after flipping, so the UVs are kept as stored. Without a
+        // TANGENT attribute, Geometry generates tangents if a normal map needs them.
+
+        out.materialIndex = static_cast<unsigned int>(std::max(primitive["material"].AsInt(0), 0));
+        return true;
+    }
+
+    void addTexture(const Document& doc, const Json& info, const char* type, std::vector<GltfLoader::Texture>& out,
+                    std::vector<std::vector<unsigned char>>& embedded, std::unordered_map<int, int>& embeddedImages)
+    {
+        const int texture = info["index"].AsInt(-1);
+        const int image = doc.json["textures"][texture]["source"].AsInt(-1);
+        const Json& source = doc.json["images"][image];
+        if (texture < 0 || !source.IsObject()) return;
+
+        const std::string& uri = source["uri"].AsString();
+        if (!source.Has("bufferView") && !isDataUri(uri))
+        {
+            out.push_back({type, decodeUri(uri), -1});
+            return;
+        }
+
+        auto cached = embeddedImages.find(image);
+        if (cached == embeddedImages.end())
+        {
+            std::vector<unsigned char> bytes;
+            if (source.Has("bufferView"))
+            {
+                const Json& view = doc.json["bufferViews"][source["bufferView"].AsInt(-1)];
+                const int buffer = view["buffer"].AsInt(-1);
+                const size_t offset = static_cast<size_t>(view["byteOffset"].AsNumber());
+                const size_t length = static_cast<size_t>(view["byteLength"].AsNumber());
+                if (buffer < 0 || size_t(buffer) >= doc.buffers.size() || offset + length > doc.buffers[buffer].size)
+                    return;
+                bytes.assign(doc.buffers[buffer].data + offset, doc.buffers[buffer].data + offset + length);
+            }
+            else if (!decodeDataUri(uri, bytes))
+            {
+                return;
+            }
+            embedded.push_back(std::move(bytes));
+            cached = embeddedImages.emplace(image, static_cast<int>(embedded.size()) - 1).first;
+        }
+        out.push_back({type, "*" + std::to_string(image), cached->second});
+    }
+}
+
+bool GltfLoader::Load(const std::string& path, std::vector<Mesh>& out,
+                      std::vector<std::vector<unsigned char>>& embedded)
+{
+    out.clear();
+    Document doc;
+    doc.directory = std::filesystem::path(path).parent_path();
+    doc.files.emplace_back();
+    if (!doc.files[0].Open(path)) return fail("could not open " + path);
+
+    // .glb: 12-byte header, then a JSON chunk and an optional binary chunk
+    // that backs buffer 0. Both are used where they lie in the mapping.
+    const unsigned char* data = doc.files[0].Data();
+    const size_t size = doc.files[0].Size();
+    const char* jsonText = reinterpret_cast<const char*>(data);
+    size_t jsonSize = size;
+    Buffer binary;
+    if (size >= 12 && read32(data) == GlbMagic)
+    {
+        jsonSize = 0;
+        for (size_t offset = 12; offset + 8 <= size;)
+        {
+            const size_t length = read32(data + offset);
+            const uint32_t type = read32(data + offset + 4);
+            if (offset + 8 + length > size) return fail("truncated GLB chunk in " + path);
+            if (type == GlbChunkJson && jsonSize == 0)
+            {
+                jsonText = reinterpret_cast<const char*>(data + offset + 8);
+                jsonSize = length;
+            }
+            else if (type == GlbChunkBin && !binary.data)
+            {
+                binary = {data + offset + 8, length};
+            }
+            offset += 8 + ((length + 3) & ~size_t(3));
+        }
+        if (jsonSize == 0) return fail("GLB without a JSON chunk: " + path);
+    }
+
+    std::string error;
+    if (!Json::Parse(jsonText, jsonSize, doc.json, &error)) return fail(path + ": " + error);
+    if (doc.json["asset"]["version"].AsString().compare(0, 2, "2.") != 0) return fail(path + " is not glTF 2.0");
+    for (const Json& extension : doc.json["extensionsRequired"].Elements())
+    {
+        // Quantized attributes are just normalized integer accessors here.
+        if (extension.AsString() != "KHR_mesh_quantization")
+            return fail(path + " requires " + extension.AsString());
+    }
+    if (!loadBuffers(doc, binary)) return false;
+
+    // Depth-first over the default scene; without scenes every parentless
+    // node is a root.
+    const Json& nodes = doc.json["nodes"];
+    std::vector<int> roots;
+    const Json& scene = doc.json["scenes"][doc.json["scene"].AsInt(0)];
+    if (scene.IsObject())
+    {
+        for (const Json& node : scene["nodes"].Elements()) roots.push_back(node.AsInt(-1));
+    }
+    else
+    {
+        std::vector<char> isChild(nodes.Size(), 0);
+        for (const Json& node : nodes.Elements())
+            for (const Json& child : node["children"].Elements())
+                if (child.AsInt(-1) >= 0 && size_t(child.AsInt(-1)) < nodes.Size()) isChild[child.AsInt(-1)] = 1;
+        for (size_t i = 0; i < nodes.Size(); i++)
+            if (!isChild[i]) roots.push_back(static_cast<int>(i));
+    }
+
+    std::unordered_map<int, int> embeddedImages;
+    std::vector<std::pair<int, glm::mat4>> stack;
+    for (auto root = roots.rbegin(); root != roots.rend(); ++root) stack.push_back({*root, glm::mat4(1.0f)});
+    size_t visited = 0;
+    while (!stack.empty() && visited++ <= nodes.Size()) // a node has one parent, so more visits mean a cycle
+    {
+        auto [index, parent] = stack.back();
+        stack.pop_back();
+        const Json& node = nodes[index];
+        if (!node.IsObject()) continue;
+        const glm::mat4 world = parent * localTransform(node);
+
+        for (const Json& primitive : doc.json["meshes"][node["mesh"].AsInt(-1)]["primitives"].Elements())
+        {
+            Mesh mesh;
+            if (!loadPrimitive(doc, primitive, world, mesh.data)) continue;
+            const Json& material = doc.json["materials"][primitive["material"].AsInt(-1)];
+            addTexture(doc, material["pbrMetallicRoughness"]["baseColorTexture"], "texture_diffuse", mesh.textures,
+                       embedded, embeddedImages);
+            addTexture(doc, material["normalTexture"], "texture_normal", mesh.textures, embedded, embeddedImages);
+            out.push_back(std::move(mesh));
+        }
+
+        const auto& children = node["children"].Elements();
+        for (auto child = children.rbegin(); child != children.rend(); ++child)
+            stack.push_back({child->AsInt(-1), world});
+    }
+
+    if (out.empty()) return fail(path + " has no triangle meshes");
+    return true;
+}
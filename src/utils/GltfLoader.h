@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "RenderTypes.h"
+
+// glTF 2.0 reader (.gltf with external or data: buffers, and .glb) that skips
+// Assimp. Buffers are memory mapped and every accessor is read in place,
+// whatever its stride or component type, straight into Vertex/index streams.
+// Node transforms are baked into the vertices of the meshes they instance,
+// and base color and normal textures map to texture_diffuse/texture_normal.
+class GltfLoader
+{
+public:
+    struct Texture {
+        std::string type;
+        std::string path;  // relative to the model directory, or the image name if embedded
+        int embedded = -1; // index into Load()'s `embedded`
+    };
+
+    struct Mesh {
+        MeshData data;
+        std::vector<Texture> textures;
+    };
+
+    // One mesh per triangle primitive per node instance, in scene order.
+    // Images stored in buffers or data: URIs are copied (still encoded) into
+    // `embedded`. Returns false, with the reason on stdout, for files this
+    // loader can't take (sparse or compressed accessors, no triangles).
+    static bool Load(const std::string& path, std::vector<Mesh>& out,
+                     std::vector<std::vector<unsigned char>>& embedded);
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// 64-bit FNV-1a style hash that consumes 8 bytes per step, fast enough to
+// fingerprint multi-MB asset files on every launch.
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ull)
+{
+    const uint64_t prime = 0x100000001b3ull;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = seed ^ (size * prime);
+
+    size_t words = size / 8;
+    for (size_t i = 0; i < words; i++)
+    {
+        uint64_t w;
+        std::memcpy(&w, p + i * 8, 8);
+        h = (h ^ w) * prime;
+        h ^= h >> 29;
+    }
+    for (size_t i = words * 8; i < size; i++)
+        h = (h ^ p[i]) * prime;
+
+    h ^= h >> 32;
+    return h;
+}
+
+inline uint64_t HashString(const std::string& s, uint64_t seed = 0xcbf29ce484222325ull)
+{
+    return HashBytes(s.data(), s.size(), seed);
+}
+
+inline uint64_t HashCombine(uint64_t h, uint64_t v)
+{
+    return h ^ (v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2));
+}
@@ -0,0 +1,357 @@
+#include "HotReload.h"
+#include "AssetLoader.h"
+#include "AssetPack.h"
+#include "Geometry.h"
+#include "Shader.h"
+#include "TextureCache.h"
+#include "TextureLoader.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <future>
+#include <iterator>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct TrackedShader {
+        Shader* shader;
+        std::string vertex;
+        std::string fragment;
+    };
+
+    // Reloads whose result lands on a later frame. `changed` is when the
+    // watcher saw the edit, for the turnaround in the log.
+    struct PendingShader {
+        Shader* shader;
+        std::string file;
+        Clock::time_point changed;
+    };
+
+    struct PendingTextures {
+        std::vector<unsigned int> ids;
+        std::string file;
+        Clock::time_point changed;
+    };
+
+    struct PendingGeometry {
+        std::weak_ptr<Geometry> geometry;
+        std::shared_ptr<Geometry::ImportData> data;
+        std::future<bool> imported;
+        std::string file;
+        Clock::time_point changed;
+    };
+
+    struct HotReloadData {
+        // Watcher thread. The descriptors are set up before it starts.
+        std::thread watcher;
+        int inotifyFd = -1;
+        int wakeFd[2] = {-1, -1};
+        std::unordered_map<int, std::filesystem::path> watches;
+
+        std::mutex mutex;
+        std::unordered_map<std::string, Clock::time_point> changed;
+
+        // GL thread only.
+        std::vector<TrackedShader> shaders;
+        std::vector<PendingShader> pendingShaders;
+        std::vector<PendingTextures> pendingTextures;
+        std::vector<PendingGeometry> pendingGeometry;
+        std::unordered_map<std::string, Clock::time_point> deferredGeometry;
+
+        ~HotReloadData() { HotReload::Stop(); }
+    };
+
+    HotReloadData s_Data;
+
+    std::string canonicalPath(const std::filesystem::path& path)
+    {
+        std::error_code ec;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+        return ec ? path.generic_string() : canonical.generic_string();
+    }
+
+    bool isModel(const std::filesystem::path& path)
+    {
+        std::string ext = path.extension().string();
+        return ext == ".obj" || ext == ".gltf" || ext == ".glb";
+    }
+
+    double millisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    void logReloaded(const std::string& file, const char* what, Clock::time_point changed)
+    {
+        std::cout << "HotReload:: " << std::filesystem::path(file).filename().string() << ": " << what << " in "
+                  << millisecondsSince(changed) << " ms" << std::endl;
+    }
+
+#ifdef __linux__
+    void watchTree(const std::filesystem::path& dir)
+    {
+        int wd = inotify_add_watch(s_Data.inotifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (wd < 0) return;
+        s_Data.watches[wd] = dir;
+
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+        {
+            if (entry.is_directory(ec)) watchTree(entry.path());
+        }
+    }
+
+    // Editors either rewrite a file in place (IN_CLOSE_WRITE) or write a copy
+    // and rename it over the original (IN_MOVED_TO); both count once the file
+    // is complete, never mid-write.
+    void watch()
+    {
+        alignas(inotify_event) char buffer[16 * 1024];
+        pollfd fds[2] = {{s_Data.inotifyFd, POLLIN, 0}, {s_Data.wakeFd[0], POLLIN, 0}};
+        for (;;)
+        {
+            if (poll(fds, 2, -1) < 0)
+            {
+                if (errno == EINTR) continue;
+                break;
+            }
+            if (fds[1].revents) break;
+
+            ssize_t length = read(s_Data.inotifyFd, buffer, sizeof(buffer));
+            if (length <= 0) continue;
+            Clock::time_point now = Clock::now();
+            for (char* p = buffer; p < buffer + length;)
+            {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                p += sizeof(inotify_event) + event->len;
+                if (event->mask & IN_IGNORED) s_Data.watches.erase(event->wd);
+
+                auto dir = s_Data.watches.find(event->wd);
+                if (dir == s_Data.watches.end() || event->len == 0) continue;
+                std::filesystem::path path = dir->second / event->name;
+                if (event->mask & IN_ISDIR)
+                {
+                    if (event->mask & (IN_CREATE | IN_MOVED_TO)) watchTree(path);
+                    continue;
+                }
+                if (!(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))) continue;
+
+                std::lock_guard<std::mutex> lock(s_Data.mutex);
+                s_Data.changed.emplace(path.generic_string(), now);
+            }
+        }
+    }
+#endif
+
+    void finishShaders()
+    {
+        for (const PendingShader& pending : s_Data.pendingShaders)
+        {
+            if (pending.shader->FinishReload()) logReloaded(pending.file, "program swapped", pending.changed);
+        }
+        s_Data.pendingShaders.clear();
+    }
+
+    void finishTextures()
+    {
+        auto& pending = s_Data.pendingTextures;
+        for (size_t i = 0; i < pending.size();)
+        {
+            bool done = std::none_of(pending[i].ids.begin(), pending[i].ids.end(),
+                                     [](unsigned int id) { return TextureLoader::IsPending(id); });
+            if (!done)
+            {
+                i++;
+                continue;
+            }
+            logReloaded(pending[i].file, "texture replaced", pending[i].changed);
+            pending[i] = std::move(pending.back());
+            pending.pop_back();
+        }
+    }
+
+    void finishGeometry()
+    {
+        auto& pending = s_Data.pendingGeometry;
+        for (size_t i = 0; i < pending.size();)
+        {
+            PendingGeometry& import = pending[i];
+            if (import.imported.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                i++;
+                continue;
+            }
+            std::shared_ptr<Geometry> geometry = import.geometry.lock();
+            if (import.imported.get() && geometry)
+            {
+                geometry->Replace(*import.data);
+                logReloaded(import.file, "meshes replaced", import.changed);
+            }
+            pending[i] = std::move(pending.back());
+            pending.pop_back();
+        }
+    }
+
+    void reloadShaders(const std::string& file, Clock::time_point changed)
+    {
+        for (const TrackedShader& tracked : s_Data.shaders)
+        {
+            if ((tracked.vertex == file || tracked.fragment == file) && tracked.shader->BeginReload())
+                s_Data.pendingShaders.push_back({tracked.shader, file, changed});
+        }
+    }
+
+    // False when the file has to wait: models still streaming in through the
+    // AssetLoader, or a reimport of the same file still running.
+    bool reloadGeometry(const std::string& file, Clock::time_point changed)
+    {
+        std::filesystem::path path(file);
+        std::vector<std::filesystem::path> models;
+        std::string ext = path.extension().string();
+        if (isModel(path))
+        {
+            models.push_back(path);
+        }
+        else if (ext == ".mtl" || ext == ".bin")
+        {
+            // Material libraries and glTF buffers belong to the models next to them.
+            std::error_code ec;
+            for (const auto& entry : std::filesystem::directory_iterator(path.parent_path(), ec))
+            {
+                if (isModel(entry.path())) models.push_back(entry.path());
+            }
+        }
+
+        for (const std::filesystem::path& model : models)
+        {
+            std::shared_ptr<Geometry> geometry = Geometry::Find(model.string());
+            if (!geometry) continue;
+            if (AssetLoader::PendingCount() > 0) return false;
+            for (const PendingGeometry& pending : s_Data.pendingGeometry)
+            {
+                if (pending.geometry.lock() == geometry) return false;
+            }
+
+            auto data = std::make_shared<Geometry::ImportData>();
+            std::string source = model.string();
+            bool tangentsForAll = geometry->TangentsForAll();
+            std::future<bool> imported = ThreadPool::Get().Submit(
+                [data, source, tangentsForAll]() { return Geometry::Import(source, *data, tangentsForAll); });
+            s_Data.pendingGeometry.push_back({geometry, data, std::move(imported), file, changed});
+        }
+        return true;
+    }
+}
+
+bool HotReload::Start(const std::filesystem::path& root)
+{
+#ifdef __linux__
+    if (IsRunning()) return true;
+    if (AssetPack::IsMounted())
+    {
+        std::cout << "ERROR::HOT_RELOAD:: not watching while an AssetPack is mounted" << std::endl;
+        return false;
+    }
+
+    s_Data.inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (s_Data.inotifyFd < 0 || pipe2(s_Data.wakeFd, O_CLOEXEC) != 0)
+    {
+        std::cout << "ERROR::HOT_RELOAD:: cannot set up inotify" << std::endl;
+        Stop();
+        return false;
+    }
+    watchTree(std::filesystem::path(canonicalPath(root)));
+    s_Data.watcher = std::thread(watch);
+    return true;
+#else
+    (void)root;
+    return false;
+#endif
+}
+
+void HotReload::Stop()
+{
+#ifdef __linux__
+    if (s_Data.watcher.joinable())
+    {
+        char wake = 1;
+        ssize_t written = write(s_Data.wakeFd[1], &wake, 1);
+        (void)written;
+        s_Data.watcher.join();
+    }
+    for (int* fd : {&s_Data.inotifyFd, &s_Data.wakeFd[0], &s_Data.wakeFd[1]})
+    {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+    }
+    s_Data.watches.clear();
+#endif
+}
+
+bool HotReload::IsRunning()
+{
+    return s_Data.watcher.joinable();
+}
+
+void HotReload::Update()
+{
+    // What was started last frame lands first, so a shader compiled while the
+    // previous frame rendered is swapped in before anything draws with it.
+    finishShaders();
+    finishTextures();
+    finishGeometry();
+
+    std::unordered_map<std::string, Clock::time_point> changed;
+    {
+        std::lock_guard<std::mutex> lock(s_Data.mutex);
+        changed.swap(s_Data.changed);
+    }
+
+    for (const auto& [file, time] : changed)
+    {
+        reloadShaders(file, time);
+        std::vector<unsigned int> textures = TextureCache::Reload(file);
+        if (!textures.empty()) s_Data.pendingTextures.push_back({std::move(textures), file, time});
+        s_Data.deferredGeometry.emplace(file, time);
+    }
+
+    auto& geometry = s_Data.deferredGeometry;
+    for (auto it = geometry.begin(); it != geometry.end();)
+        it = reloadGeometry(it->first, it->second) ? geometry.erase(it) : std::next(it);
+}
+
+void HotReload::Track(Shader* shader)
+{
+    s_Data.shaders.push_back({shader, canonicalPath(shader->VertexPath()), canonicalPath(shader->FragmentPath())});
+}
+
+void HotReload::Untrack(Shader* shader)
+{
+    auto& shaders = s_Data.shaders;
+    shaders.erase(std::remove_if(shaders.begin(), shaders.end(),
+                                 [shader](const TrackedShader& tracked) { return tracked.shader == shader; }),
+                  shaders.end());
+    auto& pending = s_Data.pendingShaders;
+    pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                 [shader](const PendingShader& p) { return p.shader == shader; }),
+                  pending.end());
+}
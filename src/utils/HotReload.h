@@ -0,0 +1,29 @@
+#pragma once
+
+#include <filesystem>
+
+class Shader;
+
+// Watches an asset directory with inotify and rebuilds only what a changed
+// file feeds, at the start of the next frame: the Shaders compiled from it,
+// the TextureCache textures decoded from it and the Geometry imported from it
+// (or from its .mtl/.bin). Everything keeps its GL names, so Models and
+// Materials pick the new version up without knowing. Shaders link in the
+// driver while a frame renders and swap in on the next one; one that fails to
+// compile leaves the old program running. Linux only: Start() returns false
+// elsewhere, and while an AssetPack is mounted, whose entries would shadow
+// the edited files.
+class HotReload
+{
+public:
+    static bool Start(const std::filesystem::path& root);
+    static void Stop();
+    static bool IsRunning();
+
+    // GL thread, once per frame (Renderer::BeginScene calls it).
+    static void Update();
+
+    // Every Shader registers itself, so shaders built before Start() reload too.
+    static void Track(Shader* shader);
+    static void Untrack(Shader* shader);
+};
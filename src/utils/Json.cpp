@@ -0,0 +1,302 @@
+#include "Json.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    const Json s_Null;
+    const std::string s_EmptyString;
+
+    // Deeper documents are rejected rather than risking the stack.
+    constexpr int MaxDepth = 256;
+}
+
+// Recursive descent over the whole buffer. Kept out of the header; Json only
+// grants it access to the fields.
+class JsonParser
+{
+public:
+    JsonParser(const char* text, size_t size) : p(text), begin(text), end(text + size) {}
+
+    bool Run(Json& out, std::string* error)
+    {
+        skipSpace();
+        bool ok = parseValue(out, 0);
+        skipSpace();
+        if (ok && p != end) ok = fail("trailing characters");
+        if (!ok)
+        {
+            out = Json{};
+            if (error) *error = message + " at offset " + std::to_string(failedAt - begin);
+        }
+        return ok;
+    }
+
+private:
+    const char* p;
+    const char* begin;
+    const char* end;
+    const char* failedAt = nullptr;
+    std::string message;
+
+    bool fail(const char* what)
+    {
+        if (!failedAt)
+        {
+            failedAt = p;
+            message = what;
+        }
+        return false;
+    }
+
+    void skipSpace()
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+    }
+
+    bool literal(const char* word)
+    {
+        size_t length = std::strlen(word);
+        if (size_t(end - p) < length || std::memcmp(p, word, length) != 0) return fail("invalid literal");
+        p += length;
+        return true;
+    }
+
+    bool parseValue(Json& out, int depth)
+    {
+        if (depth > MaxDepth) return fail("nesting too deep");
+        if (p >= end) return fail("unexpected end of input");
+        switch (*p)
+        {
+        case '{': return parseObject(out, depth);
+        case '[': return parseArray(out, depth);
+        case '"':
+            out.type = Json::Type::String;
+            return parseString(out.string);
+        case 't':
+            out.type = Json::Type::Bool;
+            out.boolean = true;
+            return literal("true");
+        case 'f':
+            out.type = Json::Type::Bool;
+            out.boolean = false;
+            return literal("false");
+        case 'n': return literal("null");
+        default: return parseNumber(out);
+        }
+    }
+
+    bool parseObject(Json& out, int depth)
+    {
+        out.type = Json::Type::Object;
+        p++;
+        skipSpace();
+        if (p < end && *p == '}')
+        {
+            p++;
+            return true;
+        }
+        for (;;)
+        {
+            skipSpace();
+            if (p >= end || *p != '"') return fail("expected member name");
+            out.members.emplace_back();
+            if (!parseString(out.members.back().first)) return false;
+            skipSpace();
+            if (p >= end || *p != ':') return fail("expected ':'");
+            p++;
+            skipSpace();
+            if (!parseValue(out.members.back().second, depth + 1)) return false;
+            skipSpace();
+            if (p < end && *p == ',')
+            {
+                p++;
+                continue;
+            }
+            if (p < end && *p == '}')
+            {
+                p++;
+                return true;
+            }
+            return fail("expected ',' or '}'");
+        }
+    }
+
+    bool parseArray(Json& out, int depth)
+    {
+        out.type = Json::Type::Array;
+        p++;
+        skipSpace();
+        if (p < end && *p == ']')
+        {
+            p++;
+            return true;
+        }
+        for (;;)
+        {
+            skipSpace();
+            out.elements.emplace_back();
+            if (!parseValue(out.elements.back(), depth + 1)) return false;
+            skipSpace();
+            if (p < end && *p == ',')
+            {
+                p++;
+                continue;
+            }
+            if (p < end && *p == ']')
+            {
+                p++;
+                return true;
+            }
+            return fail("expected ',' or ']'");
+        }
+    }
+
+    bool parseHex4(uint32_t& out)
+    {
+        if (end - p < 4) return fail("truncated \\u escape");
+        out = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            char c = *p++;
+            out <<= 4;
+            if (c >= '0' && c <= '9') out |= uint32_t(c - '0');
+            else if (c >= 'a' && c <= 'f') out |= uint32_t(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') out |= uint32_t(c - 'A' + 10);
+            else return fail("invalid \\u escape");
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, uint32_t c)
+    {
+        if (c < 0x80)
+        {
+            out += char(c);
+        }
+        else if (c < 0x800)
+        {
+            out += char(0xC0 | (c >> 6));
+            out += char(0x80 | (c & 0x3F));
+        }
+        else if (c < 0x10000)
+        {
+            out += char(0xE0 | (c >> 12));
+            out += char(0x80 | ((c >> 6) & 0x3F));
+            out += char(0x80 | (c & 0x3F));
+        }
+        else
+        {
+            out += char(0xF0 | (c >> 18));
+            out += char(0x80 | ((c >> 12) & 0x3F));
+            out += char(0x80 | ((c >> 6) & 0x3F));
+            out += char(0x80 | (c & 0x3F));
+        }
+    }
+
+    bool parseString(std::string& out)
+    {
+        p++; // opening quote
+        for (;;)
+        {
+            // Copy unescaped runs in one go; most glTF strings have no escapes.
+            const char* run = p;
+            while (p < end && *p != '"' && *p != '\\') p++;
+            out.append(run, p);
+            if (p >= end) return fail("unterminated string");
+            if (*p++ == '"') return true;
+
+            if (p >= end) return fail("unterminated string");
+            char c = *p++;
+            switch (c)
+            {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u':
+            {
+                uint32_t code = 0;
+                if (!parseHex4(code)) return false;
+                if (code >= 0xD800 && code < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u')
+                {
+                    p += 2;
+                    uint32_t low = 0;
+                    if (!parseHex4(low)) return false;
+                    code = (low >= 0xDC00 && low < 0xE000) ? 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00)
+                                                           : 0xFFFD;
+                }
+                appendUtf8(out, code);
+                break;
+            }
+            default: return fail("invalid escape");
+            }
+        }
+    }
+
+    bool parseNumber(Json& out)
+    {
+        const char* start = p;
+        if (p < end && *p == '-') p++;
+        while (p < end && ((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' || *p == 'E' || *p == '+' || *p == '-'))
+            p++;
+        if (p == start) return fail("unexpected character");
+
+        // strtod needs a terminator; numbers are short, so copy onto the stack.
+        char buffer[64];
+        size_t length = size_t(p - start);
+        if (length >= sizeof(buffer)) return fail("number too long");
+        std::memcpy(buffer, start, length);
+        buffer[length] = '\0';
+        char* parsedEnd = nullptr;
+        out.type = Json::Type::Number;
+        out.number = std::strtod(buffer, &parsedEnd);
+        if (parsedEnd != buffer + length)
+        {
+            p = start;
+            return fail("invalid number");
+        }
+        return true;
+    }
+};
+
+bool Json::Parse(const char* text, size_t size, Json& out, std::string* error)
+{
+    out = Json{};
+    return JsonParser(text, size).Run(out, error);
+}
+
+bool Json::Has(const char* key) const
+{
+    for (const auto& member : members)
+        if (member.first == key) return true;
+    return false;
+}
+
+const Json& Json::operator[](const char* key) const
+{
+    for (const auto& member : members)
+        if (member.first == key) return member.second;
+    return s_Null;
+}
+
+const Json& Json::operator[](size_t index) const
+{
+    return index < elements.size() ? elements[index] : s_Null;
+}
+
+size_t Json::Size() const
+{
+    return type == Type::Array ? elements.size() : type == Type::Object ? members.size() : 0;
+}
+
+const std::string& Json::AsString() const
+{
+    return type == Type::String ? string : s_EmptyString;
+}
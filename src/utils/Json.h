@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Small read-only JSON document for asset manifests (glTF). Lookups never
+// fail: a missing member or element returns a shared null value, so chains
+// like doc["materials"][i]["normalTexture"]["index"].AsInt(-1) stay short.
+class Json
+{
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    // Parses UTF-8 text. On failure `out` is null and `error` says where.
+    static bool Parse(const char* text, size_t size, Json& out, std::string* error = nullptr);
+
+    Type GetType() const { return type; }
+    bool IsNull() const { return type == Type::Null; }
+    bool IsNumber() const { return type == Type::Number; }
+    bool IsString() const { return type == Type::String; }
+    bool IsArray() const { return type == Type::Array; }
+    bool IsObject() const { return type == Type::Object; }
+
+    bool Has(const char* key) const;
+    const Json& operator[](const char* key) const;
+    const Json& operator[](size_t index) const;
+    const Json& operator[](int index) const { return index < 0 ? (*this)[elements.size()] : (*this)[size_t(index)]; }
+    // Element count of an array, member count of an object, else 0.
+    size_t Size() const;
+
+    bool AsBool(bool fallback = false) const { return type == Type::Bool ? boolean : fallback; }
+    double AsNumber(double fallback = 0.0) const { return type == Type::Number ? number : fallback; }
+    int AsInt(int fallback = 0) const { return type == Type::Number ? static_cast<int>(number) : fallback; }
+    const std::string& AsString() const;
+
+    const std::vector<Json>& Elements() const { return elements; }
+    const std::vector<std::pair<std::string, Json>>& Members() const { return members; }
+
+private:
+    friend class JsonParser;
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<Json> elements;
+    std::vector<std::pair<std::string, Json>> members; // file order
+};
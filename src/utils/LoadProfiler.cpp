@@ -0,0 +1,218 @@
+#include "LoadProfiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+    struct LoadProfilerData {
+        std::atomic<bool> enabled{true};
+        std::mutex mutex;
+        std::vector<LoadProfiler::Event> events;
+        // Small ids in order of first appearance read better in a trace than
+        // hashed std::thread::ids.
+        std::unordered_map<std::thread::id, unsigned int> threads;
+    };
+
+    LoadProfilerData s_Data;
+
+    double milliseconds(LoadProfiler::Clock::duration d)
+    {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+
+    double megabytes(size_t bytes)
+    {
+        return bytes / 1048576.0;
+    }
+
+    // "resources/objects/backpack/backpack.obj" -> "backpack/backpack.obj":
+    // enough to tell the assets apart without the shared prefix.
+    std::string shortName(const std::filesystem::path& path)
+    {
+        std::filesystem::path parent = path.parent_path().filename();
+        return parent.empty() ? path.filename().generic_string() : (parent / path.filename()).generic_string();
+    }
+
+    // Every model and skybox has a directory of its own, next to the textures
+    // it pulls in, so that is the unit the report ranks.
+    std::string assetGroup(const std::string& asset)
+    {
+        std::filesystem::path parent = std::filesystem::path(asset).parent_path();
+        return parent.empty() ? asset : parent.generic_string();
+    }
+
+    std::string escapeJson(const std::string& text)
+    {
+        std::string out;
+        out.reserve(text.size());
+        for (char c : text)
+        {
+            switch (c)
+            {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "\\u%04x", c);
+                    out += code;
+                }
+                else
+                {
+                    out += c;
+                }
+            }
+        }
+        return out;
+    }
+
+    struct Totals {
+        size_t count = 0;
+        LoadProfiler::Clock::duration time{};
+        size_t bytes = 0;
+    };
+}
+
+LoadProfiler::Scope::Scope(const char* stage, std::string asset, size_t bytes)
+    : stage(stage), asset(std::move(asset)), start(Clock::now()), bytes(bytes)
+{
+}
+
+LoadProfiler::Scope::~Scope()
+{
+    Record(stage, asset, start, Clock::now(), bytes);
+}
+
+void LoadProfiler::SetEnabled(bool enabled)
+{
+    s_Data.enabled = enabled;
+}
+
+bool LoadProfiler::IsEnabled()
+{
+    return s_Data.enabled;
+}
+
+void LoadProfiler::Record(const char* stage, const std::string& asset, Clock::time_point start, Clock::time_point end,
+                          size_t bytes)
+{
+    if (!s_Data.enabled) return;
+    std::lock_guard<std::mutex> lock(s_Data.mutex);
+    auto thread = s_Data.threads.emplace(std::this_thread::get_id(), static_cast<unsigned int>(s_Data.threads.size()));
+    s_Data.events.push_back({stage, asset, start, end, bytes, thread.first->second});
+}
+
+std::vector<LoadProfiler::Event> LoadProfiler::GetEvents()
+{
+    std::lock_guard<std::mutex> lock(s_Data.mutex);
+    return s_Data.events;
+}
+
+void LoadProfiler::Reset()
+{
+    std::lock_guard<std::mutex> lock(s_Data.mutex);
+    s_Data.events.clear();
+}
+
+void LoadProfiler::LogReport(size_t topAssets)
+{
+    std::vector<Event> events = GetEvents();
+    if (events.empty()) return;
+
+    Clock::time_point first = events.front().start, last = events.front().end;
+    std::map<std::string, Totals> stages;
+    std::unordered_map<std::string, Totals> assets;
+    std::unordered_map<std::string, std::map<std::string, Clock::duration>> assetStages;
+    for (const Event& e : events)
+    {
+        first = std::min(first, e.start);
+        last = std::max(last, e.end);
+        std::string group = assetGroup(e.asset);
+        for (Totals* t : {&stages[e.stage], &assets[group]})
+        {
+            t->count++;
+            t->time += e.end - e.start;
+            t->bytes += e.bytes;
+        }
+        assetStages[group][e.stage] += e.end - e.start;
+    }
+
+    // Time summed over threads exceeds the wall span when loaders overlap.
+    Clock::duration busy{};
+    for (const auto& [stage, t] : stages) busy += t.time;
+    std::cout << "Load profile: " << events.size() << " events, " << std::fixed << std::setprecision(1)
+              << milliseconds(last - first) << " ms wall, " << milliseconds(busy) << " ms busy" << std::endl;
+    for (const auto& [stage, t] : stages)
+    {
+        double ms = milliseconds(t.time);
+        std::cout << "  " << std::left << std::setw(18) << stage << std::right << std::setw(6) << t.count
+                  << std::setw(10) << ms << " ms" << std::setw(9) << std::setprecision(2) << megabytes(t.bytes)
+                  << " MB";
+        // Sub-0.1 ms stages are mostly clock noise; their throughput means nothing.
+        if (t.bytes > 0 && ms >= 0.1) std::cout << " " << std::setw(9) << megabytes(t.bytes) / (ms / 1000.0) << " MB/s";
+        std::cout << std::setprecision(1) << std::endl;
+    }
+
+    std::vector<std::pair<std::string, Totals>> ranked(assets.begin(), assets.end());
+    std::sort(ranked.begin(), ranked.end(),
+              [](const auto& a, const auto& b) { return a.second.time > b.second.time; });
+    if (ranked.size() > topAssets) ranked.resize(topAssets);
+
+    std::cout << "  costliest asset directories:" << std::endl;
+    for (const auto& [asset, t] : ranked)
+    {
+        std::cout << "  " << std::setw(10) << milliseconds(t.time) << " ms " << std::setw(8) << std::setprecision(2)
+                  << megabytes(t.bytes) << " MB  " << shortName(asset) << " (" << std::setprecision(1);
+        const char* separator = "";
+        for (const auto& [stage, time] : assetStages[asset])
+        {
+            std::cout << separator << stage << " " << milliseconds(time);
+            separator = ", ";
+        }
+        std::cout << ")" << std::endl;
+    }
+}
+
+bool LoadProfiler::WriteChromeTrace(const std::string& path)
+{
+    std::vector<Event> events = GetEvents();
+    std::ofstream out(path, std::ios::trunc);
+    if (!out)
+    {
+        std::cout << "ERROR::LOAD_PROFILER:: cannot write " << path << std::endl;
+        return false;
+    }
+
+    Clock::time_point origin = events.empty() ? Clock::now() : events.front().start;
+    for (const Event& e : events) origin = std::min(origin, e.start);
+
+    // Complete ("X") events in microseconds since the first one.
+    auto micros = [](Clock::duration d) { return std::chrono::duration<double, std::micro>(d).count(); };
+    out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const Event& e = events[i];
+        out << (i ? ",\n" : "\n") << "{\"name\":\"" << e.stage << " " << escapeJson(shortName(e.asset))
+            << "\",\"cat\":\"" << e.stage << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread
+            << ",\"ts\":" << micros(e.start - origin) << ",\"dur\":" << micros(e.end - e.start)
+            << ",\"args\":{\"asset\":\"" << escapeJson(e.asset) << "\",\"bytes\":" << e.bytes << "}}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+    if (!out) return false;
+
+    std::cout << "LoadProfiler:: wrote " << events.size() << " events to " << path << std::endl;
+    return true;
+}
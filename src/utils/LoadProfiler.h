@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Timeline of the work the loaders do: one event per stage of each asset
+// (parse, decode, bake, upload, compile, ...), with the thread it ran on and
+// the bytes it read or produced. Stages are leaves and never nest, so an
+// asset's cost is the sum of its events. LogReport() prints where the time
+// went per stage and per asset; WriteChromeTrace() writes the same events for
+// chrome://tracing or ui.perfetto.dev. Thread-safe; a Scope costs two clock
+// reads and a locked push_back, so stages are kept coarse.
+class LoadProfiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Event {
+        const char* stage;
+        std::string asset;
+        Clock::time_point start;
+        Clock::time_point end;
+        size_t bytes;
+        unsigned int thread;
+    };
+
+    // Times one stage from construction to destruction. `stage` must be a
+    // string literal; `asset` is the file (or directory) being loaded.
+    class Scope
+    {
+    public:
+        Scope(const char* stage, std::string asset, size_t bytes = 0);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        void AddBytes(size_t count) { bytes += count; }
+
+    private:
+        const char* stage;
+        std::string asset;
+        Clock::time_point start;
+        size_t bytes;
+    };
+
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+
+    static void Record(const char* stage, const std::string& asset, Clock::time_point start, Clock::time_point end,
+                       size_t bytes);
+    static std::vector<Event> GetEvents();
+    static void Reset();
+
+    // Totals per stage, then the `topAssets` asset directories (one per model
+    // or skybox, with its textures) that cost the most.
+    static void LogReport(size_t topAssets = 20);
+    static bool WriteChromeTrace(const std::string& path);
+};
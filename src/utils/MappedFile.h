@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. The view stays valid until Close()
+// or destruction, so callers can hand pointers into it straight to GL. Files
+// held by a mounted AssetPack are borrowed from the pack's mapping instead.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return data != nullptr; }
+    const unsigned char* Data() const { return data; }
+    size_t Size() const { return size; }
+    bool IsBorrowed() const { return borrowed; }
+
+    // Lets the OS drop the resident pages of [offset, offset + length); they
+    // are read from the file again if touched. Only whole pages inside the
+    // range go. A no-op where unsupported.
+    void Discard(size_t offset, size_t length) const;
+
+private:
+    bool mapFile(const std::string& path);
+
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    bool borrowed = false;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,43 @@
+#include "Material.h"
+#include "TextureCache.h"
+
+#include <iostream>
+
+Material::Material(const char* vsPath, const char* fsPath)
+{
+    shader = new Shader(vsPath, fsPath);
+}
+
+Material::~Material()
+{
+    // Ids that didn't come from the cache (procedural AddTexture) are ignored.
+    for (const Texture& texture : textures)
+        TextureCache::Release(texture.id);
+
+    delete shader;
+}
+
+void Material::AddTexture(std::string const& path, std::string typeName)
+{
+    unsigned int id = TextureCache::Acquire(path, TextureSettings{}, TextureLoader::PlaceholderFor(typeName));
+    if (id == 0)
+    {
+        std::cout << "Failed to manually load texture: " << path << std::endl;
+        return;
+    }
+
+    Texture texture;
+    texture.id = id;
+    texture.type = typeName;
+    texture.path = path;
+    textures.push_back(texture);
+}
+
+void Material::AddTexture(int textureId, std::string typeName)
+{
+    Texture texture;
+    texture.id = (unsigned int)textureId;
+    texture.type = typeName;
+    texture.path = "procedural_custom_" + std::to_string(textureId);
+    textures.push_back(texture);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+#include "RenderTypes.h"
+
+// A shader program plus the textures it adds on top of whatever the geometry's
+// own materials provide. Many Materials can draw the same Geometry.
+class Material
+{
+public:
+    Shader* shader;
+    std::vector<Texture> textures;
+    // Lets the Renderer drop meshlets facing away from the camera. Only for
+    // closed geometry: nothing culls back faces on the GPU.
+    bool cullBackfaces = false;
+
+    Material(const char* vsPath, const char* fsPath);
+    ~Material();
+
+    Material(const Material&) = delete;
+    Material& operator=(const Material&) = delete;
+
+    void AddTexture(std::string const &path, std::string typeName);
+    void AddTexture(int textureId, std::string typeName);
+};
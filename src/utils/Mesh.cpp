@@ -1,27 +1,185 @@
 #include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "ThreadPool.h"
 
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures)
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESH_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    VertexFormat s_DefaultFormat;
+
+    // The bitangent is rebuilt in the shader as cross(N, T) * w.
+    float handedness(const Vertex& v)
+    {
+        return glm::dot(glm::cross(v.Normal, v.Tangent), v.Bitangent) < 0.0f ? -1.0f : 1.0f;
+    }
+
+    glm::vec3 safeNormalize(const glm::vec3& v)
+    {
+        float len = glm::length(v);
+        return len > 1e-12f ? v / len : glm::vec3(0.0f);
+    }
+
+    void packVertex(const Vertex& v, const VertexFormat& format, const glm::vec3& center, float inverseScale,
+                    unsigned char* dst)
+    {
+        if (format.quantizedPositions)
+        {
+            glm::vec3 q = glm::clamp((v.Position - center) * inverseScale, -1.0f, 1.0f);
+            int16_t p[4] = {static_cast<int16_t>(std::lround(q.x * 32767.0f)),
+                            static_cast<int16_t>(std::lround(q.y * 32767.0f)),
+                            static_cast<int16_t>(std::lround(q.z * 32767.0f)), 0};
+            std::memcpy(dst, p, 8);
+            dst += 8;
+        }
+        else
+        {
+            std::memcpy(dst, &v.Position, 12);
+            dst += 12;
+        }
+
+        if (format.packedNormals)
+        {
+            uint32_t n = glm::packSnorm3x10_1x2(glm::vec4(safeNormalize(v.Normal), 0.0f));
+            std::memcpy(dst, &n, 4);
+            dst += 4;
+        }
+        else
+        {
+            std::memcpy(dst, &v.Normal, 12);
+            dst += 12;
+        }
+
+        if (format.halfTexCoords)
+        {
+            uint32_t uv = glm::packHalf2x16(v.TexCoords);
+            std::memcpy(dst, &uv, 4);
+            dst += 4;
+        }
+        else
+        {
+            std::memcpy(dst, &v.TexCoords, 8);
+            dst += 8;
+        }
+
+        if (!format.tangents) return;
+        glm::vec4 tangent(safeNormalize(v.Tangent), handedness(v));
+        if (format.packedNormals)
+        {
+            uint32_t t = glm::packSnorm3x10_1x2(tangent);
+            std::memcpy(dst, &t, 4);
+        }
+        else
+        {
+            std::memcpy(dst, &tangent, 16);
+        }
+    }
+}
+
+void Mesh::Release()
+{
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    VAO = VBO = EBO = 0;
+    gpuBytes = 0;
+}
+
+void Mesh::SetDefaultFormat(const VertexFormat& format)
+{
+    s_DefaultFormat = format;
+}
+
+VertexFormat Mesh::ChooseFormat(const Vertex* vertexData, size_t vertexCount)
+{
+    VertexFormat format = s_DefaultFormat;
+    if (format.tangents)
+    {
+        format.tangents = std::any_of(vertexData, vertexData + vertexCount, [](const Vertex& v) {
+            return v.Tangent != glm::vec3(0.0f);
+        });
+    }
+    return format;
+}
+
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures,
+           std::vector<Meshlet> meshlets, std::vector<MeshLod> lods)
+{
+    this->vertices = std::move(vertices);
+    this->indices = std::move(indices);
+    this->textures = std::move(textures);
+    this->meshlets = std::move(meshlets);
+    this->lods = std::move(lods);
+
+    setupMesh(this->vertices.data(), this->vertices.size(), this->indices.data(), this->indices.size());
+}
+
+Mesh::Mesh(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t indexCount,
+           const Meshlet* meshletData, size_t meshletCount, const MeshLod* lodData, size_t lodCount,
+           std::vector<Texture> textures)
 {
-    this->vertices = vertices;
-    this->indices = indices;
-    this->textures = textures;
+    this->textures = std::move(textures);
+    this->meshlets.assign(meshletData, meshletData + meshletCount);
+    this->lods.assign(lodData, lodData + lodCount);
 
-    setupMesh();
+    setupMesh(vertexData, vertexCount, indexData, indexCount);
 }
 
-void Mesh::Draw(Shader &shader) 
+void Mesh::Draw(Shader &shader, const std::vector<Texture>& extraTextures, const glm::mat4* model,
+                const unsigned char* visibleMeshlets, size_t lod)
 {
+    lod = std::min(lod, lods.size() - 1);
+    if (lod > 0 && visibleMeshlets && !meshlets.empty() &&
+        std::none_of(visibleMeshlets, visibleMeshlets + meshlets.size(), [](unsigned char v) { return v != 0; }))
+        return;
+
+    // Visible meshlets become index ranges; neighbours share an edge in the
+    // index buffer, so runs of them collapse into one range.
+    bool ranged = lod == 0 && visibleMeshlets && !meshlets.empty();
+    if (ranged)
+    {
+        drawCounts.clear();
+        drawOffsets.clear();
+        for (size_t i = 0; i < meshlets.size(); i++)
+        {
+            if (!visibleMeshlets[i]) continue;
+            if (i > 0 && visibleMeshlets[i - 1] && !drawCounts.empty())
+            {
+                drawCounts.back() += static_cast<GLsizei>(meshlets[i].indexCount);
+                continue;
+            }
+            drawCounts.push_back(static_cast<GLsizei>(meshlets[i].indexCount));
+            drawOffsets.push_back(reinterpret_cast<const void*>(size_t(meshlets[i].indexOffset) * indexSize));
+        }
+        if (drawCounts.empty()) return;
+    }
+
+    if (format.quantizedPositions && model)
+        shader.setMat4("model", *model * positionTransform);
+
     unsigned int diffuseNr  = 1;
     unsigned int specularNr = 1;
     unsigned int normalNr   = 1;
     unsigned int heightNr   = 1;
 
-    for(unsigned int i = 0; i < textures.size(); i++)
+    const size_t textureCount = textures.size() + extraTextures.size();
+    for(unsigned int i = 0; i < textureCount; i++)
     {
+        const Texture& texture = i < textures.size() ? textures[i] : extraTextures[i - textures.size()];
         glActiveTexture(GL_TEXTURE0 + i);
         
         std::string number;
-        std::string name = textures[i].type;
+        std::string name = texture.type;
         
         if(name == "texture_diffuse")
             number = std::to_string(diffuseNr++);
@@ -34,44 +192,195 @@ void Mesh::Draw(Shader &shader)
 
         // 保持原始的材质 Uniform 命名
         shader.setInt(("material." + name + number).c_str(), i);
-        glBindTexture(GL_TEXTURE_2D, textures[i].id);
+        glBindTexture(GL_TEXTURE_2D, texture.id);
     }
     
     glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
+    if (ranged && drawCounts.size() == 1)
+        glDrawElements(GL_TRIANGLES, drawCounts[0], indexType, drawOffsets[0]);
+    else if (ranged)
+        glMultiDrawElements(GL_TRIANGLES, drawCounts.data(), indexType, drawOffsets.data(),
+                            static_cast<GLsizei>(drawCounts.size()));
+    else
+        glDrawElements(GL_TRIANGLES, lods[lod].indexCount, indexType,
+                       reinterpret_cast<const void*>(size_t(lods[lod].indexOffset) * indexSize));
     glBindVertexArray(0);
 
+    if (format.quantizedPositions && model)
+        shader.setMat4("model", *model);
+
     glActiveTexture(GL_TEXTURE0);
 }
 
-void Mesh::setupMesh()
+size_t Mesh::SelectLod(float maxError) const
+{
+    size_t lod = 0;
+    while (lod + 1 < lods.size() && lods[lod + 1].error <= maxError) lod++;
+    return lod;
+}
+
+void Mesh::CullMeshlets(const MeshletCullParams& params, size_t begin, size_t end, unsigned char* visible) const
+{
+    end = std::min(end, meshlets.size());
+    const glm::vec3& eye = params.cameraPosition;
+    for (size_t block = begin; block < end; block += 4)
+    {
+        const float* b = cullBounds.data() + block * 8;
+        const size_t lanes = std::min<size_t>(4, end - block);
+#if MESH_USE_SSE
+        __m128 cx = _mm_loadu_ps(b), cy = _mm_loadu_ps(b + 4), cz = _mm_loadu_ps(b + 8);
+        __m128 r = _mm_loadu_ps(b + 12);
+        __m128 negR = _mm_sub_ps(_mm_setzero_ps(), r);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const glm::vec4& p : params.planes)
+        {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(p.x)), _mm_mul_ps(cy, _mm_set1_ps(p.y))),
+                                  _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(p.z)), _mm_set1_ps(p.w)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negR));
+        }
+        if (params.backfaces)
+        {
+            __m128 vx = _mm_sub_ps(cx, _mm_set1_ps(eye.x));
+            __m128 vy = _mm_sub_ps(cy, _mm_set1_ps(eye.y));
+            __m128 vz = _mm_sub_ps(cz, _mm_set1_ps(eye.z));
+            __m128 len = _mm_sqrt_ps(
+                _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)));
+            __m128 facing = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, _mm_loadu_ps(b + 16)),
+                                                  _mm_mul_ps(vy, _mm_loadu_ps(b + 20))),
+                                       _mm_mul_ps(vz, _mm_loadu_ps(b + 24)));
+            __m128 limit = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(b + 28), len), r);
+            inside = _mm_andnot_ps(_mm_cmpge_ps(facing, limit), inside);
+        }
+        int mask = _mm_movemask_ps(inside);
+        for (size_t i = 0; i < lanes; i++)
+            visible[block + i] = static_cast<unsigned char>((mask >> i) & 1);
+#else
+        for (size_t i = 0; i < lanes; i++)
+        {
+            glm::vec3 c(b[i], b[4 + i], b[8 + i]);
+            float r = b[12 + i];
+            bool inside = true;
+            for (const glm::vec4& p : params.planes)
+                inside = inside && glm::dot(glm::vec3(p), c) + p.w >= -r;
+            if (inside && params.backfaces)
+            {
+                glm::vec3 v = c - eye;
+                glm::vec3 axis(b[16 + i], b[20 + i], b[24 + i]);
+                inside = glm::dot(v, axis) < b[28 + i] * glm::length(v) + r;
+            }
+            visible[block + i] = inside ? 1 : 0;
+        }
+#endif
+    }
+}
+
+void Mesh::setupMesh(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t count)
 {
+    if (lods.empty())
+        lods.push_back({0, static_cast<uint32_t>(count), 0.0f});
+    indexCount = lods[0].indexCount;
+    format = ChooseFormat(vertexData, vertexCount);
+
+    if (meshlets.empty())
+        meshlets = MeshOptimizer::SplitMeshlets(vertexData, vertexCount, indexData, indexCount);
+    cullBounds.assign(((meshlets.size() + 3) / 4) * 32, 0.0f);
+    for (size_t i = 0; i < meshlets.size(); i++)
+    {
+        const Meshlet& m = meshlets[i];
+        float* b = cullBounds.data() + (i / 4) * 32 + (i % 4);
+        const float values[8] = {m.center.x,   m.center.y,   m.center.z,   m.radius,
+                                 m.coneAxis.x, m.coneAxis.y, m.coneAxis.z, m.coneCutoff};
+        for (int k = 0; k < 8; k++) b[k * 4] = values[k];
+    }
+    positionTransform = glm::mat4(1.0f);
+
+    glm::vec3 lo(0.0f), hi(0.0f);
+    if (vertexCount > 0)
+    {
+        lo = hi = vertexData[0].Position;
+        for (size_t i = 1; i < vertexCount; i++)
+        {
+            lo = glm::min(lo, vertexData[i].Position);
+            hi = glm::max(hi, vertexData[i].Position);
+        }
+    }
+    boundsCenter = (lo + hi) * 0.5f;
+    boundsRadius = glm::length(hi - lo) * 0.5f;
+
+    // Quantized positions use one uniform scale around the bounds centre, so
+    // normals transform the same way they did before.
+    glm::vec3 center(0.0f);
+    float inverseScale = 1.0f;
+    if (format.quantizedPositions && vertexCount > 0)
+    {
+        center = boundsCenter;
+        float extent = std::max({hi.x - lo.x, hi.y - lo.y, hi.z - lo.z}) * 0.5f;
+        if (extent > 0.0f) inverseScale = 1.0f / extent;
+        positionTransform = glm::scale(glm::translate(glm::mat4(1.0f), center), glm::vec3(1.0f / inverseScale));
+    }
+
+    const unsigned int stride = format.Stride();
+    std::vector<unsigned char> packed(vertexCount * stride);
+    ThreadPool::Get().ParallelFor(vertexCount, 16384, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            packVertex(vertexData[i], format, center, inverseScale, packed.data() + i * stride);
+    });
+
+    // Meshes that fit get 16-bit indices.
+    indexType = vertexCount <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    std::vector<uint16_t> shortIndices;
+    const void* indexBytes = indexData;
+    indexSize = sizeof(unsigned int);
+    if (indexType == GL_UNSIGNED_SHORT)
+    {
+        shortIndices.assign(indexData, indexData + count);
+        indexBytes = shortIndices.data();
+        indexSize = sizeof(uint16_t);
+    }
+    gpuBytes = packed.size() + count * indexSize;
+
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
 
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);  
+    glBufferData(GL_ARRAY_BUFFER, packed.size(), packed.data(), GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * indexSize, indexBytes, GL_STATIC_DRAW);
 
+    size_t offset = 0;
     // Position
-    glEnableVertexAttribArray(0);	
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    if (format.quantizedPositions)
+        glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, stride, (void*)offset);
+    else
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+    offset += format.quantizedPositions ? 8 : 12;
     // Normal
-    glEnableVertexAttribArray(1);	
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+    glEnableVertexAttribArray(1);
+    if (format.packedNormals)
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offset);
+    else
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+    offset += format.packedNormals ? 4 : 12;
     // TexCoords
-    glEnableVertexAttribArray(2);	
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
-    // Tangent
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
-    // Bitangent
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
+    glEnableVertexAttribArray(2);
+    if (format.halfTexCoords)
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offset);
+    else
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+    offset += format.halfTexCoords ? 4 : 8;
+    // Tangent + handedness
+    if (format.tangents)
+    {
+        glEnableVertexAttribArray(3);
+        if (format.packedNormals)
+            glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offset);
+        else
+            glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+    }
 
     glBindVertexArray(0);
-}
\ No newline at end of file
+}
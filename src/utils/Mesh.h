@@ -9,20 +9,76 @@
 #include "Shader.h"
 #include "RenderTypes.h"
 
+// Object-space view data for Mesh::CullMeshlets; planes face inwards and are
+// normalized so a sphere radius can be compared against them directly.
+struct MeshletCullParams {
+    glm::vec4 planes[6];
+    glm::vec3 cameraPosition;
+    bool backfaces = false;
+};
+
 class Mesh {
 public:
     std::vector<Vertex>       vertices;
     std::vector<unsigned int> indices;
     std::vector<Texture>      textures;
     unsigned int VAO;
+    unsigned int indexCount;
+    GLenum indexType;
+    VertexFormat format;
+    // Maps the stored (possibly quantized) positions back to mesh space.
+    glm::mat4 positionTransform;
+    std::vector<Meshlet> meshlets;
+    // Level 0 first; `indexCount` is level 0's count.
+    std::vector<MeshLod> lods;
+    // Bounding sphere of the vertices, mesh space.
+    glm::vec3 boundsCenter;
+    float boundsRadius;
+
+    // Without `meshlets` the index buffer is cut into meshlets as it stands;
+    // without `lods` all of it is level 0.
+    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures,
+         std::vector<Meshlet> meshlets = {}, std::vector<MeshLod> lods = {});
+    // Uploads straight from caller-owned memory (e.g. a mapped mesh cache entry)
+    // without keeping a CPU copy of the streams.
+    Mesh(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t indexCount,
+         const Meshlet* meshletData, size_t meshletCount, const MeshLod* lodData, size_t lodCount,
+         std::vector<Texture> textures);
 
-    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures);
+    // Format new meshes start from; each mesh then drops what it can't use.
+    static void SetDefaultFormat(const VertexFormat& format);
+    static VertexFormat ChooseFormat(const Vertex* vertexData, size_t vertexCount);
 
     // 渲染网格
-    void Draw(Shader &shader);
+    // `model` is needed for quantized positions, whose dequantization is folded
+    // into the model matrix.
+    // With `visibleMeshlets` (one byte per meshlet) only the visible index
+    // ranges are drawn, adjacent ones merged into one glMultiDrawElements.
+    // Coarser levels than 0 are drawn whole, unless no meshlet is visible.
+    void Draw(Shader &shader, const std::vector<Texture>& extraTextures = {}, const glm::mat4* model = nullptr,
+              const unsigned char* visibleMeshlets = nullptr, size_t lod = 0);
+
+    // Coarsest level whose error is within `maxError` mesh units.
+    size_t SelectLod(float maxError) const;
+
+    // Writes 1 (visible) or 0 to visible[i] for meshlets [begin, end). Thread
+    // safe; `begin` must be a multiple of 4.
+    void CullMeshlets(const MeshletCullParams& params, size_t begin, size_t end, unsigned char* visible) const;
+
+    size_t GpuBytes() const { return gpuBytes; }
+    // Deletes the GL buffers. Meshes are copied around by value, so this is
+    // explicit; only for owners that drop meshes while the context lives on.
+    void Release();
 
 private:
     unsigned int VBO, EBO;
-    void setupMesh();
+    size_t gpuBytes = 0;
+    // Meshlet bounds in blocks of four (cx, cy, cz, radius, ax, ay, az, cutoff),
+    // zero padded; lanes past the last meshlet are never written out.
+    std::vector<float> cullBounds;
+    std::vector<GLsizei> drawCounts;
+    std::vector<const void*> drawOffsets;
+    size_t indexSize = sizeof(unsigned int);
+    void setupMesh(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t count);
 };
 #endif
\ No newline at end of file
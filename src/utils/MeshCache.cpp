@@ -0,0 +1,317 @@
+#include "MeshCache.h"
+#include "Mesh.h"
+#include "AssetPack.h"
+#include "Hash.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+
+namespace
+{
+    const char kMagic[8] = {'R', 'T', 'R', 'M', 'E', 'S', 'H', '\0'};
+    const uint64_t kAlignment = 16;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t importFlags;
+        uint32_t vertexStride;
+        uint32_t meshCount;
+        uint64_t sourceSize;
+        int64_t sourceMtime;
+        uint64_t contentHash;
+        uint64_t meshTableOffset;
+        uint64_t textureTableOffset;
+        uint64_t stringsOffset;
+        uint64_t stringsSize;
+    };
+
+    struct MeshRecord {
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+        uint64_t meshletOffset;
+        uint64_t lodOffset;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t meshletCount;
+        uint32_t lodCount;
+        uint32_t firstTexture;
+        uint32_t textureCount;
+    };
+
+    struct TextureRecord {
+        uint32_t typeOffset;
+        uint32_t typeLength;
+        uint32_t pathOffset;
+        uint32_t pathLength;
+    };
+
+    struct SourceInfo {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+    };
+
+    std::filesystem::path s_Directory = std::filesystem::temp_directory_path() / "rtr-opengl" / "mesh-cache";
+
+    bool statSource(const std::string& path, SourceInfo& info)
+    {
+        unsigned long long packedSize;
+        long long packedMtime;
+        if (AssetPack::Stat(path, packedSize, packedMtime))
+        {
+            info.size = packedSize;
+            info.mtime = packedMtime;
+            return true;
+        }
+
+        std::error_code ec;
+        auto size = std::filesystem::file_size(path, ec);
+        if (ec) return false;
+        auto mtime = std::filesystem::last_write_time(path, ec);
+        if (ec) return false;
+        info.size = static_cast<uint64_t>(size);
+        info.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+        return true;
+    }
+
+    bool hashSource(const std::string& path, uint64_t& hash)
+    {
+        MappedFile source;
+        if (!source.Open(path)) return false;
+        hash = HashBytes(source.Data(), source.Size());
+        return true;
+    }
+
+    uint64_t alignUp(uint64_t v)
+    {
+        return (v + kAlignment - 1) & ~(kAlignment - 1);
+    }
+
+    bool inBounds(uint64_t offset, uint64_t bytes, size_t fileSize)
+    {
+        return offset <= fileSize && bytes <= fileSize - offset;
+    }
+}
+
+void MeshCache::SetDirectory(const std::filesystem::path& dir)
+{
+    s_Directory = dir;
+}
+
+const std::filesystem::path& MeshCache::GetDirectory()
+{
+    return s_Directory;
+}
+
+std::filesystem::path MeshCache::entryPath(const std::string& sourcePath, unsigned int importFlags)
+{
+    std::error_code ec;
+    std::string key = std::filesystem::weakly_canonical(sourcePath, ec).string();
+    if (ec) key = sourcePath;
+
+    uint64_t h = HashCombine(HashString(key), importFlags);
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.mesh", static_cast<unsigned long long>(h));
+    return s_Directory / name;
+}
+
+bool MeshCache::Load(const std::string& sourcePath, unsigned int importFlags, CachedModel& out)
+{
+    SourceInfo info;
+    if (!statSource(sourcePath, info)) return false;
+
+    auto file = std::make_shared<MappedFile>();
+    if (!file->Open(entryPath(sourcePath, importFlags).string())) return false;
+
+    const unsigned char* base = file->Data();
+    size_t size = file->Size();
+    if (size < sizeof(FileHeader)) return false;
+
+    FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != Version ||
+        header.importFlags != importFlags || header.vertexStride != sizeof(Vertex) ||
+        header.sourceSize != info.size || header.sourceMtime != info.mtime)
+        return false;
+
+    uint64_t contentHash;
+    if (!hashSource(sourcePath, contentHash) || contentHash != header.contentHash) return false;
+
+    if (!inBounds(header.meshTableOffset, uint64_t(header.meshCount) * sizeof(MeshRecord), size) ||
+        !inBounds(header.stringsOffset, header.stringsSize, size))
+        return false;
+
+    const MeshRecord* records = reinterpret_cast<const MeshRecord*>(base + header.meshTableOffset);
+    const char* strings = reinterpret_cast<const char*>(base + header.stringsOffset);
+
+    CachedModel model;
+    model.meshes.reserve(header.meshCount);
+    for (uint32_t i = 0; i < header.meshCount; i++)
+    {
+        const MeshRecord& r = records[i];
+        if (!inBounds(r.vertexOffset, uint64_t(r.vertexCount) * sizeof(Vertex), size) ||
+            !inBounds(r.indexOffset, uint64_t(r.indexCount) * sizeof(unsigned int), size) ||
+            !inBounds(r.meshletOffset, uint64_t(r.meshletCount) * sizeof(Meshlet), size) ||
+            !inBounds(r.lodOffset, uint64_t(r.lodCount) * sizeof(MeshLod), size) ||
+            !inBounds(header.textureTableOffset + uint64_t(r.firstTexture) * sizeof(TextureRecord),
+                      uint64_t(r.textureCount) * sizeof(TextureRecord), size))
+            return false;
+
+        CachedMesh mesh;
+        mesh.vertices = reinterpret_cast<const Vertex*>(base + r.vertexOffset);
+        mesh.vertexCount = r.vertexCount;
+        mesh.indices = reinterpret_cast<const unsigned int*>(base + r.indexOffset);
+        mesh.indexCount = r.indexCount;
+        mesh.meshlets = reinterpret_cast<const Meshlet*>(base + r.meshletOffset);
+        mesh.meshletCount = r.meshletCount;
+        mesh.lods = reinterpret_cast<const MeshLod*>(base + r.lodOffset);
+        mesh.lodCount = r.lodCount;
+
+        const TextureRecord* textures = reinterpret_cast<const TextureRecord*>(
+            base + header.textureTableOffset + uint64_t(r.firstTexture) * sizeof(TextureRecord));
+        for (uint32_t t = 0; t < r.textureCount; t++)
+        {
+            const TextureRecord& tr = textures[t];
+            if (uint64_t(tr.typeOffset) + tr.typeLength > header.stringsSize ||
+                uint64_t(tr.pathOffset) + tr.pathLength > header.stringsSize)
+                return false;
+            mesh.textures.push_back({std::string(strings + tr.typeOffset, tr.typeLength),
+                                     std::string(strings + tr.pathOffset, tr.pathLength)});
+        }
+        model.meshes.push_back(std::move(mesh));
+    }
+
+    model.file = std::move(file);
+    out = std::move(model);
+    return true;
+}
+
+bool MeshCache::Store(const std::string& sourcePath, unsigned int importFlags, const std::vector<Mesh>& meshes)
+{
+    std::vector<CachedMesh> views;
+    views.reserve(meshes.size());
+    for (const Mesh& mesh : meshes)
+    {
+        CachedMesh view = {mesh.vertices.data(), static_cast<uint32_t>(mesh.vertices.size()),
+                           mesh.indices.data(), static_cast<uint32_t>(mesh.indices.size()),
+                           mesh.meshlets.data(), static_cast<uint32_t>(mesh.meshlets.size()),
+                           mesh.lods.data(), static_cast<uint32_t>(mesh.lods.size()), {}};
+        for (const Texture& tex : mesh.textures) view.textures.push_back({tex.type, tex.path});
+        views.push_back(std::move(view));
+    }
+    return Store(sourcePath, importFlags, views);
+}
+
+bool MeshCache::Store(const std::string& sourcePath, unsigned int importFlags, const std::vector<CachedMesh>& meshes)
+{
+    SourceInfo info;
+    FileHeader header = {};
+    if (!statSource(sourcePath, info) || !hashSource(sourcePath, header.contentHash)) return false;
+
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = Version;
+    header.importFlags = importFlags;
+    header.vertexStride = sizeof(Vertex);
+    header.meshCount = static_cast<uint32_t>(meshes.size());
+    header.sourceSize = info.size;
+    header.sourceMtime = info.mtime;
+
+    std::vector<MeshRecord> records(meshes.size());
+    std::vector<TextureRecord> textures;
+    std::string strings;
+
+    uint64_t cursor = alignUp(sizeof(FileHeader));
+    header.meshTableOffset = cursor;
+    cursor = alignUp(cursor + records.size() * sizeof(MeshRecord));
+
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        const CachedMesh& mesh = meshes[i];
+        MeshRecord& r = records[i];
+        r.vertexCount = mesh.vertexCount;
+        r.indexCount = mesh.indexCount;
+        r.vertexOffset = cursor;
+        cursor = alignUp(cursor + mesh.vertexCount * sizeof(Vertex));
+        r.indexOffset = cursor;
+        cursor = alignUp(cursor + mesh.indexCount * sizeof(unsigned int));
+        r.meshletCount = mesh.meshletCount;
+        r.meshletOffset = cursor;
+        cursor = alignUp(cursor + mesh.meshletCount * sizeof(Meshlet));
+        r.lodCount = mesh.lodCount;
+        r.lodOffset = cursor;
+        cursor = alignUp(cursor + mesh.lodCount * sizeof(MeshLod));
+
+        r.firstTexture = static_cast<uint32_t>(textures.size());
+        r.textureCount = static_cast<uint32_t>(mesh.textures.size());
+        for (const TextureBinding& tex : mesh.textures)
+        {
+            TextureRecord tr;
+            tr.typeOffset = static_cast<uint32_t>(strings.size());
+            tr.typeLength = static_cast<uint32_t>(tex.type.size());
+            strings += tex.type;
+            tr.pathOffset = static_cast<uint32_t>(strings.size());
+            tr.pathLength = static_cast<uint32_t>(tex.path.size());
+            strings += tex.path;
+            textures.push_back(tr);
+        }
+    }
+
+    header.textureTableOffset = cursor;
+    cursor = alignUp(cursor + textures.size() * sizeof(TextureRecord));
+    header.stringsOffset = cursor;
+    header.stringsSize = strings.size();
+
+    std::error_code ec;
+    std::filesystem::create_directories(s_Directory, ec);
+
+    // Write next to the final location and rename, so a crash mid-write never
+    // leaves a truncated entry that passes the header checks.
+    std::filesystem::path target = entryPath(sourcePath, importFlags);
+    std::filesystem::path temp = target;
+    temp += ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            std::cout << "ERROR::MESH_CACHE:: cannot write " << temp.string() << std::endl;
+            return false;
+        }
+
+        auto pad = [&out]() {
+            static const char zeros[kAlignment] = {};
+            uint64_t pos = static_cast<uint64_t>(out.tellp());
+            out.write(zeros, static_cast<std::streamsize>(alignUp(pos) - pos));
+        };
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        pad();
+        out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(MeshRecord));
+        pad();
+        for (const CachedMesh& mesh : meshes)
+        {
+            out.write(reinterpret_cast<const char*>(mesh.vertices), mesh.vertexCount * sizeof(Vertex));
+            pad();
+            out.write(reinterpret_cast<const char*>(mesh.indices), mesh.indexCount * sizeof(unsigned int));
+            pad();
+            out.write(reinterpret_cast<const char*>(mesh.meshlets), mesh.meshletCount * sizeof(Meshlet));
+            pad();
+            out.write(reinterpret_cast<const char*>(mesh.lods), mesh.lodCount * sizeof(MeshLod));
+            pad();
+        }
+        out.write(reinterpret_cast<const char*>(textures.data()), textures.size() * sizeof(TextureRecord));
+        pad();
+        out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+        if (!out) return false;
+    }
+
+    std::filesystem::rename(temp, target, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
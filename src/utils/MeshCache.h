@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "RenderTypes.h"
+
+class Mesh;
+
+// On-disk cache of processed mesh streams. Entries are keyed by the source path
+// and validated against its mtime, size, content hash and the Assimp import
+// flags, so a stale entry is never served. Hits are memory-mapped and the
+// vertex/index pointers reference the mapping directly.
+class MeshCache
+{
+public:
+    static constexpr uint32_t Version = 7;
+
+    struct TextureBinding {
+        std::string type;
+        std::string path;
+    };
+
+    struct CachedMesh {
+        const Vertex* vertices;
+        uint32_t vertexCount;
+        const unsigned int* indices;
+        uint32_t indexCount;
+        const Meshlet* meshlets;
+        uint32_t meshletCount;
+        const MeshLod* lods;
+        uint32_t lodCount;
+        std::vector<TextureBinding> textures;
+    };
+
+    struct CachedModel {
+        std::shared_ptr<MappedFile> file;
+        std::vector<CachedMesh> meshes;
+    };
+
+    static void SetDirectory(const std::filesystem::path& dir);
+    static const std::filesystem::path& GetDirectory();
+
+    static bool Load(const std::string& sourcePath, unsigned int importFlags, CachedModel& out);
+    static bool Store(const std::string& sourcePath, unsigned int importFlags, const std::vector<Mesh>& meshes);
+    // Same, from streams that need not live in a Mesh (the asset packer has no GL context).
+    static bool Store(const std::string& sourcePath, unsigned int importFlags, const std::vector<CachedMesh>& meshes);
+
+private:
+    static std::filesystem::path entryPath(const std::string& sourcePath, unsigned int importFlags);
+};
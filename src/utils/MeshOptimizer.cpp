@@ -0,0 +1,864 @@
+#include "MeshOptimizer.h"
+#include "Hash.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    const size_t kVertexWords = sizeof(Vertex) / 4;
+    // Largest floats that still convert to int32_t; 2^31 - 1 has no float.
+    const float kMinCell = -2147483648.0f;
+    const float kMaxCell = 2147483520.0f;
+
+    struct WeldKey {
+        uint32_t words[kVertexWords];
+    };
+
+    bool isIntegerWord(size_t word)
+    {
+        size_t offset = word * 4;
+        return offset >= offsetof(Vertex, m_BoneIDs) && offset < offsetof(Vertex, m_BoneIDs) + sizeof(int) * 4;
+    }
+
+    WeldKey quantize(const Vertex& vertex, float inverseEpsilon)
+    {
+        WeldKey key;
+        std::memcpy(key.words, &vertex, sizeof(Vertex));
+        for (size_t i = 0; i < kVertexWords; i++)
+        {
+            if (isIntegerWord(i)) continue;
+
+            float value;
+            std::memcpy(&value, &key.words[i], 4);
+            if (inverseEpsilon > 0.0f)
+            {
+                // Clamped first: the cast is undefined out of range, and for
+                // NaN, which lands on kMinCell.
+                float scaled = std::floor(value * inverseEpsilon + 0.5f);
+                scaled = scaled >= kMinCell ? std::min(scaled, kMaxCell) : kMinCell;
+                int32_t cell = static_cast<int32_t>(scaled);
+                std::memcpy(&key.words[i], &cell, 4);
+            }
+            else if (value == 0.0f)
+            {
+                key.words[i] = 0; // -0 and +0 weld together
+            }
+        }
+        return key;
+    }
+
+    size_t tableSize(size_t count)
+    {
+        size_t size = 16;
+        while (size < count * 2) size <<= 1;
+        return size;
+    }
+}
+
+static_assert(sizeof(Vertex) % 4 == 0, "Vertex is welded as 32-bit words");
+
+MeshOptimizer::WeldStats MeshOptimizer::Weld(MeshData& mesh, float epsilon)
+{
+    WeldStats stats;
+    const size_t count = mesh.vertices.size();
+    stats.triangles = mesh.indices.size() / 3;
+    stats.verticesBefore = count;
+    stats.acmrBefore = ComputeACMR(mesh.indices.data(), mesh.indices.size(), count);
+    if (count == 0) return stats;
+
+    // Keys and hashes are independent per vertex; only the table insert is serial.
+    const float inverseEpsilon = epsilon > 0.0f ? 1.0f / epsilon : 0.0f;
+    std::vector<WeldKey> keys(count);
+    std::vector<uint64_t> hashes(count);
+    ThreadPool::Get().ParallelFor(count, 16384, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            keys[i] = quantize(mesh.vertices[i], inverseEpsilon);
+            hashes[i] = HashBytes(keys[i].words, sizeof(WeldKey));
+        }
+    });
+
+    // Open addressing; slots hold the index of the first vertex with that key.
+    const size_t size = tableSize(count);
+    const uint32_t empty = UINT32_MAX;
+    std::vector<uint32_t> table(size, empty);
+    std::vector<uint32_t> remap(count);
+    std::vector<Vertex> welded;
+    welded.reserve(count);
+    std::vector<uint32_t> firstOf; // welded index -> source vertex
+    firstOf.reserve(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t slot = hashes[i] & (size - 1);
+        for (;;)
+        {
+            uint32_t candidate = table[slot];
+            if (candidate == empty)
+            {
+                table[slot] = static_cast<uint32_t>(welded.size());
+                remap[i] = static_cast<uint32_t>(welded.size());
+                firstOf.push_back(static_cast<uint32_t>(i));
+                welded.push_back(mesh.vertices[i]);
+                break;
+            }
+            uint32_t source = firstOf[candidate];
+            if (hashes[source] == hashes[i] && std::memcmp(&keys[source], &keys[i], sizeof(WeldKey)) == 0)
+            {
+                remap[i] = candidate;
+                break;
+            }
+            slot = (slot + 1) & (size - 1);
+        }
+    }
+
+    for (unsigned int& index : mesh.indices)
+        index = remap[index];
+    mesh.vertices = std::move(welded);
+
+    stats.verticesAfter = mesh.vertices.size();
+    stats.acmrAfter = ComputeACMR(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+    return stats;
+}
+
+namespace
+{
+    // Cluster c spans triangles [splits[c], splits[c + 1]). Returns the cluster
+    // order for overdraw: by how far the cluster sits out along its own
+    // area-weighted normal from the mesh centroid, outermost first.
+    std::vector<size_t> sortClusters(const std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices,
+                                     const std::vector<size_t>& splits)
+    {
+        glm::vec3 meshCenter(0.0f);
+        for (const Vertex& v : vertices) meshCenter += v.Position;
+        meshCenter /= static_cast<float>(vertices.size());
+
+        std::vector<float> keys(splits.size() - 1);
+        ThreadPool::Get().ParallelFor(keys.size(), 256, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; c++)
+            {
+                glm::vec3 center(0.0f), normal(0.0f);
+                float area = 0.0f;
+                for (size_t t = splits[c]; t < splits[c + 1]; t++)
+                {
+                    const glm::vec3& a = vertices[indices[t * 3 + 0]].Position;
+                    const glm::vec3& b = vertices[indices[t * 3 + 1]].Position;
+                    const glm::vec3& d = vertices[indices[t * 3 + 2]].Position;
+                    glm::vec3 n = glm::cross(b - a, d - a);
+                    float w = glm::length(n);
+                    center += (a + b + d) * (w / 3.0f);
+                    normal += n;
+                    area += w;
+                }
+                float len = glm::length(normal);
+                keys[c] = area > 0.0f && len > 0.0f ? glm::dot(center / area - meshCenter, normal / len) : 0.0f;
+            }
+        });
+
+        std::vector<size_t> order(keys.size());
+        for (size_t c = 0; c < order.size(); c++) order[c] = c;
+        std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] > keys[b]; });
+        return order;
+    }
+
+    // Unused triangles BuildMeshlets considers when a meshlet has to jump.
+    const size_t kSeedWindow = 16;
+    const uint32_t kNormalBuckets = 4;
+    // How much a differently facing triangle counts as farther away.
+    const float kConeWeight = 4.0f;
+
+    // Coarse direction class: octahedral mapping of the normal on a
+    // kNormalBuckets x kNormalBuckets grid.
+    uint32_t normalBucket(const glm::vec3& n)
+    {
+        float sum = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+        if (sum == 0.0f) return 0;
+        glm::vec2 p = glm::vec2(n.x, n.y) / sum;
+        if (n.z < 0.0f)
+        {
+            glm::vec2 sign(p.x >= 0.0f ? 1.0f : -1.0f, p.y >= 0.0f ? 1.0f : -1.0f);
+            p = (1.0f - glm::abs(glm::vec2(p.y, p.x))) * sign;
+        }
+        glm::uvec2 cell = glm::min(glm::uvec2((p * 0.5f + 0.5f) * float(kNormalBuckets)),
+                                   glm::uvec2(kNormalBuckets - 1));
+        return cell.y * kNormalBuckets + cell.x;
+    }
+
+    // Spreads the low 10 bits of v out to every third bit.
+    uint32_t spreadBits(uint32_t v)
+    {
+        v &= 0x3ff;
+        v = (v | (v << 16)) & 0x030000ff;
+        v = (v | (v << 8)) & 0x0300f00f;
+        v = (v | (v << 4)) & 0x030c30c3;
+        v = (v | (v << 2)) & 0x09249249;
+        return v;
+    }
+
+    void computeMeshletBounds(const Vertex* vertices, const unsigned int* indices, std::vector<Meshlet>& meshlets)
+    {
+        ThreadPool::Get().ParallelFor(meshlets.size(), 64, [&](size_t begin, size_t end) {
+            for (size_t m = begin; m < end; m++)
+            {
+                Meshlet& meshlet = meshlets[m];
+                const unsigned int* tri = indices + meshlet.indexOffset;
+
+                glm::vec3 lo(std::numeric_limits<float>::max()), hi(-std::numeric_limits<float>::max());
+                glm::vec3 normalSum(0.0f);
+                for (uint32_t i = 0; i < meshlet.indexCount; i += 3)
+                {
+                    const glm::vec3& a = vertices[tri[i]].Position;
+                    const glm::vec3& b = vertices[tri[i + 1]].Position;
+                    const glm::vec3& c = vertices[tri[i + 2]].Position;
+                    lo = glm::min(lo, glm::min(a, glm::min(b, c)));
+                    hi = glm::max(hi, glm::max(a, glm::max(b, c)));
+                    glm::vec3 n = glm::cross(b - a, c - a);
+                    float len = glm::length(n);
+                    if (len > 0.0f) normalSum += n / len;
+                }
+
+                meshlet.center = (lo + hi) * 0.5f;
+                float radius2 = 0.0f;
+                for (uint32_t i = 0; i < meshlet.indexCount; i++)
+                {
+                    glm::vec3 d = vertices[tri[i]].Position - meshlet.center;
+                    radius2 = std::max(radius2, glm::dot(d, d));
+                }
+                meshlet.radius = std::sqrt(radius2);
+
+                // The cone spans every triangle normal; a spread of 90 degrees or
+                // more has no back-facing viewpoint to cull from.
+                meshlet.coneCutoff = 1.0f;
+                float axisLength = glm::length(normalSum);
+                meshlet.coneAxis = axisLength > 0.0f ? normalSum / axisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+                if (axisLength == 0.0f) continue;
+
+                float minDot = 1.0f;
+                for (uint32_t i = 0; i < meshlet.indexCount; i += 3)
+                {
+                    const glm::vec3& a = vertices[tri[i]].Position;
+                    glm::vec3 n = glm::cross(vertices[tri[i + 1]].Position - a, vertices[tri[i + 2]].Position - a);
+                    float len = glm::length(n);
+                    if (len > 0.0f) minDot = std::min(minDot, glm::dot(n / len, meshlet.coneAxis));
+                }
+                if (minDot > 0.0f) meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+            }
+        });
+    }
+}
+
+MeshOptimizer::OptimizeStats MeshOptimizer::Optimize(MeshData& mesh, bool analyzeOverdraw)
+{
+    OptimizeStats stats;
+    const size_t vertexCount = mesh.vertices.size();
+    stats.acmrBefore = ComputeACMR(mesh.indices.data(), mesh.indices.size(), vertexCount);
+    stats.atvrBefore = ComputeATVR(mesh.indices.data(), mesh.indices.size(), vertexCount);
+    if (analyzeOverdraw) stats.overdrawBefore = ComputeOverdraw(mesh.vertices, mesh.indices);
+
+    OptimizeVertexCache(mesh.indices, vertexCount);
+    BuildMeshlets(mesh);
+    OptimizeVertexFetch(mesh);
+
+    stats.acmrAfter = ComputeACMR(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+    stats.atvrAfter = ComputeATVR(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+    if (analyzeOverdraw) stats.overdrawAfter = ComputeOverdraw(mesh.vertices, mesh.indices);
+    return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount,
+                                        unsigned int cacheSize)
+{
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    // Vertex -> triangle adjacency in CSR form.
+    std::vector<uint32_t> live(vertexCount, 0);
+    for (unsigned int index : indices) live[index]++;
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) offsets[v + 1] = offsets[v] + live[v];
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++) adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<char> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+
+    uint32_t time = cacheSize + 1;
+    size_t cursor = 0;
+    long long fanning = indices[0];
+    while (fanning >= 0)
+    {
+        candidates.clear();
+        for (uint32_t a = offsets[fanning]; a < offsets[fanning + 1]; a++)
+        {
+            uint32_t t = adjacency[a];
+            if (emitted[t]) continue;
+            emitted[t] = 1;
+            for (int k = 0; k < 3; k++)
+            {
+                unsigned int v = indices[t * 3 + k];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (time - cacheTime[v] > cacheSize) cacheTime[v] = time++;
+            }
+        }
+
+        // Prefer a vertex that stays in cache long enough to fan out all its
+        // remaining triangles, oldest first.
+        long long next = -1;
+        long long bestPriority = -1;
+        for (uint32_t v : candidates)
+        {
+            if (live[v] == 0) continue;
+            long long priority = 0;
+            if (time - cacheTime[v] + 2 * live[v] <= cacheSize) priority = time - cacheTime[v];
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                next = v;
+            }
+        }
+
+        if (next < 0)
+        {
+            // Dead end: back up through recently used vertices, then scan for
+            // anything left.
+            while (!deadEnd.empty() && next < 0)
+            {
+                uint32_t d = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[d] > 0) next = d;
+            }
+            while (next < 0 && cursor < vertexCount)
+            {
+                if (live[cursor] > 0) next = static_cast<long long>(cursor);
+                cursor++;
+            }
+        }
+        fanning = next;
+    }
+    indices.swap(output);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(MeshData& mesh)
+{
+    std::vector<uint32_t> remap(mesh.vertices.size(), UINT32_MAX);
+    std::vector<Vertex> ordered;
+    ordered.reserve(mesh.vertices.size());
+    for (unsigned int& index : mesh.indices)
+    {
+        if (remap[index] == UINT32_MAX)
+        {
+            remap[index] = static_cast<uint32_t>(ordered.size());
+            ordered.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices = std::move(ordered);
+}
+
+void MeshOptimizer::GenerateTangents(MeshData& mesh, bool flipV)
+{
+    const std::vector<unsigned int>& indices = mesh.indices;
+    const size_t triangleCount = indices.size() / 3;
+    const size_t vertexCount = mesh.vertices.size();
+    if (triangleCount == 0) return;
+
+    // 1. Per triangle: the UV handedness (0 for degenerate UVs) and, per
+    // corner, the triangle's tangent projected into the corner's normal plane
+    // and weighted by the corner angle, as MikkTSpace accumulates it.
+    std::vector<signed char> orientation(triangleCount);
+    std::vector<glm::vec3> corners(triangleCount * 3, glm::vec3(0.0f));
+    ThreadPool::Get().ParallelFor(triangleCount, 4096, [&](size_t begin, size_t end) {
+        auto uv = [&](unsigned int v) {
+            glm::vec2 t = mesh.vertices[v].TexCoords;
+            return flipV ? glm::vec2(t.x, 1.0f - t.y) : t;
+        };
+        for (size_t t = begin; t < end; t++)
+        {
+            const unsigned int* tri = &indices[t * 3];
+            const glm::vec3& p0 = mesh.vertices[tri[0]].Position;
+            glm::vec3 d1 = mesh.vertices[tri[1]].Position - p0;
+            glm::vec3 d2 = mesh.vertices[tri[2]].Position - p0;
+            glm::vec2 st1 = uv(tri[1]) - uv(tri[0]);
+            glm::vec2 st2 = uv(tri[2]) - uv(tri[0]);
+            float area = st1.x * st2.y - st1.y * st2.x;
+            glm::vec3 os = d1 * st2.y - d2 * st1.y;
+            float length = glm::length(os);
+            if (std::fabs(area) < 1e-20f || length < 1e-20f)
+            {
+                orientation[t] = 0;
+                continue;
+            }
+            orientation[t] = area > 0.0f ? 1 : -1;
+            os *= orientation[t] / length;
+
+            for (int k = 0; k < 3; k++)
+            {
+                const Vertex& v = mesh.vertices[tri[k]];
+                const glm::vec3& n = v.Normal;
+                auto project = [&n](glm::vec3 x) {
+                    x -= n * glm::dot(n, x);
+                    float l = glm::length(x);
+                    return l > 1e-20f ? x / l : glm::vec3(0.0f);
+                };
+                glm::vec3 e1 = project(mesh.vertices[tri[(k + 2) % 3]].Position - v.Position);
+                glm::vec3 e2 = project(mesh.vertices[tri[(k + 1) % 3]].Position - v.Position);
+                float angle = std::acos(std::clamp(glm::dot(e1, e2), -1.0f, 1.0f));
+                corners[t * 3 + k] = project(os) * angle;
+            }
+        }
+    });
+
+    // 2. Corners by vertex, in triangle order so the sums don't depend on
+    // how the triangles were split across threads.
+    std::vector<uint32_t> firstCorner(vertexCount + 1, 0);
+    for (unsigned int index : indices) firstCorner[index + 1]++;
+    for (size_t v = 0; v < vertexCount; v++) firstCorner[v + 1] += firstCorner[v];
+    std::vector<uint32_t> cornerOf(indices.size());
+    {
+        std::vector<uint32_t> fill(firstCorner.begin(), firstCorner.end() - 1);
+        for (size_t c = 0; c < indices.size(); c++) cornerOf[fill[indices[c]]++] = static_cast<uint32_t>(c);
+    }
+
+    // 3. One tangent per vertex and handedness. A vertex on a mirrored UV
+    // seam is used by triangles of both, and MikkTSpace gives those corners
+    // different tangents, so it is split: the negative side gets a copy.
+    // Degenerate triangles have no say and stay with the original vertex.
+    struct Frame {
+        glm::vec3 positive{0.0f};
+        glm::vec3 negative{0.0f};
+        bool hasPositive = false;
+        bool hasNegative = false;
+    };
+    std::vector<Frame> frames(vertexCount);
+    ThreadPool::Get().ParallelFor(vertexCount, 16384, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; v++)
+        {
+            Frame& frame = frames[v];
+            for (uint32_t i = firstCorner[v]; i < firstCorner[v + 1]; i++)
+            {
+                uint32_t c = cornerOf[i];
+                if (orientation[c / 3] > 0)
+                {
+                    frame.positive += corners[c];
+                    frame.hasPositive = true;
+                }
+                else if (orientation[c / 3] < 0)
+                {
+                    frame.negative += corners[c];
+                    frame.hasNegative = true;
+                }
+            }
+        }
+    });
+
+    std::vector<uint32_t> mirrored(vertexCount, UINT32_MAX);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        if (!frames[v].hasPositive || !frames[v].hasNegative) continue;
+        mirrored[v] = static_cast<uint32_t>(mesh.vertices.size());
+        mesh.vertices.push_back(mesh.vertices[v]);
+    }
+
+    // Bitangent = sign * cross(N, T); a sum that cancelled out keeps the old frame.
+    auto assign = [](Vertex& vertex, const glm::vec3& sum, float sign) {
+        float length = glm::length(sum);
+        if (length < 1e-20f) return;
+        vertex.Tangent = sum / length;
+        vertex.Bitangent = glm::cross(vertex.Normal, vertex.Tangent) * sign;
+    };
+    ThreadPool::Get().ParallelFor(vertexCount, 16384, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; v++)
+        {
+            const Frame& frame = frames[v];
+            if (mirrored[v] != UINT32_MAX)
+            {
+                assign(mesh.vertices[v], frame.positive, 1.0f);
+                assign(mesh.vertices[mirrored[v]], frame.negative, -1.0f);
+            }
+            else if (frame.hasNegative)
+            {
+                assign(mesh.vertices[v], frame.negative, -1.0f);
+            }
+            else
+            {
+                assign(mesh.vertices[v], frame.positive, 1.0f);
+            }
+        }
+    });
+
+    ThreadPool::Get().ParallelFor(triangleCount, 16384, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t++)
+        {
+            if (orientation[t] >= 0) continue;
+            for (size_t c = t * 3; c < t * 3 + 3; c++)
+            {
+                if (mirrored[indices[c]] != UINT32_MAX) mesh.indices[c] = mirrored[indices[c]];
+            }
+        }
+    });
+}
+
+void MeshOptimizer::BuildMeshlets(MeshData& mesh, size_t maxVertices, size_t maxTriangles)
+{
+    const std::vector<unsigned int>& indices = mesh.indices;
+    const size_t triangleCount = indices.size() / 3;
+    const size_t vertexCount = mesh.vertices.size();
+    mesh.meshlets.clear();
+    if (triangleCount == 0) return;
+
+    // Triangle normals, and a seed order (direction class, then Morton order of
+    // the centroids) to continue from whenever the current meshlet has no
+    // unused neighbours left. Faceted meshes share no vertices between faces,
+    // so that order does most of the grouping there.
+    std::vector<glm::vec3> normals(triangleCount);
+    std::vector<glm::vec3> centroids(triangleCount);
+    glm::vec3 lo(std::numeric_limits<float>::max()), hi(-std::numeric_limits<float>::max());
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        const glm::vec3& a = mesh.vertices[indices[t * 3 + 0]].Position;
+        const glm::vec3& b = mesh.vertices[indices[t * 3 + 1]].Position;
+        const glm::vec3& c = mesh.vertices[indices[t * 3 + 2]].Position;
+        glm::vec3 n = glm::cross(b - a, c - a);
+        float len = glm::length(n);
+        normals[t] = len > 0.0f ? n / len : glm::vec3(0.0f);
+        centroids[t] = (a + b + c) / 3.0f;
+        lo = glm::min(lo, centroids[t]);
+        hi = glm::max(hi, centroids[t]);
+    }
+    glm::vec3 extent = glm::max(hi - lo, glm::vec3(1e-12f));
+    std::vector<std::pair<uint64_t, uint32_t>> seeds(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        glm::vec3 q = (centroids[t] - lo) / extent * 1023.0f;
+        uint32_t code = spreadBits(static_cast<uint32_t>(q.x)) | (spreadBits(static_cast<uint32_t>(q.y)) << 1) |
+                        (spreadBits(static_cast<uint32_t>(q.z)) << 2);
+        seeds[t] = {(uint64_t(normalBucket(normals[t])) << 32) | code, static_cast<uint32_t>(t)};
+    }
+    std::sort(seeds.begin(), seeds.end());
+
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (unsigned int index : indices) offsets[index + 1]++;
+    for (size_t v = 0; v < vertexCount; v++) offsets[v + 1] += offsets[v];
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++) adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    // Grow each meshlet through shared vertices, taking the neighbour that adds
+    // the fewest vertices and, among those, faces most like the meshlet so far.
+    std::vector<char> emitted(triangleCount, 0);
+    std::vector<uint32_t> owner(vertexCount, UINT32_MAX);
+    std::vector<uint32_t> meshletVertices;
+    std::vector<uint32_t> order;
+    order.reserve(triangleCount);
+    uint32_t id = 0;
+    size_t seed = 0;
+    Meshlet current = {};
+    glm::vec3 normalSum(0.0f), centroidSum(0.0f);
+    auto newVertices = [&](size_t t) {
+        int added = 0;
+        for (int k = 0; k < 3; k++)
+            if (owner[indices[t * 3 + k]] != id) added++;
+        return added;
+    };
+
+    while (order.size() < triangleCount)
+    {
+        long long best = -1;
+        int bestAdded = 4;
+        float bestFacing = -std::numeric_limits<float>::max();
+        for (uint32_t v : meshletVertices)
+        {
+            for (uint32_t a = offsets[v]; a < offsets[v + 1]; a++)
+            {
+                uint32_t t = adjacency[a];
+                if (emitted[t]) continue;
+                int added = newVertices(t);
+                float facing = glm::dot(normals[t], normalSum);
+                if (added < bestAdded || (added == bestAdded && facing > bestFacing))
+                {
+                    best = t;
+                    bestAdded = added;
+                    bestFacing = facing;
+                }
+            }
+        }
+        if (best < 0)
+        {
+            // No neighbours: take the closest of the next few seeds, with
+            // triangles facing away from the meshlet counted as farther.
+            while (emitted[seeds[seed].second]) seed++;
+            best = seeds[seed].second;
+            if (current.indexCount > 0)
+            {
+                glm::vec3 axis = glm::length(normalSum) > 0.0f ? glm::normalize(normalSum) : glm::vec3(0.0f);
+                glm::vec3 center = centroidSum / static_cast<float>(current.indexCount / 3);
+                auto cost = [&](uint32_t t) {
+                    float spread = 1.0f - glm::dot(normals[t], axis);
+                    return glm::length(centroids[t] - center) * (1.0f + kConeWeight * spread);
+                };
+                float bestCost = cost(static_cast<uint32_t>(best));
+                size_t looked = 0;
+                for (size_t i = seed + 1; i < triangleCount && looked < kSeedWindow; i++)
+                {
+                    uint32_t t = seeds[i].second;
+                    if (emitted[t]) continue;
+                    looked++;
+                    float c = cost(t);
+                    if (c < bestCost)
+                    {
+                        best = t;
+                        bestCost = c;
+                    }
+                }
+            }
+            bestAdded = newVertices(best);
+        }
+
+        if (current.indexCount > 0 &&
+            (meshletVertices.size() + bestAdded > maxVertices || current.indexCount / 3 + 1 > maxTriangles))
+        {
+            mesh.meshlets.push_back(current);
+            current = {};
+            current.indexOffset = static_cast<uint32_t>(order.size() * 3);
+            meshletVertices.clear();
+            normalSum = glm::vec3(0.0f);
+            centroidSum = glm::vec3(0.0f);
+            id++;
+        }
+
+        emitted[best] = 1;
+        order.push_back(static_cast<uint32_t>(best));
+        for (int k = 0; k < 3; k++)
+        {
+            unsigned int v = indices[best * 3 + k];
+            if (owner[v] == id) continue;
+            owner[v] = id;
+            meshletVertices.push_back(v);
+        }
+        normalSum += normals[best];
+        centroidSum += centroids[best];
+        current.indexCount += 3;
+    }
+    mesh.meshlets.push_back(current);
+
+    // The incoming order is the vertex cache order; restoring it inside each
+    // meshlet keeps most of that locality. Meshlets then double as the
+    // overdraw clusters and are drawn outermost first.
+    std::vector<size_t> splits;
+    splits.reserve(mesh.meshlets.size() + 1);
+    for (const Meshlet& meshlet : mesh.meshlets)
+    {
+        auto first = order.begin() + meshlet.indexOffset / 3;
+        std::sort(first, first + meshlet.indexCount / 3);
+        splits.push_back(meshlet.indexOffset / 3);
+    }
+    splits.push_back(triangleCount);
+
+    std::vector<unsigned int> grouped(indices.size());
+    for (size_t i = 0; i < order.size(); i++)
+        for (int k = 0; k < 3; k++) grouped[i * 3 + k] = indices[order[i] * 3 + k];
+
+    std::vector<size_t> clusterOrder = sortClusters(grouped, mesh.vertices, splits);
+    std::vector<Meshlet> sorted;
+    sorted.reserve(mesh.meshlets.size());
+    size_t cursor = 0;
+    for (size_t c : clusterOrder)
+    {
+        Meshlet meshlet = mesh.meshlets[c];
+        std::copy(grouped.begin() + meshlet.indexOffset, grouped.begin() + meshlet.indexOffset + meshlet.indexCount,
+                  mesh.indices.begin() + cursor);
+        meshlet.indexOffset = static_cast<uint32_t>(cursor);
+        cursor += meshlet.indexCount;
+        sorted.push_back(meshlet);
+    }
+    mesh.meshlets = std::move(sorted);
+    computeMeshletBounds(mesh.vertices.data(), mesh.indices.data(), mesh.meshlets);
+}
+
+std::vector<Meshlet> MeshOptimizer::SplitMeshlets(const Vertex* vertices, size_t vertexCount,
+                                                  const unsigned int* indices, size_t indexCount,
+                                                  size_t maxVertices, size_t maxTriangles)
+{
+    std::vector<Meshlet> meshlets;
+    if (indexCount < 3) return meshlets;
+
+    // Greedy scan: a meshlet closes when the next triangle would exceed
+    // either limit. `owner` marks vertices already counted in the current one.
+    std::vector<uint32_t> owner(vertexCount, UINT32_MAX);
+    Meshlet current = {};
+    size_t uniqueVertices = 0;
+    for (size_t t = 0; t + 2 < indexCount; t += 3)
+    {
+        const uint32_t id = static_cast<uint32_t>(meshlets.size());
+        size_t added = 0;
+        for (int k = 0; k < 3; k++)
+            if (owner[indices[t + k]] != id) added++;
+
+        if (current.indexCount > 0 &&
+            (uniqueVertices + added > maxVertices || current.indexCount / 3 + 1 > maxTriangles))
+        {
+            meshlets.push_back(current);
+            current = {};
+            current.indexOffset = static_cast<uint32_t>(t);
+            uniqueVertices = 0;
+        }
+
+        const uint32_t target = static_cast<uint32_t>(meshlets.size());
+        for (int k = 0; k < 3; k++)
+        {
+            unsigned int v = indices[t + k];
+            if (owner[v] != target)
+            {
+                owner[v] = target;
+                uniqueVertices++;
+            }
+        }
+        current.indexCount += 3;
+    }
+    meshlets.push_back(current);
+
+    computeMeshletBounds(vertices, indices, meshlets);
+    return meshlets;
+}
+
+namespace
+{
+    // Cache misses and referenced vertex count for a FIFO cache: a vertex
+    // entering at time t is evicted once `cacheSize` newer vertices have entered.
+    void simulateCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize,
+                       size_t& misses, size_t& referenced)
+    {
+        std::vector<size_t> entered(vertexCount, SIZE_MAX);
+        size_t time = 0;
+        misses = referenced = 0;
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            unsigned int v = indices[i];
+            if (entered[v] == SIZE_MAX) referenced++;
+            if (entered[v] == SIZE_MAX || time - entered[v] >= cacheSize)
+            {
+                entered[v] = time++;
+                misses++;
+            }
+        }
+    }
+
+    // Depth-tested rasterization of one orthographic view. Counts fragments
+    // that pass the depth test when drawn (what early-z would shade) and the
+    // pixels covered at the end.
+    void rasterizeView(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                       const glm::vec3& axis, const glm::vec3& center, float radius, size_t& shaded, size_t& covered)
+    {
+        const int size = 256;
+        glm::vec3 up = std::abs(axis.y) < 0.9f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+        glm::vec3 u = glm::normalize(glm::cross(up, axis));
+        glm::vec3 v = glm::cross(axis, u);
+        float scale = (size * 0.5f) / radius;
+
+        std::vector<glm::vec3> screen(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            glm::vec3 p = vertices[i].Position - center;
+            screen[i] = glm::vec3(glm::dot(p, u) * scale + size * 0.5f, glm::dot(p, v) * scale + size * 0.5f,
+                                  glm::dot(p, axis));
+        }
+
+        std::vector<float> depth(size_t(size) * size, std::numeric_limits<float>::max());
+        for (size_t t = 0; t + 2 < indices.size(); t += 3)
+        {
+            glm::vec3 a = screen[indices[t]], b = screen[indices[t + 1]], c = screen[indices[t + 2]];
+            float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            if (std::abs(area) < 1e-12f) continue;
+
+            int minX = std::max(0, static_cast<int>(std::floor(std::min({a.x, b.x, c.x}))));
+            int maxX = std::min(size - 1, static_cast<int>(std::ceil(std::max({a.x, b.x, c.x}))));
+            int minY = std::max(0, static_cast<int>(std::floor(std::min({a.y, b.y, c.y}))));
+            int maxY = std::min(size - 1, static_cast<int>(std::ceil(std::max({a.y, b.y, c.y}))));
+            for (int y = minY; y <= maxY; y++)
+            {
+                for (int x = minX; x <= maxX; x++)
+                {
+                    float px = x + 0.5f, py = y + 0.5f;
+                    float w0 = ((b.x - px) * (c.y - py) - (b.y - py) * (c.x - px)) / area;
+                    float w1 = ((c.x - px) * (a.y - py) - (c.y - py) * (a.x - px)) / area;
+                    float w2 = 1.0f - w0 - w1;
+                    if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+
+                    float z = w0 * a.z + w1 * b.z + w2 * c.z;
+                    float& stored = depth[size_t(y) * size + x];
+                    if (z < stored)
+                    {
+                        if (stored == std::numeric_limits<float>::max()) covered++;
+                        stored = z;
+                        shaded++;
+                    }
+                }
+            }
+        }
+    }
+}
+
+float MeshOptimizer::ComputeOverdraw(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+    if (vertices.empty() || indices.size() < 3) return 0.0f;
+
+    glm::vec3 lo = vertices[0].Position, hi = lo;
+    for (const Vertex& v : vertices)
+    {
+        lo = glm::min(lo, v.Position);
+        hi = glm::max(hi, v.Position);
+    }
+    glm::vec3 center = (lo + hi) * 0.5f;
+    float radius = std::max(glm::length(hi - lo) * 0.5f, 1e-6f);
+
+    const glm::vec3 axes[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    size_t shaded[6] = {}, covered[6] = {};
+    ThreadPool::Get().ParallelFor(6, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            rasterizeView(vertices, indices, axes[i], center, radius, shaded[i], covered[i]);
+    });
+
+    size_t totalShaded = 0, totalCovered = 0;
+    for (int i = 0; i < 6; i++)
+    {
+        totalShaded += shaded[i];
+        totalCovered += covered[i];
+    }
+    return totalCovered ? static_cast<float>(totalShaded) / static_cast<float>(totalCovered) : 0.0f;
+}
+
+float MeshOptimizer::ComputeACMR(const unsigned int* indices, size_t indexCount, size_t vertexCount,
+                                 unsigned int cacheSize)
+{
+    if (indexCount < 3) return 0.0f;
+    size_t misses, referenced;
+    simulateCache(indices, indexCount, vertexCount, cacheSize, misses, referenced);
+    return static_cast<float>(misses) / static_cast<float>(indexCount / 3);
+}
+
+float MeshOptimizer::ComputeATVR(const unsigned int* indices, size_t indexCount, size_t vertexCount,
+                                 unsigned int cacheSize)
+{
+    size_t misses, referenced;
+    simulateCache(indices, indexCount, vertexCount, cacheSize, misses, referenced);
+    return referenced ? static_cast<float>(misses) / static_cast<float>(referenced) : 0.0f;
+}
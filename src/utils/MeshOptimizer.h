@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "RenderTypes.h"
+
+// CPU passes over imported index/vertex streams, run off the GL thread.
+class MeshOptimizer
+{
+public:
+    static constexpr unsigned int DefaultCacheSize = 16;
+
+    struct WeldStats {
+        size_t triangles = 0;
+        size_t verticesBefore = 0;
+        size_t verticesAfter = 0;
+        float acmrBefore = 0.0f;
+        float acmrAfter = 0.0f;
+    };
+
+    struct OptimizeStats {
+        float acmrBefore = 0.0f;
+        float acmrAfter = 0.0f;
+        float atvrBefore = 0.0f;
+        float atvrAfter = 0.0f;
+        // Shaded fragments per covered pixel; 0 unless overdraw analysis ran.
+        float overdrawBefore = 0.0f;
+        float overdrawAfter = 0.0f;
+    };
+
+    // Merges vertices whose every attribute (the full Vertex, bone data
+    // included) matches within `epsilon`. Values are snapped to an epsilon
+    // grid and hashed, so this is linear in the vertex count; epsilon 0 welds
+    // exact duplicates only. Surviving vertices keep first-use order.
+    static WeldStats Weld(MeshData& mesh, float epsilon = 1e-5f);
+
+    // Full pipeline: vertex cache order, meshlets sorted for overdraw, then
+    // vertex fetch order. Overdraw is only measured (it rasterizes the mesh several
+    // times) when `analyzeOverdraw` is set.
+    static OptimizeStats Optimize(MeshData& mesh, bool analyzeOverdraw = false);
+
+    // Tipsify (Sander et al. 2007). Reorders triangles for a post-transform
+    // cache of `cacheSize`.
+    static void OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount,
+                                    unsigned int cacheSize = DefaultCacheSize);
+    // Renumbers vertices in first-use order and drops unreferenced ones.
+    static void OptimizeVertexFetch(MeshData& mesh);
+
+    // MikkTSpace-style tangent frames for an indexed mesh: each triangle's
+    // unit UV tangent is projected into the vertex normal's plane and summed
+    // with the corner angle as weight, per vertex and UV handedness.
+    // Bitangent = sign * cross(N, T). Vertices used with both handednesses
+    // (mirrored UV seams) are split, so the mesh may grow. Runs on the
+    // ThreadPool. `flipV` reads V as 1 - v, for UVs stored with a top-left
+    // origin; vertices with only degenerate UVs keep their frame.
+    static void GenerateTangents(MeshData& mesh, bool flipV = false);
+
+    // Regroups the triangles into spatially compact meshlets of at most
+    // `maxVertices` unique vertices and `maxTriangles` triangles, fills
+    // mesh.meshlets with their ranges, bounding spheres and normal cones, and
+    // orders them for overdraw: outward-facing meshlets first, so early depth
+    // test rejects more of what follows from any viewpoint.
+    // The existing order is kept within each meshlet, so run this after
+    // OptimizeVertexCache.
+    static void BuildMeshlets(MeshData& mesh, size_t maxVertices = 64, size_t maxTriangles = 124);
+    // Meshlets for an index buffer as it is, cut greedily in order. For meshes
+    // that never went through BuildMeshlets.
+    static std::vector<Meshlet> SplitMeshlets(const Vertex* vertices, size_t vertexCount,
+                                              const unsigned int* indices, size_t indexCount,
+                                              size_t maxVertices = 64, size_t maxTriangles = 124);
+
+    // Average cache miss ratio: post-transform cache misses per triangle for a
+    // FIFO cache of `cacheSize` entries. 3.0 means no reuse at all.
+    static float ComputeACMR(const unsigned int* indices, size_t indexCount, size_t vertexCount,
+                             unsigned int cacheSize = DefaultCacheSize);
+    // Average transform to vertex ratio: cache misses per referenced vertex; 1.0 is ideal.
+    static float ComputeATVR(const unsigned int* indices, size_t indexCount, size_t vertexCount,
+                             unsigned int cacheSize = DefaultCacheSize);
+    // Software-rasterized overdraw averaged over six axis views.
+    static float ComputeOverdraw(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+};
@@ -0,0 +1,257 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <unordered_map>
+
+namespace
+{
+    // Symmetric 4x4 quadric, stored as A (upper triangle), b and c, plus the
+    // total plane weight so errors come out as mean squared distances.
+    struct Quadric {
+        double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+        double b0 = 0, b1 = 0, b2 = 0, c = 0;
+        double weight = 0;
+
+        void AddPlane(const glm::dvec3& n, double d, double w)
+        {
+            a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z;
+            a11 += w * n.y * n.y; a12 += w * n.y * n.z; a22 += w * n.z * n.z;
+            b0 += w * n.x * d; b1 += w * n.y * d; b2 += w * n.z * d;
+            c += w * d * d;
+            weight += w;
+        }
+
+        Quadric& operator+=(const Quadric& o)
+        {
+            a00 += o.a00; a01 += o.a01; a02 += o.a02; a11 += o.a11; a12 += o.a12; a22 += o.a22;
+            b0 += o.b0; b1 += o.b1; b2 += o.b2; c += o.c;
+            weight += o.weight;
+            return *this;
+        }
+    };
+
+    // Mean squared distance of `p` to the planes of both quadrics.
+    float collapseError(const Quadric& a, const Quadric& b, const glm::vec3& p)
+    {
+        Quadric q = a;
+        q += b;
+        if (q.weight <= 0.0) return 0.0f;
+        double x = p.x, y = p.y, z = p.z;
+        double e = q.a00 * x * x + q.a11 * y * y + q.a22 * z * z +
+                   2.0 * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z) +
+                   2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+        return static_cast<float>(std::max(e, 0.0) / q.weight);
+    }
+
+    // Meshes without normals have nothing to preserve.
+    bool normalsAgree(const glm::vec3& a, const glm::vec3& b, float cosLimit)
+    {
+        float la = glm::length(a), lb = glm::length(b);
+        return la == 0.0f || lb == 0.0f || glm::dot(a, b) >= cosLimit * la * lb;
+    }
+
+    struct Collapse {
+        uint32_t from;
+        uint32_t to;
+        float error;
+    };
+}
+
+std::vector<unsigned int> MeshSimplifier::Simplify(const std::vector<Vertex>& vertices, const unsigned int* indices,
+                                                   size_t indexCount, size_t targetIndexCount, float targetError,
+                                                   float normalAngle, float* resultError)
+{
+    std::vector<unsigned int> result(indices, indices + indexCount);
+    if (resultError) *resultError = 0.0f;
+    const size_t vertexCount = vertices.size();
+    if (result.size() <= targetIndexCount || vertexCount == 0) return result;
+
+    // Wedges (welded vertices sharing a position) are one vertex to the
+    // simplifier; `position` maps each wedge to the first of its group.
+    std::vector<uint32_t> position(vertexCount);
+    std::vector<uint32_t> wedges(vertexCount, 0);
+    {
+        std::vector<uint32_t> sorted(vertexCount);
+        std::iota(sorted.begin(), sorted.end(), 0u);
+        auto less = [&vertices](uint32_t a, uint32_t b) {
+            const glm::vec3& p = vertices[a].Position;
+            const glm::vec3& q = vertices[b].Position;
+            return p.x != q.x ? p.x < q.x : p.y != q.y ? p.y < q.y : p.z < q.z;
+        };
+        std::sort(sorted.begin(), sorted.end(), less);
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            uint32_t v = sorted[i];
+            bool same = i > 0 && vertices[sorted[i - 1]].Position == vertices[v].Position;
+            position[v] = same ? position[sorted[i - 1]] : v;
+            wedges[position[v]]++;
+        }
+    }
+
+    // Seams, open borders and non-manifold edges stay where they are.
+    std::vector<char> locked(vertexCount, 0);
+    for (size_t v = 0; v < vertexCount; v++)
+        if (wedges[v] > 1) locked[v] = 1;
+    {
+        std::unordered_map<uint64_t, uint32_t> edgeUse;
+        edgeUse.reserve(result.size());
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t a = position[result[i + k]], b = position[result[i + (k + 1) % 3]];
+                edgeUse[(uint64_t(std::min(a, b)) << 32) | std::max(a, b)]++;
+            }
+        }
+        for (const auto& edge : edgeUse)
+        {
+            if (edge.second == 2) continue;
+            locked[edge.first >> 32] = 1;
+            locked[edge.first & 0xffffffffu] = 1;
+        }
+    }
+
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i + 2 < result.size(); i += 3)
+    {
+        glm::dvec3 p0 = vertices[result[i]].Position, p1 = vertices[result[i + 1]].Position,
+                   p2 = vertices[result[i + 2]].Position;
+        glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+        double area2 = glm::length(n);
+        if (area2 <= 0.0) continue;
+        n /= area2;
+        for (int k = 0; k < 3; k++)
+            quadrics[position[result[i + k]]].AddPlane(n, -glm::dot(n, p0), area2 * 0.5);
+    }
+
+    const float cosLimit = std::cos(glm::radians(normalAngle));
+    const float errorLimit = targetError * targetError;
+    std::vector<uint32_t> remap(vertexCount);
+    std::iota(remap.begin(), remap.end(), 0u);
+    std::vector<uint32_t> offsets, adjacency;
+    std::vector<Collapse> candidates;
+    std::vector<char> touched;
+    float maxError = 0.0f;
+
+    while (result.size() > targetIndexCount)
+    {
+        // Triangles around each position.
+        offsets.assign(vertexCount + 1, 0);
+        for (unsigned int index : result) offsets[position[index] + 1]++;
+        for (size_t v = 0; v < vertexCount; v++) offsets[v + 1] += offsets[v];
+        adjacency.resize(result.size());
+        {
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < result.size(); i++)
+                adjacency[fill[position[result[i]]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        candidates.clear();
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t a = result[i + k], b = result[i + (k + 1) % 3];
+                const uint32_t pa = position[a], pb = position[b];
+                if (!locked[pa])
+                    candidates.push_back({a, b, collapseError(quadrics[pa], quadrics[pb], vertices[b].Position)});
+                if (!locked[pb])
+                    candidates.push_back({b, a, collapseError(quadrics[pa], quadrics[pb], vertices[a].Position)});
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Collapse& x, const Collapse& y) { return x.error < y.error; });
+
+        // Cheapest first; a collapse claims every vertex around it for the
+        // rest of the pass, so the checks below see current geometry.
+        touched.assign(vertexCount, 0);
+        const size_t wanted = (result.size() - targetIndexCount) / 6 + 1; // ~2 triangles per collapse
+        size_t collapsed = 0;
+        for (const Collapse& c : candidates)
+        {
+            if (c.error > errorLimit) break;
+            const uint32_t from = position[c.from], to = position[c.to];
+            if (touched[from] || touched[to]) continue;
+            if (!normalsAgree(vertices[c.from].Normal, vertices[c.to].Normal, cosLimit)) continue;
+
+            bool valid = true;
+            for (uint32_t a = offsets[from]; a < offsets[from + 1] && valid; a++)
+            {
+                const unsigned int* tri = &result[size_t(adjacency[a]) * 3];
+                if (position[tri[0]] == to || position[tri[1]] == to || position[tri[2]] == to) continue;
+
+                glm::vec3 p[3], q[3];
+                for (int k = 0; k < 3; k++)
+                {
+                    p[k] = vertices[tri[k]].Position;
+                    q[k] = position[tri[k]] == from ? vertices[c.to].Position : p[k];
+                }
+                glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+                float lb = glm::length(before), la = glm::length(after);
+                valid = la > 0.0f && (lb == 0.0f || glm::dot(before, after) >= cosLimit * lb * la);
+            }
+            if (!valid) continue;
+
+            remap[c.from] = c.to;
+            quadrics[to] += quadrics[from];
+            for (uint32_t a = offsets[from]; a < offsets[from + 1]; a++)
+                for (int k = 0; k < 3; k++) touched[position[result[size_t(adjacency[a]) * 3 + k]]] = 1;
+            maxError = std::max(maxError, c.error);
+            if (++collapsed >= wanted) break;
+        }
+        if (collapsed == 0) break;
+
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            unsigned int a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+            if (position[a] == position[b] || position[b] == position[c] || position[a] == position[c]) continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    if (resultError) *resultError = std::sqrt(maxError);
+    return result;
+}
+
+void MeshSimplifier::BuildLods(MeshData& mesh, float maxRelativeError)
+{
+    mesh.lods.assign(1, MeshLod{0, static_cast<uint32_t>(mesh.indices.size()), 0.0f});
+    if (mesh.vertices.empty()) return;
+
+    glm::vec3 lo = mesh.vertices[0].Position, hi = lo;
+    for (const Vertex& v : mesh.vertices)
+    {
+        lo = glm::min(lo, v.Position);
+        hi = glm::max(hi, v.Position);
+    }
+    const float targetError = glm::length(hi - lo) * 0.5f * maxRelativeError;
+
+    std::vector<unsigned int> previous = mesh.indices;
+    float previousError = 0.0f;
+    for (size_t level = 1; level < MaxLods; level++)
+    {
+        // Below this a coarser level saves less than the draw call costs.
+        if (previous.size() < 3 * 64) break;
+
+        float error = 0.0f;
+        std::vector<unsigned int> lod = Simplify(mesh.vertices, previous.data(), previous.size(),
+                                                 (previous.size() / 6) * 3, targetError, 25.0f, &error);
+        if (lod.empty() || lod.size() > previous.size() * 17 / 20) break;
+
+        MeshOptimizer::OptimizeVertexCache(lod, mesh.vertices.size());
+        previousError += error;
+        mesh.lods.push_back({static_cast<uint32_t>(mesh.indices.size()), static_cast<uint32_t>(lod.size()),
+                             previousError});
+        mesh.indices.insert(mesh.indices.end(), lod.begin(), lod.end());
+        previous = std::move(lod);
+    }
+}
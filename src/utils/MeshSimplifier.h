@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "RenderTypes.h"
+
+// Quadric error edge-collapse simplification (Garland & Heckbert 1997) and
+// the LOD chains built with it. Collapses are half-edge collapses onto an
+// existing vertex, so every LOD indexes the same vertex buffer.
+class MeshSimplifier
+{
+public:
+    static constexpr size_t MaxLods = 4;
+
+    // Returns a reduced index list of at most `targetIndexCount` indices where
+    // the error budget allows. Vertices on open borders or on attribute seams
+    // (same position, different normal/UV) never move. A collapse is rejected
+    // if it turns any remaining triangle, or bends the vertex normal, by more
+    // than `normalAngle` degrees. `resultError` receives the largest quadric
+    // distance (mesh units) that was accepted.
+    static std::vector<unsigned int> Simplify(const std::vector<Vertex>& vertices, const unsigned int* indices,
+                                              size_t indexCount, size_t targetIndexCount, float targetError,
+                                              float normalAngle = 25.0f, float* resultError = nullptr);
+
+    // Appends up to MaxLods - 1 coarser levels, each about half the triangles
+    // of the one before, to mesh.indices and describes all levels in
+    // mesh.lods. Stops early once a level no longer shrinks meaningfully
+    // within `maxRelativeError` of the mesh's bounding radius.
+    static void BuildLods(MeshData& mesh, float maxRelativeError = 0.02f);
+};
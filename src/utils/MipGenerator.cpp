@@ -0,0 +1,356 @@
+#include "MipGenerator.h"
+#include "MipKernelsAVX2.h"
+#include "SrgbTables.h"
+#include "TextureBaker.h"
+#include "ThreadPool.h"
+
+#include "image_helper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIP_USE_SSE 1
+#include <emmintrin.h>
+#endif
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MIP_CPUID_BUILTIN 1
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define MIP_CPUID_MSVC 1
+#include <intrin.h>
+#endif
+
+namespace
+{
+    const int kKaiserTaps = MipKernelsAVX2::KaiserTaps;
+
+    // Float images are always four floats per texel so one texel is one vector.
+    struct FloatImage {
+        int width = 0;
+        int height = 0;
+        std::vector<float> texels;
+
+        float* Row(int y) { return texels.data() + size_t(y) * width * 4; }
+        const float* Row(int y) const { return texels.data() + size_t(y) * width * 4; }
+    };
+
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 24; k++)
+        {
+            double f = x / (2.0 * k);
+            term *= f * f;
+            sum += term;
+        }
+        return sum;
+    }
+
+    // Kaiser-windowed sinc for a 2:1 reduction. Tap k reads source texel 2x - 3 + k.
+    const float* kaiserWeights()
+    {
+        static const struct Weights {
+            float w[kKaiserTaps];
+            Weights()
+            {
+                const double alpha = 4.0, pi = 3.14159265358979323846;
+                double sum = 0.0, taps[kKaiserTaps];
+                for (int k = 0; k < kKaiserTaps; k++)
+                {
+                    double t = (k - 3.5) / 2.0; // distance in destination texels
+                    double sinc = std::sin(pi * t) / (pi * t);
+                    double u = t / 2.0;
+                    double window = besselI0(alpha * std::sqrt(std::max(0.0, 1.0 - u * u))) / besselI0(alpha);
+                    taps[k] = sinc * window;
+                    sum += taps[k];
+                }
+                for (int k = 0; k < kKaiserTaps; k++)
+                    w[k] = static_cast<float>(taps[k] / sum);
+            }
+        } weights;
+        return weights.w;
+    }
+
+    int address(int i, int size, bool wrap)
+    {
+        if (wrap) return ((i % size) + size) % size;
+        return std::min(std::max(i, 0), size - 1);
+    }
+
+    bool useAVX2()
+    {
+        static const bool supported = MipKernelsAVX2::Supported();
+        return supported;
+    }
+
+    size_t rowGrain(int width)
+    {
+        return static_cast<size_t>(std::max(1, 65536 / std::max(1, width)));
+    }
+
+    // Which channels carry sRGB-encoded colour; alpha never does.
+    void srgbChannels(int channels, MipColorSpace space, bool out[4])
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            bool alpha = (channels == 4 && c == 3) || (channels == 2 && c == 1);
+            out[c] = space == MipColorSpace::sRGB && !alpha;
+        }
+    }
+
+    void decode(const unsigned char* pixels, int width, int height, int channels, MipColorSpace space, FloatImage& out)
+    {
+        out.width = width;
+        out.height = height;
+        out.texels.assign(size_t(width) * height * 4, 0.0f);
+
+        bool srgb[4];
+        srgbChannels(channels, space, srgb);
+        const SrgbTables& t = GetSrgbTables();
+        ThreadPool::Get().ParallelFor(height, rowGrain(width), [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; y++)
+            {
+                const unsigned char* src = pixels + y * width * channels;
+                float* dst = out.Row(static_cast<int>(y));
+                for (int x = 0; x < width; x++, src += channels, dst += 4)
+                {
+                    for (int c = 0; c < channels; c++)
+                    {
+                        if (space == MipColorSpace::Normal && c < 3) dst[c] = src[c] / 127.5f - 1.0f;
+                        else dst[c] = srgb[c] ? t.srgbToLinear[src[c]] : src[c] / 255.0f;
+                    }
+                    if (channels < 4) dst[3] = 1.0f;
+                }
+            }
+        });
+    }
+
+    void encode(const FloatImage& image, int channels, MipColorSpace space, unsigned char* out)
+    {
+        bool srgb[4];
+        srgbChannels(channels, space, srgb);
+        const SrgbTables& t = GetSrgbTables();
+        ThreadPool::Get().ParallelFor(image.height, rowGrain(image.width), [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; y++)
+            {
+                const float* src = image.Row(static_cast<int>(y));
+                unsigned char* dst = out + y * image.width * channels;
+                for (int x = 0; x < image.width; x++, src += 4, dst += channels)
+                {
+                    for (int c = 0; c < channels; c++)
+                    {
+                        float v = space == MipColorSpace::Normal && c < 3 ? src[c] * 0.5f + 0.5f : src[c];
+                        v = std::min(std::max(v, 0.0f), 1.0f);
+                        dst[c] = srgb[c] ? t.linearToSrgb[static_cast<int>(v * 4095.0f + 0.5f)]
+                                         : static_cast<unsigned char>(v * 255.0f + 0.5f);
+                    }
+                }
+            }
+        });
+    }
+
+    void boxRow(const float* r0, const float* r1, int srcWidth, float* dst, int dstWidth)
+    {
+        int x = useAVX2() ? MipKernelsAVX2::BoxRow(r0, r1, srcWidth, dst, dstWidth) : 0;
+        for (; x < dstWidth; x++)
+        {
+            int i0 = std::min(2 * x, srcWidth - 1) * 4, i1 = std::min(2 * x + 1, srcWidth - 1) * 4;
+#if MIP_USE_SSE
+            __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(r0 + i0), _mm_loadu_ps(r0 + i1)),
+                                    _mm_add_ps(_mm_loadu_ps(r1 + i0), _mm_loadu_ps(r1 + i1)));
+            _mm_storeu_ps(dst + 4 * x, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#else
+            for (int c = 0; c < 4; c++)
+                dst[4 * x + c] = (r0[i0 + c] + r0[i1 + c] + r1[i0 + c] + r1[i1 + c]) * 0.25f;
+#endif
+        }
+    }
+
+    void kaiserRow(const float* src, int srcWidth, float* dst, int dstWidth, const float* w, bool wrap)
+    {
+        int x = useAVX2() ? MipKernelsAVX2::KaiserRow(src, srcWidth, dst, dstWidth, w, wrap) : 0;
+        for (; x < dstWidth; x++)
+        {
+#if MIP_USE_SSE
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < kKaiserTaps; k++)
+            {
+                const float* s = src + address(2 * x - 3 + k, srcWidth, wrap) * 4;
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(s)));
+            }
+            _mm_storeu_ps(dst + 4 * x, acc);
+#else
+            float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (int k = 0; k < kKaiserTaps; k++)
+            {
+                const float* s = src + address(2 * x - 3 + k, srcWidth, wrap) * 4;
+                for (int c = 0; c < 4; c++) acc[c] += w[k] * s[c];
+            }
+            for (int c = 0; c < 4; c++) dst[4 * x + c] = acc[c];
+#endif
+        }
+    }
+
+    // Weighted sum of whole rows; `count` floats, always a multiple of four.
+    void kaiserColumn(const float* const* rows, float* dst, size_t count, const float* w)
+    {
+        size_t i = useAVX2() ? MipKernelsAVX2::KaiserColumn(rows, dst, count, w) : 0;
+#if MIP_USE_SSE
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < kKaiserTaps; k++)
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(rows[k] + i)));
+            _mm_storeu_ps(dst + i, acc);
+        }
+#endif
+        for (; i < count; i++)
+        {
+            float acc = 0.0f;
+            for (int k = 0; k < kKaiserTaps; k++) acc += w[k] * rows[k][i];
+            dst[i] = acc;
+        }
+    }
+
+    void downsample(const FloatImage& src, const MipSettings& settings, FloatImage& dst)
+    {
+        dst.width = std::max(1, src.width / 2);
+        dst.height = std::max(1, src.height / 2);
+        dst.texels.resize(size_t(dst.width) * dst.height * 4);
+        ThreadPool& pool = ThreadPool::Get();
+
+        if (settings.filter == MipFilter::Box)
+        {
+            pool.ParallelFor(dst.height, rowGrain(dst.width), [&](size_t begin, size_t end) {
+                for (size_t y = begin; y < end; y++)
+                {
+                    int y0 = std::min(int(2 * y), src.height - 1), y1 = std::min(int(2 * y + 1), src.height - 1);
+                    boxRow(src.Row(y0), src.Row(y1), src.width, dst.Row(static_cast<int>(y)), dst.width);
+                }
+            });
+        }
+        else
+        {
+            // Separable: horizontal into a half-width temporary, then vertical.
+            const float* w = kaiserWeights();
+            FloatImage temp;
+            temp.width = dst.width;
+            temp.height = src.height;
+            temp.texels.resize(size_t(temp.width) * temp.height * 4);
+            pool.ParallelFor(src.height, rowGrain(dst.width), [&](size_t begin, size_t end) {
+                for (size_t y = begin; y < end; y++)
+                    kaiserRow(src.Row(static_cast<int>(y)), src.width, temp.Row(static_cast<int>(y)), dst.width, w,
+                              settings.wrap);
+            });
+            pool.ParallelFor(dst.height, rowGrain(dst.width), [&](size_t begin, size_t end) {
+                const float* rows[kKaiserTaps];
+                for (size_t y = begin; y < end; y++)
+                {
+                    for (int k = 0; k < kKaiserTaps; k++)
+                        rows[k] = temp.Row(address(int(2 * y) - 3 + k, temp.height, settings.wrap));
+                    kaiserColumn(rows, dst.Row(static_cast<int>(y)), size_t(dst.width) * 4, w);
+                }
+            });
+        }
+
+        if (settings.colorSpace == MipColorSpace::Normal)
+        {
+            pool.ParallelFor(dst.height, rowGrain(dst.width), [&](size_t begin, size_t end) {
+                for (size_t y = begin; y < end; y++)
+                {
+                    float* t = dst.Row(static_cast<int>(y));
+                    for (int x = 0; x < dst.width; x++, t += 4)
+                    {
+                        float len = std::sqrt(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+                        if (len > 1e-6f)
+                        {
+                            t[0] /= len;
+                            t[1] /= len;
+                            t[2] /= len;
+                        }
+                        else
+                        {
+                            t[0] = t[1] = 0.0f;
+                            t[2] = 1.0f;
+                        }
+                    }
+                }
+            });
+        }
+    }
+}
+
+bool MipKernelsAVX2::Supported()
+{
+#if MIP_CPUID_BUILTIN
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif MIP_CPUID_MSVC
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    // OSXSAVE and AVX, then the OS must save the YMM registers.
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+void MipGenerator::Build(const unsigned char* pixels, int width, int height, int channels,
+                         const MipSettings& settings, TextureImage& out)
+{
+    MipSettings effective = settings;
+    if (effective.colorSpace == MipColorSpace::Normal && channels < 3) effective.colorSpace = MipColorSpace::Linear;
+
+    out = TextureImage{};
+    out.width = width;
+    out.height = height;
+    out.channels = channels;
+
+    size_t total = 0;
+    for (int w = width, h = height;; w = std::max(1, w / 2), h = std::max(1, h / 2))
+    {
+        out.levels.push_back({w, h, total, size_t(w) * h * channels});
+        total += out.levels.back().size;
+        if (w == 1 && h == 1) break;
+    }
+    out.data.resize(total);
+
+    // Level 0 is the source itself.
+    std::copy(pixels, pixels + out.levels[0].size, out.data.begin());
+
+    FloatImage current, next;
+    decode(pixels, width, height, channels, effective.colorSpace, current);
+    for (size_t i = 1; i < out.levels.size(); i++)
+    {
+        downsample(current, effective, next);
+        encode(next, channels, effective.colorSpace, out.data.data() + out.levels[i].offset);
+        std::swap(current, next);
+    }
+}
+
+int MipGenerator::CompareWithBaseline(const unsigned char* pixels, int width, int height, int channels)
+{
+    MipSettings settings;
+    settings.filter = MipFilter::Box;
+    settings.colorSpace = MipColorSpace::Linear;
+    settings.wrap = false;
+
+    FloatImage source, level;
+    decode(pixels, width, height, channels, settings.colorSpace, source);
+    downsample(source, settings, level);
+    std::vector<unsigned char> ours(size_t(level.width) * level.height * channels);
+    encode(level, channels, settings.colorSpace, ours.data());
+
+    std::vector<unsigned char> baseline(ours.size());
+    mipmap_image(pixels, width, height, channels, baseline.data(), 2, 2);
+
+    int worst = 0;
+    for (size_t i = 0; i < ours.size(); i++)
+        worst = std::max(worst, std::abs(int(ours[i]) - int(baseline[i])));
+    return worst;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct TextureImage;
+
+enum class MipFilter {
+    Box,
+    Kaiser
+};
+
+// How texel values are interpreted while filtering.
+enum class MipColorSpace {
+    Linear,
+    sRGB,   // decoded to linear light before filtering, alpha stays linear
+    Normal  // xyz in [-1, 1], renormalized after every level
+};
+
+struct MipSettings {
+    MipFilter filter = MipFilter::Kaiser;
+    MipColorSpace colorSpace = MipColorSpace::sRGB;
+    bool wrap = true; // GL_REPEAT textures filter across their edges
+};
+
+// CPU mip chain builder. Levels are filtered in float from the previous float
+// level, so rounding doesn't accumulate down the chain. Rows are split across
+// the ThreadPool and each texel is processed as one SSE vector (two per AVX2
+// vector on CPUs that have it, see MipKernelsAVX2), with a scalar path for
+// other targets.
+class MipGenerator
+{
+public:
+    // Fills `out` with the full chain down to 1x1 as tightly packed 8-bit
+    // texels of the source channel count. `out.compression` is left as None.
+    static void Build(const unsigned char* pixels, int width, int height, int channels, const MipSettings& settings,
+                      TextureImage& out);
+
+    // Largest per-channel difference between a linear box-filtered level 1
+    // and image_helper's mipmap_image on the same input.
+    static int CompareWithBaseline(const unsigned char* pixels, int width, int height, int channels);
+};
@@ -0,0 +1,80 @@
+#include "MipKernelsAVX2.h"
+
+// Nothing here may be an inline function shared with other translation units
+// (no std:: algorithms or templates): the linker keeps one copy of those, and
+// it could be this AVX2 one, called on CPUs without it.
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace
+{
+    int address(int i, int size, bool wrap)
+    {
+        if (wrap) return ((i % size) + size) % size;
+        return i < 0 ? 0 : (i >= size ? size - 1 : i);
+    }
+}
+
+int MipKernelsAVX2::BoxRow(const float* r0, const float* r1, int srcWidth, float* dst, int dstWidth)
+{
+    // Two destination texels per iteration while all four source texels exist.
+    // Sums pair up as in the SSE loop, so both give the same bits.
+    const __m256 quarter = _mm256_set1_ps(0.25f);
+    int x = 0;
+    for (; x + 1 < dstWidth && 2 * x + 3 < srcWidth; x += 2)
+    {
+        __m256 a0 = _mm256_loadu_ps(r0 + 8 * x), b0 = _mm256_loadu_ps(r0 + 8 * x + 8);
+        __m256 a1 = _mm256_loadu_ps(r1 + 8 * x), b1 = _mm256_loadu_ps(r1 + 8 * x + 8);
+        __m256 top = _mm256_add_ps(_mm256_permute2f128_ps(a0, b0, 0x20), _mm256_permute2f128_ps(a0, b0, 0x31));
+        __m256 bottom = _mm256_add_ps(_mm256_permute2f128_ps(a1, b1, 0x20), _mm256_permute2f128_ps(a1, b1, 0x31));
+        _mm256_storeu_ps(dst + 4 * x, _mm256_mul_ps(_mm256_add_ps(top, bottom), quarter));
+    }
+    return x;
+}
+
+int MipKernelsAVX2::KaiserRow(const float* src, int srcWidth, float* dst, int dstWidth, const float* w, bool wrap)
+{
+    int x = 0;
+    for (; x + 1 < dstWidth; x += 2)
+    {
+        __m256 acc = _mm256_setzero_ps();
+        for (int k = 0; k < KaiserTaps; k++)
+        {
+            const float* a = src + address(2 * x - 3 + k, srcWidth, wrap) * 4;
+            const float* b = src + address(2 * x - 1 + k, srcWidth, wrap) * 4;
+            __m256 texels = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(a)), _mm_loadu_ps(b), 1);
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(w[k]), texels));
+        }
+        _mm256_storeu_ps(dst + 4 * x, acc);
+    }
+    return x;
+}
+
+size_t MipKernelsAVX2::KaiserColumn(const float* const* rows, float* dst, size_t count, const float* w)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 acc = _mm256_setzero_ps();
+        for (int k = 0; k < KaiserTaps; k++)
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(w[k]), _mm256_loadu_ps(rows[k] + i)));
+        _mm256_storeu_ps(dst + i, acc);
+    }
+    return i;
+}
+#else
+int MipKernelsAVX2::BoxRow(const float*, const float*, int, float*, int)
+{
+    return 0;
+}
+
+int MipKernelsAVX2::KaiserRow(const float*, int, float*, int, const float*, bool)
+{
+    return 0;
+}
+
+size_t MipKernelsAVX2::KaiserColumn(const float* const*, float*, size_t, const float*)
+{
+    return 0;
+}
+#endif
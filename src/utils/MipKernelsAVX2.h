@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+
+// AVX2 versions of MipGenerator's inner loops, two texels per vector. This
+// pair is the only code built with AVX2 enabled (see CMakeLists.txt), so the
+// rest of the program still runs on any x86-64; MipGenerator calls these only
+// when Supported(). Each one filters a prefix of its range and returns where
+// the SSE/scalar loop carries on. Builds without AVX2 get stubs returning 0.
+class MipKernelsAVX2
+{
+public:
+    static constexpr int KaiserTaps = 8;
+
+    // Whether the CPU and OS support AVX2. Defined in MipGenerator.cpp, which
+    // is not compiled for AVX2.
+    static bool Supported();
+
+    static int BoxRow(const float* r0, const float* r1, int srcWidth, float* dst, int dstWidth);
+    static int KaiserRow(const float* src, int srcWidth, float* dst, int dstWidth, const float* w, bool wrap);
+    static size_t KaiserColumn(const float* const* rows, float* dst, size_t count, const float* w);
+};
@@ -1,19 +1,15 @@
 #include "Model.h"
-#include "stb_image.h"
-
-#include <filesystem>
-#include <iostream>
 
 Model::Model(std::string const& path, const char* vsPath, const char* fsPath, bool gamma)
-    : gammaCorrection(gamma)
+    : Model(Geometry::Load(path), vsPath, fsPath, gamma)
 {
-    modelShader = new Shader(vsPath, fsPath);
-    loadModel(path);
 }
 
-Model::~Model()
+Model::Model(std::shared_ptr<Geometry> sharedGeometry, const char* vsPath, const char* fsPath, bool gamma)
+    : geometry(std::move(sharedGeometry)), material(std::make_shared<Material>(vsPath, fsPath)),
+      meshes(geometry->meshes), gammaCorrection(gamma)
 {
-    if (modelShader) delete modelShader;
+    modelShader = material->shader;
 }
 
 void Model::Draw(glm::mat4 model, glm::mat4 view, glm::mat4 projection)
@@ -25,306 +21,17 @@ void Model::Draw(glm::mat4 model, glm::mat4 view, glm::mat4 projection)
     modelShader->setMat4("view", view);
     modelShader->setMat4("model", model);
 
-    for (unsigned int i = 0; i < meshes.size(); i++)
-        meshes[i].Draw(*modelShader);
+    geometry->Draw(*modelShader, material->textures, &model);
 }
 
 void Model::AddTexture(std::string const& path, std::string typeName)
 {
-    unsigned int id = TextureFromFileAbsolutePath(path.c_str());
-    if (id == 0)
-    {
-        std::cout << "Failed to manually load texture: " << path << std::endl;
-        return;
-    }
-
-    Texture texture;
-    texture.id = id;
-    texture.type = typeName;
-    texture.path = path;
-
-    textures_loaded.push_back(texture);
-
-    for (unsigned int i = 0; i < meshes.size(); i++)
-    {
-        meshes[i].textures.push_back(texture);
-    }
+    material->AddTexture(path, typeName);
+    if (typeName == "texture_normal") geometry->RequireTangents();
 }
 
-
 void Model::AddTexture(int textureId, std::string typeName)
 {
-    Texture texture;
-    texture.id = (unsigned int)textureId;
-    texture.type = typeName;
-    texture.path = "procedural_custom_" + std::to_string(textureId);
-
-    textures_loaded.push_back(texture);
-
-    for (unsigned int i = 0; i < meshes.size(); i++)
-    {
-        meshes[i].textures.push_back(texture);
-    }
-}
-
-void Model::loadModel(std::string const& path)
-{
-    Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(
-        path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
-
-    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
-    {
-        std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
-        return;
-    }
-
-    scene_ptr = scene;
-    directory = std::filesystem::path(path).parent_path().string();
-
-    processNode(scene->mRootNode, scene);
-    scene_ptr = nullptr;
-}
-
-void Model::processNode(aiNode* node, const aiScene* scene)
-{
-    for (unsigned int i = 0; i < node->mNumMeshes; i++)
-    {
-        aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-        meshes.push_back(processMesh(mesh, scene));
-    }
-    for (unsigned int i = 0; i < node->mNumChildren; i++)
-    {
-        processNode(node->mChildren[i], scene);
-    }
-}
-
-Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
-{
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-    std::vector<Texture> textures;
-
-    // 1. Vertices
-    for (unsigned int i = 0; i < mesh->mNumVertices; i++)
-    {
-        Vertex vertex;
-        glm::vec3 vector;
-
-        vector.x = mesh->mVertices[i].x;
-        vector.y = mesh->mVertices[i].y;
-        vector.z = mesh->mVertices[i].z;
-        vertex.Position = vector;
-
-        if (mesh->HasNormals())
-        {
-            vector.x = mesh->mNormals[i].x;
-            vector.y = mesh->mNormals[i].y;
-            vector.z = mesh->mNormals[i].z;
-            vertex.Normal = vector;
-        }
-
-        if (mesh->mTextureCoords[0])
-        {
-            glm::vec2 vec;
-            vec.x = mesh->mTextureCoords[0][i].x;
-            vec.y = mesh->mTextureCoords[0][i].y;
-            vertex.TexCoords = vec;
-
-            if (mesh->HasTangentsAndBitangents())
-            {
-                vector.x = mesh->mTangents[i].x;
-                vector.y = mesh->mTangents[i].y;
-                vector.z = mesh->mTangents[i].z;
-                vertex.Tangent = vector;
-
-                vector.x = mesh->mBitangents[i].x;
-                vector.y = mesh->mBitangents[i].y;
-                vector.z = mesh->mBitangents[i].z;
-                vertex.Bitangent = vector;
-            }
-        }
-        else
-            vertex.TexCoords = glm::vec2(0.0f, 0.0f);
-
-        vertices.push_back(vertex);
-    }
-
-    // 2. Indices
-    for (unsigned int i = 0; i < mesh->mNumFaces; i++)
-    {
-        aiFace face = mesh->mFaces[i];
-        for (unsigned int j = 0; j < face.mNumIndices; j++)
-            indices.push_back(face.mIndices[j]);
-    }
-
-    // 3. Material Textures
-    aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-
-    std::vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-    textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-
-    std::vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-    textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
-
-    std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
-    textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
-
-    std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
-    textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
-
-    return Mesh(vertices, indices, textures);
-}
-
-std::vector<Texture> Model::loadMaterialTextures(aiMaterial* mat, aiTextureType type, std::string typeName)
-{
-    std::vector<Texture> textures;
-    for (unsigned int i = 0; i < mat->GetTextureCount(type); i++)
-    {
-        aiString str;
-        mat->GetTexture(type, i, &str);
-
-        bool skip = false;
-        for (unsigned int j = 0; j < textures_loaded.size(); j++)
-        {
-            if (std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-            {
-                textures.push_back(textures_loaded[j]);
-                skip = true;
-                break;
-            }
-        }
-
-        if (!skip)
-        {
-            Texture texture;
-            const aiTexture* embeddedTex = scene_ptr->GetEmbeddedTexture(str.C_Str());
-
-            if (embeddedTex)
-            {
-                texture.id = TextureFromMemory(embeddedTex);
-            }
-            else
-            {
-                texture.id = TextureFromFile(str.C_Str(), this->directory);
-            }
-
-            texture.type = typeName;
-            texture.path = str.C_Str();
-            textures.push_back(texture);
-            textures_loaded.push_back(texture);
-        }
-    }
-    return textures;
-}
-
-unsigned int Model::TextureFromMemory(const aiTexture* aiTex)
-{
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char* data = nullptr;
-
-    if (aiTex->mHeight == 0)
-        data = stbi_load_from_memory(reinterpret_cast<unsigned char*>(aiTex->pcData), aiTex->mWidth, &width, &height,
-                                     &nrComponents, 0);
-    else
-        data = stbi_load_from_memory(reinterpret_cast<unsigned char*>(aiTex->pcData), aiTex->mWidth * aiTex->mHeight,
-                                     &width, &height, &nrComponents, 0);
-
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1) format = GL_RED;
-        else if (nrComponents == 3) format = GL_RGB;
-        else if (nrComponents == 4) format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load from embedded memory" << std::endl;
-    }
-    return textureID;
-}
-
-unsigned int Model::TextureFromFile(const char* path, const std::string& directory)
-{
-    std::filesystem::path fullPath = std::filesystem::path(directory) / path;
-    std::string filename = fullPath.string();
-
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1) format = GL_RED;
-        else if (nrComponents == 3) format = GL_RGB;
-        else if (nrComponents == 4) format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << filename << std::endl;
-        stbi_image_free(data);
-    }
-    return textureID;
-}
-
-unsigned int Model::TextureFromFileAbsolutePath(const char* path)
-{
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    // stbi_load
-    unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1) format = GL_RED;
-        else if (nrComponents == 3) format = GL_RGB;
-        else if (nrComponents == 4) format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-        return 0;
-    }
-    return textureID;
+    material->AddTexture(textureId, typeName);
+    if (typeName == "texture_normal") geometry->RequireTangents();
 }
@@ -6,46 +6,37 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
-
+#include "Geometry.h"
+#include "Material.h"
 #include "Mesh.h"
 #include "Shader.h"
 #include "RenderTypes.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 
+// Convenience pairing of one shared Geometry with its own Material.
 class Model
 {
 public:
-    std::vector<Texture> textures_loaded;
-    std::vector<Mesh>    meshes;
-    std::string directory;
+    std::shared_ptr<Geometry> geometry;
+    std::shared_ptr<Material> material;
+    // Shared with every other Model drawing the same file.
+    std::vector<Mesh>& meshes;
     bool gammaCorrection;
 
     Shader* modelShader;
 
     Model(std::string const &path, const char* vsPath, const char* fsPath, bool gamma = false);
-    ~Model();
+    Model(std::shared_ptr<Geometry> sharedGeometry, const char* vsPath, const char* fsPath, bool gamma = false);
 
     void Draw(glm::mat4 model, glm::mat4 view, glm::mat4 projection);
 
+    // Per-model textures live on the Material, so they never leak into other
+    // users of the same geometry.
     void AddTexture(std::string const &path, std::string typeName);
 
     void AddTexture(int textureId, std::string typeName);
-
-private:
-    const aiScene* scene_ptr;
-
-    void loadModel(std::string const &path);
-    void processNode(aiNode *node, const aiScene *scene);
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene);
-    std::vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName);
-    
-    unsigned int TextureFromMemory(const aiTexture* aiTex);
-    unsigned int TextureFromFile(const char *path, const std::string &directory);
-    unsigned int TextureFromFileAbsolutePath(const char *path);
 };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,531 @@
+#include "ObjLoader.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <unordered_map>
+
+namespace
+{
+    // Chunks are about this size; smaller files are parsed in one piece.
+    constexpr size_t ChunkBytes = 1 << 19;
+    constexpr int32_t MissingIndex = INT32_MIN;
+
+    // One face corner. Negative (relative) OBJ indices are resolved against
+    // the chunk's own element counts first and rebased once every chunk's
+    // counts are known; `relative` marks which of v/t/n still need that.
+    struct Corner {
+        int32_t v, t, n;
+        uint32_t relative;
+    };
+
+    enum class EventType { Object, Material };
+
+    // `o`/`g`/`usemtl`, applied before the chunk's face number `face`.
+    struct Event {
+        size_t face;
+        EventType type;
+        std::string name;
+    };
+
+    struct Chunk {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+
+        std::vector<float> positions; // xyz
+        std::vector<float> texcoords; // uv
+        std::vector<float> normals;   // xyz
+        std::vector<Corner> corners;
+        std::vector<uint32_t> faceStarts; // into corners, plus a final end marker
+        std::vector<Event> events;
+        std::vector<std::string> libraries;
+
+        size_t positionBase = 0, texcoordBase = 0, normalBase = 0;
+    };
+
+    // Face runs of one output mesh, possibly spread over several chunks.
+    struct Range {
+        size_t chunk;
+        size_t firstFace, lastFace;
+    };
+
+    struct Segment {
+        std::string material;
+        std::vector<Range> ranges;
+        size_t faces = 0;
+    };
+
+    inline bool isSpace(char c) { return c == ' ' || c == '\t'; }
+    inline bool isDigit(char c) { return static_cast<unsigned char>(c - '0') < 10; }
+
+    inline const char* skipSpace(const char* p, const char* end)
+    {
+        while (p < end && isSpace(*p)) p++;
+        return p;
+    }
+
+    inline const char* skipLine(const char* p, const char* end)
+    {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+        return newline ? newline + 1 : end;
+    }
+
+    // strtof without locale lookups or a terminating zero. Mantissas longer
+    // than 17 digits are truncated, which is well below float precision.
+    const char* parseFloat(const char* p, const char* end, float& out)
+    {
+        static const double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        const char* start = p = skipSpace(p, end);
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+
+        uint64_t mantissa = 0;
+        int exponent = 0;
+        bool digits = false;
+        for (; p < end && isDigit(*p); p++, digits = true)
+        {
+            if (mantissa < 100000000000000000ull) mantissa = mantissa * 10 + uint64_t(*p - '0');
+            else exponent++;
+        }
+        if (p < end && *p == '.')
+        {
+            for (p++; p < end && isDigit(*p); p++, digits = true)
+            {
+                if (mantissa < 100000000000000000ull)
+                {
+                    mantissa = mantissa * 10 + uint64_t(*p - '0');
+                    exponent--;
+                }
+            }
+        }
+        if (!digits) return start;
+
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            const char* q = p + 1;
+            bool negativeExponent = false;
+            if (q < end && (*q == '-' || *q == '+')) negativeExponent = *q++ == '-';
+            if (q < end && isDigit(*q))
+            {
+                int e = 0;
+                for (; q < end && isDigit(*q); q++)
+                    if (e < 10000) e = e * 10 + (*q - '0');
+                exponent += negativeExponent ? -e : e;
+                p = q;
+            }
+        }
+
+        double value = double(mantissa);
+        if (exponent < 0)
+            value = exponent >= -22 ? value / powers[-exponent] : value * std::pow(10.0, exponent);
+        else if (exponent > 0)
+            value = exponent <= 22 ? value * powers[exponent] : value * std::pow(10.0, exponent);
+        out = static_cast<float>(negative ? -value : value);
+        return p;
+    }
+
+    const char* parseInt(const char* p, const char* end, int32_t& out)
+    {
+        const char* start = p;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+        if (p >= end || !isDigit(*p)) return start;
+        int64_t value = 0;
+        for (; p < end && isDigit(*p); p++)
+            if (value <= INT32_MAX) value = value * 10 + (*p - '0');
+        value = std::min<int64_t>(value, INT32_MAX);
+        out = static_cast<int32_t>(negative ? -value : value);
+        return p;
+    }
+
+    // Rest of the line without surrounding blanks or a trailing comment.
+    std::string lineArgument(const char* p, const char* end)
+    {
+        p = skipSpace(p, end);
+        const char* last = p;
+        while (last < end && *last != '\n' && *last != '\r' && *last != '#') last++;
+        while (last > p && isSpace(last[-1])) last--;
+        return std::string(p, last);
+    }
+
+    // 1-based indices are made 0-based; negative ones are kept relative to
+    // `count` (the elements this chunk has seen so far) and flagged.
+    inline void setIndex(int32_t value, size_t count, uint32_t flag, int32_t& index, uint32_t& relative)
+    {
+        if (value > 0)
+        {
+            index = value - 1;
+        }
+        else if (value < 0)
+        {
+            index = static_cast<int32_t>(count) + value;
+            relative |= flag;
+        }
+    }
+
+    const char* parseFace(const char* p, const char* end, Chunk& chunk)
+    {
+        const size_t start = chunk.corners.size();
+        const size_t positions = chunk.positions.size() / 3;
+        const size_t texcoords = chunk.texcoords.size() / 2;
+        const size_t normals = chunk.normals.size() / 3;
+        for (;;)
+        {
+            p = skipSpace(p, end);
+            int32_t value = 0;
+            const char* next = parseInt(p, end, value);
+            if (next == p) break;
+            p = next;
+
+            Corner corner{MissingIndex, MissingIndex, MissingIndex, 0};
+            setIndex(value, positions, 1, corner.v, corner.relative);
+            if (p < end && *p == '/')
+            {
+                next = parseInt(++p, end, value);
+                if (next != p) setIndex(value, texcoords, 2, corner.t, corner.relative);
+                p = next;
+                if (p < end && *p == '/')
+                {
+                    next = parseInt(++p, end, value);
+                    if (next != p) setIndex(value, normals, 4, corner.n, corner.relative);
+                    p = next;
+                }
+            }
+            chunk.corners.push_back(corner);
+        }
+
+        if (chunk.corners.size() - start >= 3)
+            chunk.faceStarts.push_back(static_cast<uint32_t>(start));
+        else
+            chunk.corners.resize(start); // points and lines are not drawn
+        return p;
+    }
+
+    void parseChunk(Chunk& chunk)
+    {
+        const char* p = chunk.begin;
+        const char* end = chunk.end;
+        auto keyword = [&p, end](const char* word, size_t length) {
+            return size_t(end - p) > length && std::memcmp(p, word, length) == 0 && isSpace(p[length]);
+        };
+
+        while (p < end)
+        {
+            p = skipSpace(p, end);
+            if (p >= end) break;
+
+            float x = 0.0f, y = 0.0f, z = 0.0f;
+            if (keyword("v", 1))
+            {
+                p = parseFloat(parseFloat(parseFloat(p + 1, end, x), end, y), end, z);
+                chunk.positions.insert(chunk.positions.end(), {x, y, z});
+            }
+            else if (keyword("vn", 2))
+            {
+                p = parseFloat(parseFloat(parseFloat(p + 2, end, x), end, y), end, z);
+                chunk.normals.insert(chunk.normals.end(), {x, y, z});
+            }
+            else if (keyword("vt", 2))
+            {
+                p = parseFloat(parseFloat(p + 2, end, x), end, y);
+                chunk.texcoords.insert(chunk.texcoords.end(), {x, y});
+            }
+            else if (keyword("f", 1))
+            {
+                p = parseFace(p + 1, end, chunk);
+            }
+            else if (keyword("o", 1) || keyword("g", 1))
+            {
+                chunk.events.push_back({chunk.faceStarts.size(), EventType::Object, lineArgument(p + 1, end)});
+            }
+            else if (keyword("usemtl", 6))
+            {
+                chunk.events.push_back({chunk.faceStarts.size(), EventType::Material, lineArgument(p + 6, end)});
+            }
+            else if (keyword("mtllib", 6))
+            {
+                chunk.libraries.push_back(lineArgument(p + 6, end));
+            }
+            p = skipLine(p, end);
+        }
+        chunk.faceStarts.push_back(static_cast<uint32_t>(chunk.corners.size()));
+    }
+
+    // Texture maps Geometry's Assimp path reads, keyed by material name.
+    void loadMaterialLibrary(const std::filesystem::path& path,
+                             std::unordered_map<std::string, std::vector<ObjLoader::Texture>>& materials)
+    {
+        MappedFile source(path.string());
+        if (!source.IsOpen()) return;
+        std::istringstream file(std::string(reinterpret_cast<const char*>(source.Data()), source.Size()));
+
+        std::vector<ObjLoader::Texture>* current = nullptr;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::istringstream stream(line);
+            std::string key;
+            stream >> key;
+            if (key == "newmtl")
+            {
+                std::string name = lineArgument(line.data() + 6 + line.find("newmtl"), line.data() + line.size());
+                current = &materials[name];
+                continue;
+            }
+            if (!current) continue;
+
+            const char* type = nullptr;
+            if (key == "map_Kd") type = "texture_diffuse";
+            else if (key == "map_Ks") type = "texture_specular";
+            else if (key == "map_Bump" || key == "map_bump" || key == "bump") type = "texture_normal";
+            else if (key == "map_Ka") type = "texture_height";
+            if (!type) continue;
+
+            // Options such as -bm 1.0 come first; the file name is last.
+            std::string token, file;
+            while (stream >> token) file = token;
+            if (!file.empty()) current->push_back({type, file});
+        }
+    }
+
+    void buildMesh(const Segment& segment, const std::vector<Chunk>& chunks, const std::vector<glm::vec3>& positions,
+                   const std::vector<glm::vec2>& texcoords, const std::vector<glm::vec3>& normals, MeshData& out)
+    {
+        // Open addressing over (v, t, n); sized for the worst case of one
+        // vertex per corner.
+        size_t cornerCount = 0;
+        for (const Range& range : segment.ranges)
+        {
+            const Chunk& chunk = chunks[range.chunk];
+            cornerCount += chunk.faceStarts[range.lastFace] - chunk.faceStarts[range.firstFace];
+        }
+        size_t capacity = 16;
+        while (capacity < cornerCount * 2) capacity *= 2;
+        std::vector<uint32_t> table(capacity, UINT32_MAX);
+        std::vector<Corner> unique;
+        unique.reserve(cornerCount / 2);
+
+        auto vertexFor = [&](const Corner& c) {
+            uint32_t h = (uint32_t(c.v) * 73856093u) ^ (uint32_t(c.t) * 19349663u) ^ (uint32_t(c.n) * 83492791u);
+            for (size_t slot = h & (capacity - 1);; slot = (slot + 1) & (capacity - 1))
+            {
+                uint32_t id = table[slot];
+                if (id == UINT32_MAX)
+                {
+                    table[slot] = static_cast<uint32_t>(unique.size());
+                    unique.push_back(c);
+                    return table[slot];
+                }
+                const Corner& u = unique[id];
+                if (u.v == c.v && u.t == c.t && u.n == c.n) return id;
+            }
+        };
+
+        out.indices.reserve(segment.faces * 3);
+        const int32_t positionCount = static_cast<int32_t>(positions.size());
+        const int32_t texcoordCount = static_cast<int32_t>(texcoords.size());
+        const int32_t normalCount = static_cast<int32_t>(normals.size());
+        std::vector<uint32_t> face;
+        for (const Range& range : segment.ranges)
+        {
+            const Chunk& chunk = chunks[range.chunk];
+            for (size_t f = range.firstFace; f < range.lastFace; f++)
+            {
+                face.clear();
+                bool valid = true;
+                for (uint32_t i = chunk.faceStarts[f]; i < chunk.faceStarts[f + 1] && valid; i++)
+                {
+                    Corner c = chunk.corners[i];
+                    valid = c.v >= 0 && c.v < positionCount;
+                    if (c.t < 0 || c.t >= texcoordCount) c.t = MissingIndex;
+                    if (c.n < 0 || c.n >= normalCount) c.n = MissingIndex;
+                    c.relative = 0;
+                    face.push_back(vertexFor(c));
+                }
+                if (!valid) continue;
+
+                // Fan triangulation, as Assimp does for convex polygons.
+                for (size_t i = 2; i < face.size(); i++)
+                    out.indices.insert(out.indices.end(), {face[0], face[i - 1], face[i]});
+            }
+        }
+
+        bool missingNormals = false, hasTexCoords = false;
+        out.vertices.resize(unique.size());
+        for (size_t i = 0; i < unique.size(); i++)
+        {
+            const Corner& c = unique[i];
+            Vertex& vertex = out.vertices[i];
+            vertex = Vertex{};
+            vertex.Position = positions[c.v];
+            if (c.n != MissingIndex) vertex.Normal = normals[c.n];
+            else missingNormals = true;
+            if (c.t != MissingIndex)
+            {
+                vertex.TexCoords = texcoords[c.t];
+                hasTexCoords = true;
+            }
+        }
+
+        // Smooth normals for corners without one, shared by every vertex on
+        // the same position like aiProcess_GenSmoothNormals.
+        if (missingNormals)
+        {
+            std::unordered_map<int32_t, glm::vec3> sums;
+            for (size_t i = 0; i + 2 < out.indices.size(); i += 3)
+            {
+                const unsigned int* tri = &out.indices[i];
+                glm::vec3 n = glm::cross(out.vertices[tri[1]].Position - out.vertices[tri[0]].Position,
+                                         out.vertices[tri[2]].Position - out.vertices[tri[0]].Position);
+                for (int k = 0; k < 3; k++)
+                    if (unique[tri[k]].n == MissingIndex) sums[unique[tri[k]].v] += n;
+            }
+            for (size_t i = 0; i < unique.size(); i++)
+            {
+                if (unique[i].n != MissingIndex) continue;
+                glm::vec3 n = sums[unique[i].v];
+                float length = glm::length(n);
+                out.vertices[i].Normal = length > 0.0f ? n / length : glm::vec3(0.0f);
+            }
+        }
+
+        // Flipped like aiProcess_FlipUVs does. Tangents come later, from
+        // Geometry, and only for meshes that get a normal map.
+        if (hasTexCoords)
+        {
+            for (Vertex& vertex : out.vertices)
+                vertex.TexCoords.y = 1.0f - vertex.TexCoords.y;
+        }
+    }
+}
+
+bool ObjLoader::Load(const std::string& path, std::vector<Mesh>& out, Stats* stats)
+{
+    out.clear();
+    auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [](std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    };
+
+    MappedFile file(path);
+    if (!file.IsOpen()) return false;
+    const char* data = reinterpret_cast<const char*>(file.Data());
+    const char* end = data + file.Size();
+
+    // 1. Line-aligned chunks, parsed independently.
+    size_t chunkCount = std::max<size_t>(1, file.Size() / ChunkBytes);
+    std::vector<Chunk> chunks(chunkCount);
+    const char* cursor = data;
+    for (size_t i = 0; i < chunkCount; i++)
+    {
+        chunks[i].begin = cursor;
+        cursor = i + 1 == chunkCount ? end : std::max(cursor, skipLine(data + file.Size() * (i + 1) / chunkCount, end));
+        chunks[i].end = cursor;
+    }
+    ThreadPool& pool = ThreadPool::Get();
+    pool.ParallelFor(chunkCount, 1, [&chunks](size_t begin, size_t last) {
+        for (size_t i = begin; i < last; i++) parseChunk(chunks[i]);
+    });
+
+    // 2. Global element arrays; relative indices get their chunk's base.
+    size_t positionCount = 0, texcoordCount = 0, normalCount = 0;
+    for (Chunk& chunk : chunks)
+    {
+        chunk.positionBase = positionCount;
+        chunk.texcoordBase = texcoordCount;
+        chunk.normalBase = normalCount;
+        positionCount += chunk.positions.size() / 3;
+        texcoordCount += chunk.texcoords.size() / 2;
+        normalCount += chunk.normals.size() / 3;
+    }
+    std::vector<glm::vec3> positions(positionCount), normals(normalCount);
+    std::vector<glm::vec2> texcoords(texcoordCount);
+    pool.ParallelFor(chunkCount, 1, [&](size_t begin, size_t last) {
+        for (size_t i = begin; i < last; i++)
+        {
+            Chunk& chunk = chunks[i];
+            std::memcpy(positions.data() + chunk.positionBase, chunk.positions.data(), chunk.positions.size() * 4);
+            std::memcpy(texcoords.data() + chunk.texcoordBase, chunk.texcoords.data(), chunk.texcoords.size() * 4);
+            std::memcpy(normals.data() + chunk.normalBase, chunk.normals.data(), chunk.normals.size() * 4);
+            for (Corner& c : chunk.corners)
+            {
+                if (c.relative & 1) c.v += static_cast<int32_t>(chunk.positionBase);
+                if (c.relative & 2) c.t += static_cast<int32_t>(chunk.texcoordBase);
+                if (c.relative & 4) c.n += static_cast<int32_t>(chunk.normalBase);
+            }
+            std::vector<float>().swap(chunk.positions);
+            std::vector<float>().swap(chunk.texcoords);
+            std::vector<float>().swap(chunk.normals);
+        }
+    });
+
+    // 3. Split the face stream into meshes at o/g/usemtl.
+    std::vector<Segment> segments(1);
+    std::vector<std::string> libraries;
+    size_t faceCount = 0;
+    for (size_t c = 0; c < chunkCount; c++)
+    {
+        const Chunk& chunk = chunks[c];
+        libraries.insert(libraries.end(), chunk.libraries.begin(), chunk.libraries.end());
+        const size_t faces = chunk.faceStarts.size() - 1;
+        faceCount += faces;
+
+        size_t face = 0;
+        auto addFaces = [&segments, c, &face](size_t until) {
+            if (until > face)
+            {
+                segments.back().ranges.push_back({c, face, until});
+                segments.back().faces += until - face;
+            }
+            face = until;
+        };
+        for (const Event& event : chunk.events)
+        {
+            addFaces(event.face);
+            if (segments.back().faces > 0) segments.push_back({segments.back().material, {}, 0});
+            if (event.type == EventType::Material) segments.back().material = event.name;
+        }
+        addFaces(faces);
+    }
+    if (segments.back().faces == 0) segments.pop_back();
+    if (stats)
+    {
+        stats->bytes = file.Size();
+        stats->chunks = chunkCount;
+        stats->positions = positionCount;
+        stats->faces = faceCount;
+        stats->parseMs = elapsedMs(start);
+    }
+    if (segments.empty()) return false;
+
+    // 4. Vertices and indices per mesh.
+    auto buildStart = std::chrono::steady_clock::now();
+    out.resize(segments.size());
+    pool.ParallelFor(segments.size(), 1, [&](size_t begin, size_t last) {
+        for (size_t i = begin; i < last; i++)
+            buildMesh(segments[i], chunks, positions, texcoords, normals, out[i].data);
+    });
+
+    std::unordered_map<std::string, std::vector<Texture>> materials;
+    std::unordered_map<std::string, unsigned int> materialIndices;
+    const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    for (const std::string& library : libraries)
+        loadMaterialLibrary(directory / library, materials);
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        auto index = materialIndices.emplace(segments[i].material, static_cast<unsigned int>(materialIndices.size()));
+        out[i].data.materialIndex = index.first->second;
+        auto material = materials.find(segments[i].material);
+        if (material != materials.end()) out[i].textures = material->second;
+    }
+    if (stats) stats->buildMs = elapsedMs(buildStart);
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "RenderTypes.h"
+
+// Wavefront OBJ reader that skips Assimp. The file is memory mapped, cut into
+// line-aligned chunks that are parsed in parallel, and the face corners are
+// deduplicated straight into Vertex/index streams. The output matches what
+// Geometry gets from Assimp with its import flags: triangulated, smooth
+// normals where the file has none and flipped UVs. Tangents are left to
+// Geometry, which generates them only for meshes that get a normal map.
+class ObjLoader
+{
+public:
+    struct Texture {
+        std::string type; // texture_diffuse, texture_specular, texture_normal, texture_height
+        std::string path; // as written in the .mtl, relative to the model directory
+    };
+
+    struct Mesh {
+        MeshData data;
+        std::vector<Texture> textures;
+    };
+
+    // Parse statistics for logging and benchmarks.
+    struct Stats {
+        size_t bytes = 0;
+        size_t chunks = 0;
+        size_t positions = 0;
+        size_t faces = 0;
+        double parseMs = 0.0; // chunk parsing, index resolve and merge
+        double buildMs = 0.0; // vertex dedupe and normals
+    };
+
+    // One mesh per `o`/`g`/`usemtl` run that has faces. Returns false if the
+    // file cannot be read or contains no faces.
+    static bool Load(const std::string& path, std::vector<Mesh>& out, Stats* stats = nullptr);
+};
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 struct Vertex {
     glm::vec3 Position;
@@ -13,8 +15,56 @@ struct Vertex {
     float m_Weights[4];
 };
 
+// GPU layout Mesh packs its vertices into; Vertex stays the CPU/cache format.
+// Attribute locations are unchanged (0 position, 1 normal, 2 uv, 3 tangent),
+// and the tangent is a vec4 whose w is the bitangent handedness.
+struct VertexFormat {
+    bool halfTexCoords = true;       // GL_HALF_FLOAT x2
+    bool packedNormals = true;       // normal and tangent as GL_INT_2_10_10_10_REV
+    bool tangents = true;            // false drops attribute 3 entirely
+    bool quantizedPositions = false; // GL_SHORT x4, dequantized through the model matrix
+
+    unsigned int Stride() const
+    {
+        unsigned int normal = packedNormals ? 4 : 12;
+        unsigned int tangent = tangents ? (packedNormals ? 4 : 16) : 0;
+        return (quantizedPositions ? 8 : 12) + normal + (halfTexCoords ? 4 : 8) + tangent;
+    }
+};
+
+// A run of at most 124 triangles (64 unique vertices) in a mesh's index buffer,
+// with bounds for CPU cluster culling. Meshlets tile the index buffer in order.
+struct Meshlet {
+    uint32_t indexOffset;
+    uint32_t indexCount;
+    glm::vec3 center;   // bounding sphere, mesh space
+    float radius;
+    glm::vec3 coneAxis; // average facing direction
+    // Back-facing from camera c when dot(center - c, coneAxis) >=
+    // coneCutoff * |center - c| + radius; 1 means never.
+    float coneCutoff;
+};
+
+// One level of detail: a range of the mesh's index buffer, all levels sharing
+// the vertex buffer. `error` is the geometric deviation from level 0 in mesh
+// units; level 0 has none.
+struct MeshLod {
+    uint32_t indexOffset;
+    uint32_t indexCount;
+    float error;
+};
+
 struct Texture {
     unsigned int id;
     std::string type;
     std::string path;
-};
\ No newline at end of file
+};
+
+// CPU-side result of importing one mesh, built off the GL thread.
+struct MeshData {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<Meshlet> meshlets; // level 0 only
+    std::vector<MeshLod> lods;     // empty: one level spanning `indices`
+    unsigned int materialIndex = 0;
+};
@@ -1,42 +1,122 @@
 #include "Renderer.h"
+#include "AssetLoader.h"
 #include "Model.h"
+#include "Geometry.h"
+#include "HotReload.h"
+#include "Material.h"
 #include "Camera.h"
 #include "Shader.h"
 #include "Skybox.h"
+#include "StreamingGeometry.h"
+#include "TextureLoader.h"
+#include "ThreadPool.h"
 #include <algorithm>
+#include <cstring>
+#include <unordered_map>
 
 struct RendererData {
     glm::mat4 viewMatrix;
     glm::mat4 projectionMatrix;
     glm::vec3 cameraPosition;
+    float fovY;
+    float viewportHeight = 1.0f;
     std::vector<RenderCommand> commandQueue;
 
     Skybox* activeSkybox = nullptr;
+    unsigned int environmentUBO = 0;
+    IrradianceSH uploadedIrradiance;
+    // Shader::ProgramSerial -> declares EnvironmentSH. Not keyed on the GL
+    // name: a reload deletes the old program and a later one may reuse it.
+    std::unordered_map<uint64_t, bool> environmentBlocks;
+
+    bool meshletCulling = true;
+    float lodThreshold = 1.0f;
+    std::vector<unsigned char> visibility; // one byte per meshlet of every command
+    RenderStats stats;
+};
+
+struct CullJob {
+    const Mesh* mesh;
+    const MeshletCullParams* params;
+    size_t begin, end;
+    unsigned char* visible;
 };
 
+// Meshlets per culling task; four per SIMD step.
+static const size_t kCullBatch = 512;
+// Uniform buffer binding of the EnvironmentSH block.
+static const unsigned int kEnvironmentBinding = 0;
+
 static RendererData s_Data;
 
+static const unsigned char* visibilityFor(const RenderCommand& cmd) {
+    return s_Data.meshletCulling ? s_Data.visibility.data() + cmd.visibilityOffset : nullptr;
+}
+
 void Renderer::Init() {
     glEnable(GL_DEPTH_TEST);
+    // Prefiltered environment levels are only a few texels wide; without this
+    // their face edges show as seams in glossy reflections.
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+    glGenBuffers(1, &s_Data.environmentUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, s_Data.environmentUBO);
+    s_Data.uploadedIrradiance = IrradianceSH();
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(IrradianceSH::coefficients), s_Data.uploadedIrradiance.coefficients,
+                 GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, kEnvironmentBinding, s_Data.environmentUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 void Renderer::Shutdown() {
     s_Data.commandQueue.clear();
     s_Data.activeSkybox = nullptr;
+    s_Data.environmentBlocks.clear();
+    glDeleteBuffers(1, &s_Data.environmentUBO);
+    s_Data.environmentUBO = 0;
+    HotReload::Stop();
+    AssetLoader::Shutdown();
+    TextureLoader::Shutdown();
 }
 
 void Renderer::BeginScene(const Camera& camera, float aspectRatio) {
+    // Meshes imported and textures decoded since the last frame are uploaded here.
+    AssetLoader::Update();
+    TextureLoader::Update();
+    // Edited shaders, textures and meshes swap in here, before anything is queued.
+    HotReload::Update();
+
     s_Data.viewMatrix = const_cast<Camera&>(camera).GetViewMatrix();
-    s_Data.projectionMatrix = glm::perspective(glm::radians(camera.Zoom), aspectRatio, 0.1f, 100.0f);
+    s_Data.fovY = glm::radians(camera.Zoom);
+    s_Data.projectionMatrix = glm::perspective(s_Data.fovY, aspectRatio, 0.1f, 100.0f);
     s_Data.cameraPosition = camera.Position;
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    s_Data.viewportHeight = static_cast<float>(std::max(viewport[3], 1));
 
     s_Data.commandQueue.clear();
     s_Data.activeSkybox = nullptr;
 }
 
 void Renderer::Submit(Model& model, const glm::mat4& modelMatrix, std::function<void(Shader*)> callback) {
+    Submit(*model.geometry, *model.material, modelMatrix, std::move(callback));
+}
+
+void Renderer::Submit(Geometry& geometry, Material& material, const glm::mat4& modelMatrix,
+                      std::function<void(Shader*)> callback) {
+    // Here rather than in Draw(): the reimport can change the meshlet count
+    // that culling sizes its visibility bytes by. A no-op once done.
+    if (std::any_of(material.textures.begin(), material.textures.end(),
+                    [](const Texture& texture) { return texture.type == "texture_normal"; }))
+        geometry.RequireTangents();
     float dist = glm::distance(s_Data.cameraPosition, glm::vec3(modelMatrix[3]));
-    s_Data.commandQueue.push_back({&model, modelMatrix, callback, dist});
+    s_Data.commandQueue.push_back({&geometry, &material, modelMatrix, std::move(callback), dist, 0, 0.0f});
+}
+
+void Renderer::Submit(StreamingGeometry& geometry, Material& material, const glm::mat4& modelMatrix,
+                      std::function<void(Shader*)> callback) {
+    float dist = glm::distance(s_Data.cameraPosition, glm::vec3(modelMatrix[3]));
+    s_Data.commandQueue.push_back({nullptr, &material, modelMatrix, std::move(callback), dist, 0, 0.0f, &geometry});
 }
 
 
@@ -44,17 +124,163 @@ void Renderer::SetSkybox(Skybox& skybox) {
     s_Data.activeSkybox = &skybox;
 }
 
+void Renderer::SetMeshletCulling(bool enabled) {
+    s_Data.meshletCulling = enabled;
+}
+
+const RenderStats& Renderer::GetStats() {
+    return s_Data.stats;
+}
+
+void Renderer::SetLodThreshold(float pixels) {
+    s_Data.lodThreshold = pixels;
+}
+
 void Renderer::EndScene() {
+    updateStreaming();
+    selectLods();
+    if (s_Data.meshletCulling) cullMeshlets();
     Flush();
 }
 
+void Renderer::updateStreaming() {
+    // Uploads and evictions bind buffers, so they happen before any drawing.
+    glm::mat4 viewProjection = s_Data.projectionMatrix * s_Data.viewMatrix;
+    for (const auto& cmd : s_Data.commandQueue)
+        if (cmd.streaming) cmd.streaming->Update(viewProjection, cmd.modelMatrix, s_Data.cameraPosition);
+}
+
+void Renderer::selectLods() {
+    // An error of e mesh units at distance d covers
+    // e * scale * viewportHeight / (2 * d * tan(fovY / 2)) pixels.
+    const float pixelsPerUnit = s_Data.viewportHeight / (2.0f * std::tan(s_Data.fovY * 0.5f));
+    for (auto& cmd : s_Data.commandQueue) {
+        cmd.maxLodError = 0.0f;
+        if (!cmd.geometry || s_Data.lodThreshold <= 0.0f) continue;
+
+        float scale = std::max({glm::length(glm::vec3(cmd.modelMatrix[0])), glm::length(glm::vec3(cmd.modelMatrix[1])),
+                                glm::length(glm::vec3(cmd.modelMatrix[2]))});
+        // Measure from the nearest point of the geometry, not its origin.
+        float radius = 0.0f;
+        for (const Mesh& mesh : cmd.geometry->meshes)
+            radius = std::max(radius, glm::length(mesh.boundsCenter) + mesh.boundsRadius);
+        float distance = std::max(cmd.distToCamera - radius * scale, 0.1f);
+        cmd.maxLodError = s_Data.lodThreshold * distance / (pixelsPerUnit * scale);
+    }
+}
+
+void Renderer::cullMeshlets() {
+    size_t total = 0;
+    for (auto& cmd : s_Data.commandQueue) {
+        cmd.visibilityOffset = total;
+        if (cmd.geometry) total += cmd.geometry->MeshletCount();
+    }
+    s_Data.visibility.assign(total, 1);
+
+    // Frustum planes and camera in each command's object space, so meshlet
+    // bounds are tested untransformed.
+    std::vector<MeshletCullParams> params(s_Data.commandQueue.size());
+    std::vector<CullJob> jobs;
+    for (size_t c = 0; c < s_Data.commandQueue.size(); c++) {
+        const RenderCommand& cmd = s_Data.commandQueue[c];
+        if (!cmd.geometry) continue;
+
+        glm::mat4 m = s_Data.projectionMatrix * s_Data.viewMatrix * cmd.modelMatrix;
+        glm::vec4 row[4];
+        for (int i = 0; i < 4; i++) row[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+        glm::vec4* planes = params[c].planes;
+        planes[0] = row[3] + row[0];
+        planes[1] = row[3] - row[0];
+        planes[2] = row[3] + row[1];
+        planes[3] = row[3] - row[1];
+        planes[4] = row[3] + row[2];
+        planes[5] = row[3] - row[2];
+        for (int i = 0; i < 6; i++) planes[i] /= glm::length(glm::vec3(planes[i]));
+
+        // The cone test assumes angles survive the model transform, i.e. no
+        // non-uniform scale.
+        glm::vec3 scale(glm::length(glm::vec3(cmd.modelMatrix[0])), glm::length(glm::vec3(cmd.modelMatrix[1])),
+                        glm::length(glm::vec3(cmd.modelMatrix[2])));
+        float maxScale = std::max({scale.x, scale.y, scale.z});
+        params[c].backfaces = cmd.material && cmd.material->cullBackfaces &&
+                              std::min({scale.x, scale.y, scale.z}) > maxScale * 0.99f;
+        params[c].cameraPosition = glm::vec3(glm::inverse(cmd.modelMatrix) * glm::vec4(s_Data.cameraPosition, 1.0f));
+
+        unsigned char* visible = s_Data.visibility.data() + cmd.visibilityOffset;
+        for (const Mesh& mesh : cmd.geometry->meshes) {
+            for (size_t begin = 0; begin < mesh.meshlets.size(); begin += kCullBatch)
+                jobs.push_back({&mesh, &params[c], begin, std::min(begin + kCullBatch, mesh.meshlets.size()), visible});
+            visible += mesh.meshlets.size();
+        }
+    }
+
+    ThreadPool::Get().ParallelFor(jobs.size(), 1, [&jobs](size_t begin, size_t end) {
+        for (size_t j = begin; j < end; j++)
+            jobs[j].mesh->CullMeshlets(*jobs[j].params, jobs[j].begin, jobs[j].end, jobs[j].visible);
+    });
+}
+
+void Renderer::updateEnvironment() {
+    // Only scenes whose shaders read the block pay for the projection, so
+    // switching skyboxes elsewhere never waits on it.
+    bool needed = false;
+    for (const auto& cmd : s_Data.commandQueue) {
+        if (!cmd.material || !cmd.material->shader) continue;
+        uint64_t program = cmd.material->shader->ProgramSerial();
+        auto it = s_Data.environmentBlocks.find(program);
+        if (it == s_Data.environmentBlocks.end())
+            it = s_Data.environmentBlocks
+                     .emplace(program, cmd.material->shader->bindUniformBlock("EnvironmentSH", kEnvironmentBinding))
+                     .first;
+        needed |= it->second;
+    }
+    if (!needed) return;
+
+    IrradianceSH irradiance = s_Data.activeSkybox ? s_Data.activeSkybox->Irradiance() : IrradianceSH();
+    if (std::memcmp(&irradiance, &s_Data.uploadedIrradiance, sizeof(IrradianceSH)) == 0) return;
+    s_Data.uploadedIrradiance = irradiance;
+    glBindBuffer(GL_UNIFORM_BUFFER, s_Data.environmentUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(IrradianceSH::coefficients), irradiance.coefficients);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
 void Renderer::Flush() {
+    RenderStats stats;
+    for (const auto& cmd : s_Data.commandQueue) {
+        if (!cmd.geometry) continue;
+        const unsigned char* visible = visibilityFor(cmd);
+        for (const Mesh& mesh : cmd.geometry->meshes) {
+            stats.meshlets += mesh.meshlets.size();
+            stats.triangles += mesh.indexCount / 3;
+            size_t lod = mesh.SelectLod(cmd.maxLodError);
+            stats.lodMeshes[std::min<size_t>(lod, 3)]++;
+            size_t visibleTriangles = 0;
+            for (size_t i = 0; i < mesh.meshlets.size(); i++) {
+                if (visible && !visible[i]) continue;
+                stats.visibleMeshlets++;
+                visibleTriangles += mesh.meshlets[i].indexCount / 3;
+            }
+            if (lod > 0 && visibleTriangles > 0) visibleTriangles = mesh.lods[lod].indexCount / 3;
+            stats.drawnTriangles += visibleTriangles;
+            if (visible) visible += mesh.meshlets.size();
+        }
+    }
+    s_Data.stats = stats;
+    updateEnvironment();
+
     for (const auto& cmd : s_Data.commandQueue) {
-        if (!cmd.model || !cmd.model->modelShader) continue;
-        Shader* shader = cmd.model->modelShader;
+        if ((!cmd.geometry && !cmd.streaming) || !cmd.material || !cmd.material->shader) continue;
+        Shader* shader = cmd.material->shader;
         shader->use();
         if (cmd.uniformCallback) cmd.uniformCallback(shader);
-        cmd.model->Draw(cmd.modelMatrix, s_Data.viewMatrix, s_Data.projectionMatrix);
+        shader->setMat4("projection", s_Data.projectionMatrix);
+        shader->setMat4("view", s_Data.viewMatrix);
+        shader->setMat4("model", cmd.modelMatrix);
+        if (cmd.streaming)
+            cmd.streaming->Draw(*shader, cmd.material->textures, &cmd.modelMatrix);
+        else
+            cmd.geometry->Draw(*shader, cmd.material->textures, &cmd.modelMatrix, visibilityFor(cmd),
+                               cmd.maxLodError);
     }
 
     if (s_Data.activeSkybox) {
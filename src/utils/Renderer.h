@@ -6,15 +6,30 @@
 #include <vector>
 
 class Model;
+class Geometry;
+class Material;
 class Shader;
 class Camera;
 class Skybox;
+class StreamingGeometry;
 
 struct RenderCommand {
-    Model* model;
+    Geometry* geometry;
+    Material* material;
     glm::mat4 modelMatrix;
     std::function<void(Shader*)> uniformCallback;
     float distToCamera;
+    size_t visibilityOffset;
+    float maxLodError; // mesh units, from the screen-space error threshold
+    StreamingGeometry* streaming = nullptr; // drawn instead of `geometry`, which is null
+};
+
+struct RenderStats {
+    size_t meshlets = 0;
+    size_t visibleMeshlets = 0;
+    size_t triangles = 0;
+    size_t drawnTriangles = 0;
+    size_t lodMeshes[4] = {}; // meshes drawn at each LOD
 };
 
 class Renderer {
@@ -25,11 +40,33 @@ public:
     static void BeginScene(const Camera& camera, float aspectRatio);
 
     static void Submit(Model& model, const glm::mat4& modelMatrix, std::function<void(Shader*)> callback = nullptr);
+    static void Submit(Geometry& geometry, Material& material, const glm::mat4& modelMatrix,
+                       std::function<void(Shader*)> callback = nullptr);
+    // Streams its chunks for this view in EndScene(); no LOD selection or
+    // meshlet culling beyond the chunk's own. Chunks are baked with tangents,
+    // so unlike Geometry nothing depends on the material's normal map.
+    static void Submit(StreamingGeometry& geometry, Material& material, const glm::mat4& modelMatrix,
+                       std::function<void(Shader*)> callback = nullptr);
 
+    // Also the source of diffuse ambient: shaders that declare
+    //   layout(std140) uniform EnvironmentSH { vec4 u_SH[9]; };
+    // get the skybox's IrradianceSH coefficients there.
     static void SetSkybox(Skybox& skybox);
+    // Frustum (and, per Material, backface cone) culling of meshlets on the
+    // CPU before drawing. On by default.
+    static void SetMeshletCulling(bool enabled);
+    // Meshes switch to a coarser LOD once its error would cover fewer than
+    // `pixels` on screen. 0 keeps every mesh at full detail.
+    static void SetLodThreshold(float pixels);
+    // Totals for the last EndScene().
+    static const RenderStats& GetStats();
 
     static void EndScene();
 
 private:
+    static void selectLods();
+    static void cullMeshlets();
+    static void updateStreaming();
+    static void updateEnvironment();
     static void Flush();
 };
\ No newline at end of file
@@ -1,60 +1,232 @@
 #include "Shader.h"
+#include "HotReload.h"
+#include "LoadProfiler.h"
+#include "MappedFile.h"
 #include <glm/gtc/type_ptr.hpp>
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath)
+#include <unordered_map>
+
+namespace
 {
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
+    // GL thread only, like everything that creates programs.
+    uint64_t s_ProgramSerial = 0;
+
+    uint64_t nextProgramSerial()
+    {
+        return ++s_ProgramSerial;
+    }
+
+    // Mapped rather than streamed, so sources in a mounted AssetPack are read
+    // without touching the file system.
+    bool readSource(const char* path, std::string& code)
+    {
+        MappedFile file;
+        if (!file.Open(path)) return false;
+        code.assign(reinterpret_cast<const char*>(file.Data()), file.Size());
+        return true;
+    }
+
+    void copyUniform(GLuint from, GLint src, GLint dst, GLenum type)
+    {
+        GLfloat f[16];
+        GLint v[4];
+        switch (type)
+        {
+        case GL_FLOAT: glGetUniformfv(from, src, f); glUniform1fv(dst, 1, f); break;
+        case GL_FLOAT_VEC2: glGetUniformfv(from, src, f); glUniform2fv(dst, 1, f); break;
+        case GL_FLOAT_VEC3: glGetUniformfv(from, src, f); glUniform3fv(dst, 1, f); break;
+        case GL_FLOAT_VEC4: glGetUniformfv(from, src, f); glUniform4fv(dst, 1, f); break;
+        case GL_FLOAT_MAT2: glGetUniformfv(from, src, f); glUniformMatrix2fv(dst, 1, GL_FALSE, f); break;
+        case GL_FLOAT_MAT3: glGetUniformfv(from, src, f); glUniformMatrix3fv(dst, 1, GL_FALSE, f); break;
+        case GL_FLOAT_MAT4: glGetUniformfv(from, src, f); glUniformMatrix4fv(dst, 1, GL_FALSE, f); break;
+        case GL_INT_VEC2:
+        case GL_BOOL_VEC2: glGetUniformiv(from, src, v); glUniform2iv(dst, 1, v); break;
+        case GL_INT_VEC3:
+        case GL_BOOL_VEC3: glGetUniformiv(from, src, v); glUniform3iv(dst, 1, v); break;
+        case GL_INT_VEC4:
+        case GL_BOOL_VEC4: glGetUniformiv(from, src, v); glUniform4iv(dst, 1, v); break;
+        case GL_INT:
+        case GL_BOOL:
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_3D:
+        case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_2D_SHADOW:
+        case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_CUBE_SHADOW: glGetUniformiv(from, src, v); glUniform1iv(dst, 1, v); break;
+        default: break;
+        }
+    }
 
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try
+    // Values set once at startup (sampler units, constants) would otherwise
+    // reset to zero in a reloaded program. Matched by name and type; uniforms
+    // set every frame are simply overwritten again.
+    void copyUniforms(GLuint from, GLuint to)
     {
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        std::stringstream vShaderStream, fShaderStream;
+        char name[256];
+        GLint count = 0, size = 0;
+        GLenum type;
+        auto baseName = [](const char* n) {
+            std::string base(n);
+            if (base.size() > 3 && base.compare(base.size() - 3, 3, "[0]") == 0) base.resize(base.size() - 3);
+            return base;
+        };
 
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
+        std::unordered_map<std::string, GLenum> targetTypes;
+        glGetProgramiv(to, GL_ACTIVE_UNIFORMS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            glGetActiveUniform(to, static_cast<GLuint>(i), sizeof(name), nullptr, &size, &type, name);
+            targetTypes[baseName(name)] = type;
+        }
 
-        vShaderFile.close();
-        fShaderFile.close();
+        glUseProgram(to);
+        glGetProgramiv(from, GL_ACTIVE_UNIFORMS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            glGetActiveUniform(from, static_cast<GLuint>(i), sizeof(name), nullptr, &size, &type, name);
+            std::string base = baseName(name);
+            auto it = targetTypes.find(base);
+            if (it == targetTypes.end() || it->second != type) continue;
+            for (GLint e = 0; e < size; e++)
+            {
+                std::string element = size > 1 ? base + "[" + std::to_string(e) + "]" : base;
+                // Uniform block members have no location.
+                GLint src = glGetUniformLocation(from, element.c_str());
+                GLint dst = glGetUniformLocation(to, element.c_str());
+                if (src >= 0 && dst >= 0) copyUniform(from, src, dst, type);
+            }
+        }
 
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
+        glGetProgramiv(from, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            GLint binding = 0;
+            glGetActiveUniformBlockName(from, static_cast<GLuint>(i), sizeof(name), nullptr, name);
+            glGetActiveUniformBlockiv(from, static_cast<GLuint>(i), GL_UNIFORM_BLOCK_BINDING, &binding);
+            GLuint index = glGetUniformBlockIndex(to, name);
+            if (index != GL_INVALID_INDEX) glUniformBlockBinding(to, index, static_cast<GLuint>(binding));
+        }
     }
-    catch (std::ifstream::failure& e)
+}
+
+Shader::Shader(const char* vertexPath, const char* fragmentPath)
+    : vertexPath(vertexPath), fragmentPath(fragmentPath)
+{
+    std::string vertexCode;
+    std::string fragmentCode;
+    LoadProfiler::Clock::time_point start = LoadProfiler::Clock::now();
+    if (!readSource(vertexPath, vertexCode) || !readSource(fragmentPath, fragmentCode))
     {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << e.what() << std::endl;
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << vertexPath << ", " << fragmentPath << std::endl;
     }
+    LoadProfiler::Record("shader-read", fragmentPath, start, LoadProfiler::Clock::now(),
+                         vertexCode.size() + fragmentCode.size());
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
 
     unsigned int vertex, fragment;
 
     // Vertex Shader
+    start = LoadProfiler::Clock::now();
     vertex = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(vertex, 1, &vShaderCode, NULL);
     glCompileShader(vertex);
     checkCompileErrors(vertex, "VERTEX");
+    LoadProfiler::Record("shader-compile", vertexPath, start, LoadProfiler::Clock::now(), vertexCode.size());
 
     // Fragment Shader
+    start = LoadProfiler::Clock::now();
     fragment = glCreateShader(GL_FRAGMENT_SHADER);
     glShaderSource(fragment, 1, &fShaderCode, NULL);
     glCompileShader(fragment);
     checkCompileErrors(fragment, "FRAGMENT");
+    LoadProfiler::Record("shader-compile", fragmentPath, start, LoadProfiler::Clock::now(), fragmentCode.size());
 
     // Shader Program
+    start = LoadProfiler::Clock::now();
     ID = glCreateProgram();
+    programSerial = nextProgramSerial();
     glAttachShader(ID, vertex);
     glAttachShader(ID, fragment);
     glLinkProgram(ID);
     checkCompileErrors(ID, "PROGRAM");
+    LoadProfiler::Record("shader-link", fragmentPath, start, LoadProfiler::Clock::now(), 0);
 
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+
+    HotReload::Track(this);
+}
+
+Shader::~Shader()
+{
+    HotReload::Untrack(this);
+    discardPending();
+    if (ID) glDeleteProgram(ID);
+}
+
+bool Shader::BeginReload()
+{
+    std::string vertexCode;
+    std::string fragmentCode;
+    if (!readSource(vertexPath.c_str(), vertexCode) || !readSource(fragmentPath.c_str(), fragmentCode))
+    {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << vertexPath << ", " << fragmentPath << std::endl;
+        return false;
+    }
+    discardPending();
+
+    const char* vShaderCode = vertexCode.c_str();
+    const char* fShaderCode = fragmentCode.c_str();
+    pendingVertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(pendingVertex, 1, &vShaderCode, NULL);
+    glCompileShader(pendingVertex);
+    pendingFragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(pendingFragment, 1, &fShaderCode, NULL);
+    glCompileShader(pendingFragment);
+
+    pendingProgram = glCreateProgram();
+    glAttachShader(pendingProgram, pendingVertex);
+    glAttachShader(pendingProgram, pendingFragment);
+    glLinkProgram(pendingProgram);
+    return true;
+}
+
+bool Shader::FinishReload()
+{
+    if (pendingProgram == 0) return false;
+
+    GLint vertexOk = 0, fragmentOk = 0, linked = 0;
+    glGetShaderiv(pendingVertex, GL_COMPILE_STATUS, &vertexOk);
+    glGetShaderiv(pendingFragment, GL_COMPILE_STATUS, &fragmentOk);
+    glGetProgramiv(pendingProgram, GL_LINK_STATUS, &linked);
+    checkCompileErrors(pendingVertex, "VERTEX");
+    checkCompileErrors(pendingFragment, "FRAGMENT");
+    if (vertexOk && fragmentOk) checkCompileErrors(pendingProgram, "PROGRAM");
+
+    unsigned int program = pendingProgram;
+    pendingProgram = 0;
+    discardPending();
+    if (!vertexOk || !fragmentOk || !linked)
+    {
+        glDeleteProgram(program);
+        std::cout << "ERROR::SHADER:: keeping the previous program for " << fragmentPath << std::endl;
+        return false;
+    }
+
+    copyUniforms(ID, program);
+    glDeleteProgram(ID);
+    ID = program;
+    programSerial = nextProgramSerial();
+    return true;
+}
+
+void Shader::discardPending()
+{
+    if (pendingProgram) glDeleteProgram(pendingProgram);
+    if (pendingVertex) glDeleteShader(pendingVertex);
+    if (pendingFragment) glDeleteShader(pendingFragment);
+    pendingProgram = pendingVertex = pendingFragment = 0;
 }
 
 void Shader::use()
@@ -87,6 +259,14 @@ void Shader::setMat4(const std::string& name, const glm::mat4& mat) const
     glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
 }
 
+bool Shader::bindUniformBlock(const std::string& name, unsigned int binding) const
+{
+    GLuint index = glGetUniformBlockIndex(ID, name.c_str());
+    if (index == GL_INVALID_INDEX) return false;
+    glUniformBlockBinding(ID, index, binding);
+    return true;
+}
+
 void Shader::checkCompileErrors(unsigned int shader, std::string type)
 {
     int success;
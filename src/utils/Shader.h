@@ -4,6 +4,7 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <cstdint>
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -15,6 +16,11 @@ public:
     unsigned int ID;
 
     Shader(const char* vertexPath, const char* fragmentPath);
+    ~Shader();
+
+    // HotReload keeps a pointer to every Shader.
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
     
     void use();
     
@@ -23,8 +29,34 @@ public:
     void setFloat(const std::string &name, float value) const;
     void setVec3(const std::string &name, const glm::vec3 &vec3) const;
     void setMat4(const std::string &name, const glm::mat4 &mat) const;
+    // Points the named uniform block at a buffer binding. False if the
+    // program has no such block.
+    bool bindUniformBlock(const std::string &name, unsigned int binding) const;
+
+    const std::string& VertexPath() const { return vertexPath; }
+    const std::string& FragmentPath() const { return fragmentPath; }
+
+    // Hot reload. BeginReload re-reads both files and submits a new program
+    // without asking for its status, so the driver can compile it while the
+    // frame renders. FinishReload, a frame later, swaps it into ID with the
+    // old program's uniform values and block bindings; if it does not
+    // compile or link the error is logged and the old program stays.
+    bool BeginReload();
+    bool FinishReload();
+    bool IsReloading() const { return pendingProgram != 0; }
+    // Changes whenever ID does and, unlike GL program names, is never reused,
+    // so it can key per-program caches across reloads.
+    uint64_t ProgramSerial() const { return programSerial; }
 
 private:
+    std::string vertexPath;
+    std::string fragmentPath;
+    unsigned int pendingProgram = 0;
+    uint64_t programSerial = 0;
+    unsigned int pendingVertex = 0;
+    unsigned int pendingFragment = 0;
+
+    void discardPending();
     void checkCompileErrors(unsigned int shader, std::string type);
 };
 #endif
\ No newline at end of file
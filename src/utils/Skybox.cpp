@@ -1,23 +1,97 @@
 #include "Skybox.h"
-#include "stb_image.h"
+#include "TextureCache.h"
+#include "TextureLoader.h"
 #include <iostream>
+#include <unordered_map>
+
+namespace
+{
+    // Keyed by "<vs>|<fs>"; the last Skybox using a program deletes it, and
+    // its entry goes on the next acquire.
+    std::unordered_map<std::string, std::weak_ptr<Shader>> s_Shaders;
+
+    std::shared_ptr<Shader> acquireShader(const char* vsPath, const char* fsPath)
+    {
+        for (auto it = s_Shaders.begin(); it != s_Shaders.end();)
+            it = it->second.expired() ? s_Shaders.erase(it) : std::next(it);
+
+        std::string key = std::string(vsPath) + "|" + fsPath;
+        if (auto shader = s_Shaders[key].lock()) return shader;
+
+        auto shader = std::make_shared<Shader>(vsPath, fsPath);
+        shader->use();
+        shader->setInt("skybox", 0);
+        s_Shaders[key] = shader;
+        return shader;
+    }
+}
 
-Skybox::Skybox(std::vector<std::string> faces, const char* vsPath, const char* fsPath) {
-    shader = new Shader(vsPath, fsPath);
+Skybox::Skybox(std::vector<std::string> faces, const char* vsPath, const char* fsPath, bool loadNow)
+    : faces(std::move(faces)) {
+    shader = acquireShader(vsPath, fsPath);
     setupSkybox();
-    textureID = loadCubemap(faces);
-
-    shader->use();
-    shader->setInt("skybox", 0);
+    if (loadNow) Load();
 }
 
 Skybox::~Skybox() {
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
-    delete shader;
+    TextureCache::Release(textureID);
+    TextureCache::Release(environmentID);
+}
+
+void Skybox::Load() {
+    // A prefetch still in flight finishes on its own; this only covers the
+    // case where nothing was requested yet.
+    if (textureID == 0) textureID = loadCubemap(faces, false);
+}
+
+void Skybox::Prefetch() {
+    if (textureID == 0) textureID = loadCubemap(faces, true);
+}
+
+void Skybox::Unload() {
+    TextureCache::Release(textureID);
+    TextureCache::Release(environmentID);
+    textureID = 0;
+    environmentID = 0;
+}
+
+bool Skybox::IsLoaded() const {
+    return textureID != 0 && !TextureLoader::IsPending(textureID);
+}
+
+void Skybox::BindEnvironment(Shader& shader, const std::string& sampler, int unit) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    if (environmentID == 0 && !environmentFailed) {
+        environmentID = TextureCache::AcquireEnvironment(faces);
+        environmentFailed = environmentID == 0;
+        if (environmentID != 0) {
+            GLint maxLevel = 0;
+            glBindTexture(GL_TEXTURE_CUBE_MAP, environmentID);
+            glGetTexParameteriv(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+            environmentMaxLod = static_cast<float>(maxLevel);
+        }
+    }
+    // Faces the prefilter can't take (not square) still reflect, just sharply.
+    if (environmentID == 0) Load();
+    glBindTexture(GL_TEXTURE_CUBE_MAP, environmentID != 0 ? environmentID : textureID);
+    glActiveTexture(GL_TEXTURE0);
+    shader.setInt(sampler, unit);
+    shader.setFloat(sampler + "MaxLod", environmentMaxLod);
+}
+
+const IrradianceSH& Skybox::Irradiance() {
+    // A failed projection leaves zero irradiance; it isn't retried.
+    if (!irradianceReady) {
+        EnvironmentPrefilter::LoadOrProjectIrradiance(faces, irradiance);
+        irradianceReady = true;
+    }
+    return irradiance;
 }
 
 void Skybox::Draw(const glm::mat4& view, const glm::mat4& projection) {
+    Load();
     glDepthFunc(GL_LEQUAL); 
     
     shader->use();
@@ -92,28 +166,6 @@ void Skybox::setupSkybox() {
     glBindVertexArray(0);
 }
 
-unsigned int Skybox::loadCubemap(std::vector<std::string> faces) {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-    int width, height, nrChannels;
-    for (unsigned int i = 0; i < faces.size(); i++) {
-        unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-        if (data) {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 
-                         0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
-        } else {
-            std::cout << "Cubemap tex failed to load at path: " << faces[i] << std::endl;
-            stbi_image_free(data);
-        }
-    }
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-    return textureID;
-}
\ No newline at end of file
+unsigned int Skybox::loadCubemap(std::vector<std::string> faces, bool async) {
+    return TextureCache::AcquireCubemap(faces, async);
+}
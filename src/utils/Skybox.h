@@ -2,24 +2,57 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include <memory>
 #include <vector>
 #include <string>
 
+#include "EnvironmentPrefilter.h"
 #include "Shader.h"
 
+// Cube-mapped background. The faces are only read when the skybox is first
+// needed: Load() decodes them (six faces in parallel) before returning,
+// Prefetch() in the background, and Draw() falls back to Load() if neither
+// ran. Skyboxes with the same shader files share one program.
+//
+// Materials with glossy reflections sample a second, GGX-prefiltered cube map
+// of the same faces (BindEnvironment) rather than the sharp background.
 class Skybox
 {
 public:
-    unsigned int textureID;
-    Shader* shader;
+    // 0 until the faces are requested; a grey placeholder while prefetching.
+    unsigned int textureID = 0;
+    std::shared_ptr<Shader> shader;
 
-    Skybox(std::vector<std::string> faces, const char* vsPath, const char* fsPath);
+    Skybox(std::vector<std::string> faces, const char* vsPath, const char* fsPath, bool loadNow = true);
     ~Skybox();
 
+    void Load();
+    void Prefetch();
+    // Drops this skybox's reference to the faces; a later Load or Prefetch
+    // reads them again.
+    void Unload();
+    // The real faces are resident (not just requested).
+    bool IsLoaded() const;
+
+    // Binds the prefiltered cube map, building it on first use, to `unit` and
+    // points `sampler` at it. `sampler` + "MaxLod" gets its last mip level,
+    // which holds roughness 1.
+    void BindEnvironment(Shader& shader, const std::string& sampler, int unit);
+    // Diffuse irradiance of the faces (see IrradianceSH), projected or read
+    // from the bake cache on first use. The Renderer feeds it to shaders
+    // declaring the EnvironmentSH uniform block.
+    const IrradianceSH& Irradiance();
+
     void Draw(const glm::mat4& view, const glm::mat4& projection);
 
 private:
+    std::vector<std::string> faces;
+    unsigned int environmentID = 0;
+    float environmentMaxLod = 0.0f;
+    bool environmentFailed = false;
+    IrradianceSH irradiance;
+    bool irradianceReady = false;
     unsigned int VAO, VBO;
     void setupSkybox();
-    unsigned int loadCubemap(std::vector<std::string> faces);
+    unsigned int loadCubemap(std::vector<std::string> faces, bool async);
 };
@@ -0,0 +1,93 @@
+#include "SkyboxResidency.h"
+#include "TextureLoader.h"
+
+#include <algorithm>
+
+SkyboxResidency::SkyboxResidency(std::vector<Skybox>& skyboxes, size_t budgetBytes, size_t first)
+    : skyboxes(skyboxes), lastShown(skyboxes.size(), 0), budget(budgetBytes),
+      displayed(std::min(first, skyboxes.empty() ? 0 : skyboxes.size() - 1)), pending(SIZE_MAX)
+{
+    if (!skyboxes.empty()) skyboxes[displayed].Load();
+}
+
+Skybox& SkyboxResidency::Select(size_t wanted)
+{
+    frame++;
+    const size_t count = skyboxes.size();
+    wanted %= count;
+
+    if (wanted != displayed && wanted != pending)
+    {
+        // A new target; a previous one still loading simply keeps loading.
+        requested = Clock::now();
+        if (skyboxes[wanted].IsLoaded())
+        {
+            stats.hits++;
+        }
+        else
+        {
+            stats.misses++;
+            request(wanted);
+        }
+        pending = wanted;
+    }
+    if (wanted == displayed) pending = SIZE_MAX;
+
+    if (pending != SIZE_MAX && skyboxes[pending].IsLoaded())
+    {
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - requested).count();
+        stats.lastSwitchMs = ms;
+        stats.maxSwitchMs = std::max(stats.maxSwitchMs, ms);
+        stats.totalSwitchMs += ms;
+        stats.switches++;
+        displayed = pending;
+        pending = SIZE_MAX;
+    }
+    lastShown[displayed] = frame;
+
+    // TAB only ever moves forward, so the next skybox is the likely target.
+    const size_t next = (wanted + 1) % count;
+    if (skyboxes[next].textureID == 0)
+    {
+        stats.prefetches++;
+        request(next);
+    }
+    evict(wanted, next);
+    return skyboxes[displayed];
+}
+
+void SkyboxResidency::request(size_t index)
+{
+    skyboxes[index].Prefetch();
+}
+
+void SkyboxResidency::evict(size_t keepA, size_t keepB)
+{
+    // Cube maps still decoding only count their placeholder here, so the
+    // budget can be exceeded by what is in flight; it is enforced again as
+    // soon as they land.
+    stats.resident = 0;
+    stats.residentBytes = 0;
+    for (const Skybox& skybox : skyboxes)
+    {
+        if (skybox.textureID == 0) continue;
+        stats.resident++;
+        stats.residentBytes += TextureLoader::ResidentBytes(skybox.textureID);
+    }
+
+    while (stats.residentBytes > budget)
+    {
+        size_t victim = SIZE_MAX;
+        for (size_t i = 0; i < skyboxes.size(); i++)
+        {
+            if (skyboxes[i].textureID == 0 || i == displayed || i == keepA || i == keepB) continue;
+            if (victim == SIZE_MAX || lastShown[i] < lastShown[victim]) victim = i;
+        }
+        if (victim == SIZE_MAX) break;
+
+        stats.resident--;
+        stats.residentBytes -= TextureLoader::ResidentBytes(skyboxes[victim].textureID);
+        skyboxes[victim].Unload();
+        stats.evictions++;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Skybox.h"
+
+// Keeps a cycle of skyboxes within a VRAM budget. The one shown and the next
+// in the cycle stay resident; the rest are evicted least recently shown
+// first. Switching to a skybox that isn't resident yet keeps showing the
+// current one until its faces have been decoded and uploaded, so TAB never
+// stalls a frame on JPEG decoding.
+class SkyboxResidency
+{
+public:
+    struct Stats {
+        size_t hits = 0;       // switches whose target was already resident
+        size_t misses = 0;     // switches that had to wait for a load
+        size_t evictions = 0;
+        size_t prefetches = 0; // background loads started ahead of a switch
+        size_t resident = 0;
+        size_t residentBytes = 0;
+        double lastSwitchMs = 0.0; // request to first frame showing the new skybox
+        double maxSwitchMs = 0.0;
+        double totalSwitchMs = 0.0;
+        size_t switches = 0;
+    };
+
+    // `skyboxes` must outlive the manager and not be resized. The first one
+    // shown is loaded up front.
+    SkyboxResidency(std::vector<Skybox>& skyboxes, size_t budgetBytes, size_t first = 0);
+
+    // Once per frame with the skybox the user asked for. Returns the one to
+    // draw this frame: `wanted` if resident, else the previous one.
+    Skybox& Select(size_t wanted);
+
+    void SetBudget(size_t bytes) { budget = bytes; }
+    size_t GetBudget() const { return budget; }
+    size_t Displayed() const { return displayed; }
+    const Stats& GetStats() const { return stats; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<Skybox>& skyboxes;
+    std::vector<uint64_t> lastShown; // frame number, 0 = never
+    size_t budget;
+    size_t displayed;
+    size_t pending;                  // switch target still loading, or SIZE_MAX
+    Clock::time_point requested;
+    uint64_t frame = 0;
+    Stats stats;
+
+    void request(size_t index);
+    void evict(size_t keepA, size_t keepB);
+};
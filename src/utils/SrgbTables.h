@@ -0,0 +1,33 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+// Lookup tables for the sRGB transfer function, shared by the mip and
+// environment filters: 8-bit sRGB to linear, and 12-bit linear to 8-bit sRGB.
+struct SrgbTables {
+    float srgbToLinear[256];
+    unsigned char linearToSrgb[4096];
+
+    SrgbTables()
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            double c = i / 255.0;
+            srgbToLinear[i] = static_cast<float>(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+        }
+        for (int i = 0; i < 4096; i++)
+        {
+            double l = i / 4095.0;
+            double s = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+            linearToSrgb[i] = static_cast<unsigned char>(std::min(255.0, s * 255.0 + 0.5));
+        }
+    }
+};
+
+// Built on first use, once per process.
+inline const SrgbTables& GetSrgbTables()
+{
+    static const SrgbTables tables;
+    return tables;
+}
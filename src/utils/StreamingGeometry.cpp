@@ -0,0 +1,863 @@
+#include "StreamingGeometry.h"
+#include "AssetPack.h"
+#include "Geometry.h"
+#include "Hash.h"
+#include "LoadProfiler.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "TextureCache.h"
+#include "TextureLoader.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <unordered_map>
+
+namespace
+{
+    const char kMagic[8] = {'R', 'T', 'R', 'C', 'H', 'N', 'K', '\0'};
+    const uint32_t kVersion = 2; // 2: tangents on every mesh
+    const uint64_t kAlignment = 16;
+    // Chunk data starts on a page, so discarding one chunk's mapped pages
+    // never drops a neighbour's.
+    const uint64_t kChunkAlignment = 4096;
+    // Small enough to stream in a frame or two, large enough that a model of
+    // millions of triangles stays at a few hundred chunks (and draw calls).
+    const size_t kChunkTriangles = 32768;
+    // Proxies keep about this fraction of a chunk's triangles...
+    const size_t kProxyRatio = 16;
+    // ...within this fraction of the chunk's radius.
+    const float kProxyError = 0.05f;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t vertexStride;
+        uint32_t chunkCount;
+        uint32_t partCount;
+        uint32_t materialCount;
+        uint32_t textureCount;
+        uint64_t sourceSize;
+        int64_t sourceMtime;
+        uint64_t contentHash;
+        uint64_t chunkTableOffset;
+        uint64_t partTableOffset;
+        uint64_t materialTableOffset;
+        uint64_t textureTableOffset;
+        uint64_t stringsOffset;
+        uint64_t stringsSize;
+        float boundsCenter[3];
+        float boundsRadius;
+    };
+
+    struct ChunkRecord {
+        float center[3];
+        float radius;
+        uint32_t firstPart;
+        uint32_t partCount;
+        uint64_t dataOffset;
+        uint64_t dataSize;
+    };
+
+    struct PartRecord {
+        uint32_t material;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t meshletCount;
+        uint32_t proxyVertexCount;
+        uint32_t proxyIndexCount;
+        uint64_t vertexOffset;  // detail streams: from the chunk's dataOffset
+        uint64_t indexOffset;
+        uint64_t meshletOffset;
+        uint64_t proxyVertexOffset; // proxy streams: from the start of the file
+        uint64_t proxyIndexOffset;
+    };
+
+    struct MaterialRecord {
+        uint32_t firstTexture;
+        uint32_t textureCount;
+    };
+
+    struct TextureRecord {
+        uint32_t typeOffset;
+        uint32_t typeLength;
+        uint32_t pathOffset;
+        uint32_t pathLength;
+    };
+
+    struct SourceInfo {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+    };
+
+    // One imported mesh, from the mesh cache or a fresh import; level 0 only.
+    struct SourceMesh {
+        const Vertex* vertices;
+        const unsigned int* indices;
+        size_t indexCount;
+    };
+
+    struct TriangleRef {
+        glm::vec3 centroid;
+        uint32_t mesh;
+        uint32_t firstIndex;
+    };
+
+    struct BuiltPart {
+        uint32_t material;
+        MeshData detail;
+        std::vector<Vertex> proxyVertices;
+        std::vector<unsigned int> proxyIndices;
+    };
+
+    struct BuiltChunk {
+        glm::vec3 center;
+        float radius;
+        std::vector<BuiltPart> parts;
+    };
+
+    bool statSource(const std::string& path, SourceInfo& info)
+    {
+        unsigned long long packedSize;
+        long long packedMtime;
+        if (AssetPack::Stat(path, packedSize, packedMtime))
+        {
+            info.size = packedSize;
+            info.mtime = packedMtime;
+            return true;
+        }
+
+        std::error_code ec;
+        auto size = std::filesystem::file_size(path, ec);
+        if (ec) return false;
+        auto mtime = std::filesystem::last_write_time(path, ec);
+        if (ec) return false;
+        info.size = static_cast<uint64_t>(size);
+        info.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+        return true;
+    }
+
+    bool hashSource(const std::string& path, uint64_t& hash)
+    {
+        MappedFile source;
+        if (!source.Open(path)) return false;
+        hash = HashBytes(source.Data(), source.Size());
+        return true;
+    }
+
+    uint64_t alignUp(uint64_t v, uint64_t alignment = kAlignment)
+    {
+        return (v + alignment - 1) & ~(alignment - 1);
+    }
+
+    bool inBounds(uint64_t offset, uint64_t bytes, size_t fileSize)
+    {
+        return offset <= fileSize && bytes <= fileSize - offset;
+    }
+
+    // Median splits along the longest axis of the centroids until every
+    // range holds at most kChunkTriangles. Reorders `triangles`.
+    std::vector<std::pair<size_t, size_t>> partition(std::vector<TriangleRef>& triangles)
+    {
+        std::vector<std::pair<size_t, size_t>> leaves, pending{{0, triangles.size()}};
+        while (!pending.empty())
+        {
+            auto [begin, end] = pending.back();
+            pending.pop_back();
+            if (end - begin <= kChunkTriangles)
+            {
+                if (end > begin) leaves.push_back({begin, end});
+                continue;
+            }
+
+            glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+            for (size_t i = begin; i < end; i++)
+            {
+                lo = glm::min(lo, triangles[i].centroid);
+                hi = glm::max(hi, triangles[i].centroid);
+            }
+            glm::vec3 extent = hi - lo;
+            int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+            size_t middle = begin + (end - begin) / 2;
+            std::nth_element(triangles.begin() + begin, triangles.begin() + middle, triangles.begin() + end,
+                             [axis](const TriangleRef& a, const TriangleRef& b) {
+                                 return a.centroid[axis] < b.centroid[axis];
+                             });
+            pending.push_back({middle, end});
+            pending.push_back({begin, middle});
+        }
+        return leaves;
+    }
+
+    // The triangles of one leaf, split by source mesh (and so by material),
+    // each part with vertices of its own and a simplified proxy.
+    BuiltChunk buildChunk(const std::vector<SourceMesh>& sources, TriangleRef* triangles, size_t count)
+    {
+        std::stable_sort(triangles, triangles + count,
+                         [](const TriangleRef& a, const TriangleRef& b) { return a.mesh < b.mesh; });
+
+        BuiltChunk chunk;
+        std::unordered_map<unsigned int, unsigned int> remap;
+        for (size_t begin = 0; begin < count;)
+        {
+            size_t end = begin;
+            while (end < count && triangles[end].mesh == triangles[begin].mesh) end++;
+
+            const SourceMesh& source = sources[triangles[begin].mesh];
+            BuiltPart part;
+            part.material = triangles[begin].mesh;
+            remap.clear();
+            part.detail.indices.reserve((end - begin) * 3);
+            for (size_t t = begin; t < end; t++)
+            {
+                for (size_t corner = 0; corner < 3; corner++)
+                {
+                    unsigned int index = source.indices[triangles[t].firstIndex + corner];
+                    auto it = remap.emplace(index, static_cast<unsigned int>(part.detail.vertices.size()));
+                    if (it.second) part.detail.vertices.push_back(source.vertices[index]);
+                    part.detail.indices.push_back(it.first->second);
+                }
+            }
+            MeshOptimizer::Optimize(part.detail);
+            chunk.parts.push_back(std::move(part));
+            begin = end;
+        }
+
+        // Bounds first: the proxy error budget scales with the chunk. A sphere
+        // around the box is loose, but cheap and independent of vertex order.
+        glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+        for (const BuiltPart& part : chunk.parts)
+        {
+            for (const Vertex& v : part.detail.vertices)
+            {
+                lo = glm::min(lo, v.Position);
+                hi = glm::max(hi, v.Position);
+            }
+        }
+        chunk.center = (lo + hi) * 0.5f;
+        chunk.radius = 0.0f;
+        for (const BuiltPart& part : chunk.parts)
+            for (const Vertex& v : part.detail.vertices)
+                chunk.radius = std::max(chunk.radius, glm::distance(chunk.center, v.Position));
+
+        for (BuiltPart& part : chunk.parts)
+        {
+            const MeshData& detail = part.detail;
+            size_t target = std::max<size_t>(detail.indices.size() / kProxyRatio / 3 * 3, 3);
+            // Open borders stay locked, so neighbouring proxies (and the
+            // detail of neighbouring chunks) still meet without cracks.
+            std::vector<unsigned int> simplified = MeshSimplifier::Simplify(
+                detail.vertices, detail.indices.data(), detail.indices.size(), target, chunk.radius * kProxyError);
+
+            remap.clear();
+            part.proxyIndices.reserve(simplified.size());
+            for (unsigned int index : simplified)
+            {
+                auto it = remap.emplace(index, static_cast<unsigned int>(part.proxyVertices.size()));
+                if (it.second) part.proxyVertices.push_back(detail.vertices[index]);
+                part.proxyIndices.push_back(it.first->second);
+            }
+        }
+        return chunk;
+    }
+}
+
+std::string StreamingGeometry::chunkPath(const std::string& path)
+{
+    std::error_code ec;
+    std::string key = std::filesystem::weakly_canonical(path, ec).string();
+    if (ec) key = path;
+
+    uint64_t h = HashCombine(HashString(key), kVersion);
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.chunks", static_cast<unsigned long long>(h));
+    return (MeshCache::GetDirectory() / name).string();
+}
+
+bool StreamingGeometry::Bake(const std::string& path)
+{
+    // Tangents for every mesh: a chunk can't be re-baked when a normal map
+    // shows up later, and they take no extra space in the fixed Vertex.
+    Geometry::ImportData data;
+    if (!Geometry::Import(path, data, true)) return false;
+    if (!data.embedded.empty())
+    {
+        std::cout << "ERROR::STREAMING_GEOMETRY:: " << path << " has embedded textures and can't be streamed"
+                  << std::endl;
+        return false;
+    }
+
+    SourceInfo info;
+    FileHeader header{};
+    if (!statSource(path, info) || !hashSource(path, header.contentHash)) return false;
+    LoadProfiler::Scope scope("chunk-bake", path);
+
+    std::vector<SourceMesh> sources;
+    std::vector<std::vector<MeshCache::TextureBinding>> materials;
+    if (data.fromCache)
+    {
+        for (const MeshCache::CachedMesh& mesh : data.cached.meshes)
+        {
+            sources.push_back({mesh.vertices, mesh.indices, mesh.lodCount ? mesh.lods[0].indexCount : mesh.indexCount});
+            materials.push_back(mesh.textures);
+        }
+    }
+    else
+    {
+        for (const Geometry::ImportedMesh& mesh : data.meshes)
+        {
+            const MeshData& d = mesh.data;
+            size_t level0 = d.lods.empty() ? d.indices.size() : d.lods[0].indexCount;
+            sources.push_back({d.vertices.data(), d.indices.data(), level0});
+            materials.emplace_back();
+            for (const Geometry::ImportedTexture& texture : mesh.textures)
+                materials.back().push_back({texture.type, texture.path});
+        }
+    }
+
+    std::vector<TriangleRef> triangles;
+    for (size_t m = 0; m < sources.size(); m++)
+    {
+        const SourceMesh& source = sources[m];
+        for (size_t i = 0; i + 2 < source.indexCount; i += 3)
+        {
+            glm::vec3 centroid = (source.vertices[source.indices[i]].Position +
+                                  source.vertices[source.indices[i + 1]].Position +
+                                  source.vertices[source.indices[i + 2]].Position) / 3.0f;
+            triangles.push_back({centroid, static_cast<uint32_t>(m), static_cast<uint32_t>(i)});
+        }
+    }
+    if (triangles.empty()) return false;
+
+    std::vector<std::pair<size_t, size_t>> leaves = partition(triangles);
+    std::vector<BuiltChunk> built(leaves.size());
+    ThreadPool::Get().ParallelFor(leaves.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            built[i] = buildChunk(sources, triangles.data() + leaves[i].first, leaves[i].second - leaves[i].first);
+    });
+    scope.AddBytes(triangles.size() * 3 * sizeof(Vertex));
+
+    // Layout: tables and strings, then every proxy (read once by Open()),
+    // then each chunk's detail streams back to back from a page boundary.
+    std::vector<ChunkRecord> chunkRecords;
+    std::vector<PartRecord> partRecords;
+    std::vector<MaterialRecord> materialRecords;
+    std::vector<TextureRecord> textureRecords;
+    std::string strings;
+    for (const auto& textures : materials)
+    {
+        materialRecords.push_back(
+            {static_cast<uint32_t>(textureRecords.size()), static_cast<uint32_t>(textures.size())});
+        for (const MeshCache::TextureBinding& texture : textures)
+        {
+            TextureRecord tr;
+            tr.typeOffset = static_cast<uint32_t>(strings.size());
+            tr.typeLength = static_cast<uint32_t>(texture.type.size());
+            strings += texture.type;
+            tr.pathOffset = static_cast<uint32_t>(strings.size());
+            tr.pathLength = static_cast<uint32_t>(texture.path.size());
+            strings += texture.path;
+            textureRecords.push_back(tr);
+        }
+    }
+
+    glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+    for (const BuiltChunk& chunk : built)
+    {
+        lo = glm::min(lo, chunk.center - glm::vec3(chunk.radius));
+        hi = glm::max(hi, chunk.center + glm::vec3(chunk.radius));
+    }
+    glm::vec3 center = (lo + hi) * 0.5f;
+    float radius = 0.0f;
+    for (const BuiltChunk& chunk : built)
+        radius = std::max(radius, glm::distance(center, chunk.center) + chunk.radius);
+
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.vertexStride = sizeof(Vertex);
+    header.chunkCount = static_cast<uint32_t>(built.size());
+    header.materialCount = static_cast<uint32_t>(materialRecords.size());
+    header.textureCount = static_cast<uint32_t>(textureRecords.size());
+    header.sourceSize = info.size;
+    header.sourceMtime = info.mtime;
+    header.boundsCenter[0] = center.x;
+    header.boundsCenter[1] = center.y;
+    header.boundsCenter[2] = center.z;
+    header.boundsRadius = radius;
+    for (const BuiltChunk& chunk : built) header.partCount += static_cast<uint32_t>(chunk.parts.size());
+
+    uint64_t cursor = alignUp(sizeof(FileHeader));
+    header.chunkTableOffset = cursor;
+    cursor = alignUp(cursor + uint64_t(header.chunkCount) * sizeof(ChunkRecord));
+    header.partTableOffset = cursor;
+    cursor = alignUp(cursor + uint64_t(header.partCount) * sizeof(PartRecord));
+    header.materialTableOffset = cursor;
+    cursor = alignUp(cursor + materialRecords.size() * sizeof(MaterialRecord));
+    header.textureTableOffset = cursor;
+    cursor = alignUp(cursor + textureRecords.size() * sizeof(TextureRecord));
+    header.stringsOffset = cursor;
+    header.stringsSize = strings.size();
+    cursor = alignUp(cursor + strings.size());
+
+    partRecords.resize(header.partCount);
+    for (size_t c = 0, p = 0; c < built.size(); c++)
+    {
+        for (const BuiltPart& part : built[c].parts)
+        {
+            PartRecord& r = partRecords[p++];
+            r.proxyVertexOffset = cursor;
+            cursor = alignUp(cursor + part.proxyVertices.size() * sizeof(Vertex));
+            r.proxyIndexOffset = cursor;
+            cursor = alignUp(cursor + part.proxyIndices.size() * sizeof(unsigned int));
+        }
+    }
+    for (size_t c = 0, p = 0; c < built.size(); c++)
+    {
+        const BuiltChunk& chunk = built[c];
+        ChunkRecord r;
+        r.center[0] = chunk.center.x;
+        r.center[1] = chunk.center.y;
+        r.center[2] = chunk.center.z;
+        r.radius = chunk.radius;
+        r.firstPart = static_cast<uint32_t>(p);
+        r.partCount = static_cast<uint32_t>(chunk.parts.size());
+        r.dataOffset = cursor = alignUp(cursor, kChunkAlignment);
+        for (const BuiltPart& part : chunk.parts)
+        {
+            PartRecord& pr = partRecords[p++];
+            pr.material = part.material;
+            pr.vertexCount = static_cast<uint32_t>(part.detail.vertices.size());
+            pr.indexCount = static_cast<uint32_t>(part.detail.indices.size());
+            pr.meshletCount = static_cast<uint32_t>(part.detail.meshlets.size());
+            pr.proxyVertexCount = static_cast<uint32_t>(part.proxyVertices.size());
+            pr.proxyIndexCount = static_cast<uint32_t>(part.proxyIndices.size());
+            pr.vertexOffset = cursor - r.dataOffset;
+            cursor = alignUp(cursor + part.detail.vertices.size() * sizeof(Vertex));
+            pr.indexOffset = cursor - r.dataOffset;
+            cursor = alignUp(cursor + part.detail.indices.size() * sizeof(unsigned int));
+            pr.meshletOffset = cursor - r.dataOffset;
+            cursor = alignUp(cursor + part.detail.meshlets.size() * sizeof(Meshlet));
+        }
+        r.dataSize = cursor - r.dataOffset;
+        chunkRecords.push_back(r);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(MeshCache::GetDirectory(), ec);
+
+    // Same as MeshCache: write beside the target and rename, so a crash
+    // mid-write never leaves a truncated file that passes the header checks.
+    std::filesystem::path target = chunkPath(path);
+    std::filesystem::path temp = target;
+    temp += ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            std::cout << "ERROR::STREAMING_GEOMETRY:: cannot write " << temp.string() << std::endl;
+            return false;
+        }
+
+        auto padTo = [&out](uint64_t offset) {
+            static const char zeros[kChunkAlignment] = {};
+            uint64_t pos = static_cast<uint64_t>(out.tellp());
+            out.write(zeros, static_cast<std::streamsize>(offset - pos));
+        };
+        auto write = [&out](const void* data, size_t bytes) {
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        };
+
+        write(&header, sizeof(header));
+        padTo(header.chunkTableOffset);
+        write(chunkRecords.data(), chunkRecords.size() * sizeof(ChunkRecord));
+        padTo(header.partTableOffset);
+        write(partRecords.data(), partRecords.size() * sizeof(PartRecord));
+        padTo(header.materialTableOffset);
+        write(materialRecords.data(), materialRecords.size() * sizeof(MaterialRecord));
+        padTo(header.textureTableOffset);
+        write(textureRecords.data(), textureRecords.size() * sizeof(TextureRecord));
+        padTo(header.stringsOffset);
+        write(strings.data(), strings.size());
+
+        size_t p = 0;
+        for (const BuiltChunk& chunk : built)
+        {
+            for (const BuiltPart& part : chunk.parts)
+            {
+                padTo(partRecords[p].proxyVertexOffset);
+                write(part.proxyVertices.data(), part.proxyVertices.size() * sizeof(Vertex));
+                padTo(partRecords[p].proxyIndexOffset);
+                write(part.proxyIndices.data(), part.proxyIndices.size() * sizeof(unsigned int));
+                p++;
+            }
+        }
+        p = 0;
+        for (size_t c = 0; c < built.size(); c++)
+        {
+            uint64_t base = chunkRecords[c].dataOffset;
+            for (const BuiltPart& part : built[c].parts)
+            {
+                const PartRecord& r = partRecords[p++];
+                padTo(base + r.vertexOffset);
+                write(part.detail.vertices.data(), part.detail.vertices.size() * sizeof(Vertex));
+                padTo(base + r.indexOffset);
+                write(part.detail.indices.data(), part.detail.indices.size() * sizeof(unsigned int));
+                padTo(base + r.meshletOffset);
+                write(part.detail.meshlets.data(), part.detail.meshlets.size() * sizeof(Meshlet));
+            }
+            padTo(base + chunkRecords[c].dataSize);
+        }
+        if (!out) return false;
+    }
+
+    std::filesystem::rename(temp, target, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    std::cout << "StreamingGeometry:: baked " << path << " into " << built.size() << " chunks of "
+              << triangles.size() << " triangles" << std::endl;
+    return true;
+}
+
+std::shared_ptr<StreamingGeometry> StreamingGeometry::Open(const std::string& path)
+{
+    std::shared_ptr<StreamingGeometry> geometry(new StreamingGeometry());
+    if (geometry->open(path)) return geometry;
+    if (Bake(path) && geometry->open(path)) return geometry;
+
+    std::cout << "ERROR::STREAMING_GEOMETRY:: cannot stream " << path << std::endl;
+    return nullptr;
+}
+
+bool StreamingGeometry::open(const std::string& path)
+{
+    SourceInfo info;
+    if (!statSource(path, info)) return false;
+
+    auto mapped = std::make_shared<MappedFile>();
+    if (!mapped->Open(chunkPath(path))) return false;
+
+    const unsigned char* base = mapped->Data();
+    size_t size = mapped->Size();
+    if (size < sizeof(FileHeader)) return false;
+
+    FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.vertexStride != sizeof(Vertex) || header.sourceSize != info.size || header.sourceMtime != info.mtime)
+        return false;
+
+    uint64_t contentHash;
+    if (!hashSource(path, contentHash) || contentHash != header.contentHash) return false;
+
+    if (!inBounds(header.chunkTableOffset, uint64_t(header.chunkCount) * sizeof(ChunkRecord), size) ||
+        !inBounds(header.partTableOffset, uint64_t(header.partCount) * sizeof(PartRecord), size) ||
+        !inBounds(header.materialTableOffset, uint64_t(header.materialCount) * sizeof(MaterialRecord), size) ||
+        !inBounds(header.textureTableOffset, uint64_t(header.textureCount) * sizeof(TextureRecord), size) ||
+        !inBounds(header.stringsOffset, header.stringsSize, size))
+        return false;
+
+    const ChunkRecord* chunkRecords = reinterpret_cast<const ChunkRecord*>(base + header.chunkTableOffset);
+    const PartRecord* partRecords = reinterpret_cast<const PartRecord*>(base + header.partTableOffset);
+    const MaterialRecord* materialRecords = reinterpret_cast<const MaterialRecord*>(base + header.materialTableOffset);
+    const TextureRecord* textureRecords = reinterpret_cast<const TextureRecord*>(base + header.textureTableOffset);
+    const char* strings = reinterpret_cast<const char*>(base + header.stringsOffset);
+
+    // Validate everything before acquiring textures or touching GL.
+    for (uint32_t m = 0; m < header.materialCount; m++)
+    {
+        const MaterialRecord& r = materialRecords[m];
+        if (uint64_t(r.firstTexture) + r.textureCount > header.textureCount) return false;
+    }
+    for (uint32_t t = 0; t < header.textureCount; t++)
+    {
+        const TextureRecord& r = textureRecords[t];
+        if (!inBounds(r.typeOffset, r.typeLength, header.stringsSize) ||
+            !inBounds(r.pathOffset, r.pathLength, header.stringsSize))
+            return false;
+    }
+    for (uint32_t c = 0; c < header.chunkCount; c++)
+    {
+        const ChunkRecord& r = chunkRecords[c];
+        if (!inBounds(r.dataOffset, r.dataSize, size) || uint64_t(r.firstPart) + r.partCount > header.partCount)
+            return false;
+        for (uint32_t p = r.firstPart; p < r.firstPart + r.partCount; p++)
+        {
+            const PartRecord& pr = partRecords[p];
+            if (pr.material >= header.materialCount ||
+                !inBounds(pr.vertexOffset, uint64_t(pr.vertexCount) * sizeof(Vertex), r.dataSize) ||
+                !inBounds(pr.indexOffset, uint64_t(pr.indexCount) * sizeof(unsigned int), r.dataSize) ||
+                !inBounds(pr.meshletOffset, uint64_t(pr.meshletCount) * sizeof(Meshlet), r.dataSize) ||
+                !inBounds(pr.proxyVertexOffset, uint64_t(pr.proxyVertexCount) * sizeof(Vertex), size) ||
+                !inBounds(pr.proxyIndexOffset, uint64_t(pr.proxyIndexCount) * sizeof(unsigned int), size))
+                return false;
+        }
+    }
+
+    sourcePath = path;
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    materials.resize(header.materialCount);
+    for (uint32_t m = 0; m < header.materialCount; m++)
+    {
+        const MaterialRecord& r = materialRecords[m];
+        for (uint32_t t = r.firstTexture; t < r.firstTexture + r.textureCount; t++)
+        {
+            const TextureRecord& tr = textureRecords[t];
+            Texture texture;
+            texture.type.assign(strings + tr.typeOffset, tr.typeLength);
+            texture.path.assign(strings + tr.pathOffset, tr.pathLength);
+            texture.id = TextureCache::Acquire((directory / texture.path).string(), TextureSettings{},
+                                               TextureLoader::PlaceholderFor(texture.type));
+            if (texture.id != 0) materials[m].push_back(std::move(texture));
+        }
+    }
+
+    LoadProfiler::Scope scope("chunk-proxy", path);
+    chunks.resize(header.chunkCount);
+    stats = Stats();
+    stats.chunks = chunks.size();
+    uint64_t proxyBegin = size, proxyEnd = 0;
+    for (uint32_t c = 0; c < header.chunkCount; c++)
+    {
+        const ChunkRecord& r = chunkRecords[c];
+        Chunk& chunk = chunks[c];
+        chunk.center = glm::vec3(r.center[0], r.center[1], r.center[2]);
+        chunk.radius = r.radius;
+        chunk.dataOffset = r.dataOffset;
+        chunk.dataSize = r.dataSize;
+        for (uint32_t p = r.firstPart; p < r.firstPart + r.partCount; p++)
+        {
+            const PartRecord& pr = partRecords[p];
+            chunk.parts.push_back({pr.material, pr.vertexCount, pr.indexCount, pr.meshletCount, pr.vertexOffset,
+                                   pr.indexOffset, pr.meshletOffset});
+            chunk.proxy.emplace_back(reinterpret_cast<const Vertex*>(base + pr.proxyVertexOffset), pr.proxyVertexCount,
+                                     reinterpret_cast<const unsigned int*>(base + pr.proxyIndexOffset),
+                                     pr.proxyIndexCount, nullptr, 0, nullptr, 0, materials[pr.material]);
+            stats.proxyBytes += chunk.proxy.back().GpuBytes();
+            uint64_t indexBytes = uint64_t(pr.proxyIndexCount) * sizeof(unsigned int);
+            scope.AddBytes(uint64_t(pr.proxyVertexCount) * sizeof(Vertex) + indexBytes);
+            proxyBegin = std::min(proxyBegin, pr.proxyVertexOffset);
+            proxyEnd = std::max(proxyEnd, pr.proxyIndexOffset + indexBytes);
+        }
+    }
+    // The proxies live on the GPU from here on.
+    if (proxyEnd > proxyBegin) mapped->Discard(proxyBegin, proxyEnd - proxyBegin);
+
+    boundsCenter = glm::vec3(header.boundsCenter[0], header.boundsCenter[1], header.boundsCenter[2]);
+    boundsRadius = header.boundsRadius;
+    file = std::move(mapped);
+    return true;
+}
+
+StreamingGeometry::~StreamingGeometry()
+{
+    // Reads still in flight hold the mapping themselves; their results are dropped.
+    for (Chunk& chunk : chunks)
+    {
+        for (Mesh& mesh : chunk.proxy) mesh.Release();
+        for (Mesh& mesh : chunk.detail) mesh.Release();
+    }
+    for (const auto& textures : materials)
+        for (const Texture& texture : textures) TextureCache::Release(texture.id);
+}
+
+void StreamingGeometry::SetBudget(size_t cpuBytes, size_t gpuBytes)
+{
+    cpuBudget = cpuBytes;
+    gpuBudget = gpuBytes;
+}
+
+void StreamingGeometry::Update(const glm::mat4& viewProjection, const glm::mat4& model, const glm::vec3& cameraPosition)
+{
+    frame++;
+
+    // Frustum planes and camera in mesh space, as Renderer does for meshlets.
+    glm::mat4 m = viewProjection * model;
+    glm::vec4 row[4], planes[6];
+    for (int i = 0; i < 4; i++) row[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+    planes[0] = row[3] + row[0];
+    planes[1] = row[3] - row[0];
+    planes[2] = row[3] + row[1];
+    planes[3] = row[3] - row[1];
+    planes[4] = row[3] + row[2];
+    planes[5] = row[3] - row[2];
+    for (glm::vec4& plane : planes) plane /= glm::length(glm::vec3(plane));
+    glm::vec3 camera = glm::vec3(glm::inverse(model) * glm::vec4(cameraPosition, 1.0f));
+
+    std::vector<size_t> order;
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        Chunk& chunk = chunks[i];
+        chunk.visible = true;
+        for (const glm::vec4& plane : planes)
+            chunk.visible &= glm::dot(glm::vec3(plane), chunk.center) + plane.w >= -chunk.radius;
+        chunk.distance = std::max(glm::distance(camera, chunk.center) - chunk.radius, 0.0f);
+        if (chunk.visible) order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(),
+              [this](size_t a, size_t b) { return chunks[a].distance < chunks[b].distance; });
+
+    // Wanted: the nearest visible chunks whose detail fits the GPU budget
+    // together. Chunks not uploaded yet count with their file size, which
+    // over-estimates (meshlets stay on the CPU, positions may be quantized).
+    size_t planned = 0, wantedCount = 0;
+    for (size_t i : order)
+    {
+        Chunk& chunk = chunks[i];
+        size_t bytes = chunk.state == State::Resident ? chunk.gpuBytes : chunk.dataSize;
+        if (planned > 0 && planned + bytes > gpuBudget) break;
+        planned += bytes;
+        chunk.lastWanted = frame;
+        wantedCount++;
+    }
+
+    // Finished reads, and staging for chunks no longer wanted.
+    for (Chunk& chunk : chunks)
+    {
+        if (chunk.state == State::Loading &&
+            chunk.read.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            chunk.staged = chunk.read.get();
+            chunk.state = State::Staged;
+        }
+        if (chunk.state == State::Staged && chunk.lastWanted != frame)
+        {
+            stats.stagedBytes -= chunk.dataSize;
+            std::vector<unsigned char>().swap(chunk.staged);
+            chunk.state = State::Proxy;
+        }
+    }
+
+    // A lowered budget takes effect right away. Wanted chunks fit it by
+    // construction, except a lone one let through whatever its size, which
+    // must stay or it would be evicted and uploaded again every frame.
+    while (stats.residentBytes > gpuBudget)
+    {
+        size_t victim = evictionVictim();
+        if (victim == chunks.size()) break;
+        evict(victim);
+    }
+
+    // Upload nearest first. Resident chunks that are no longer wanted stay
+    // (turning back shows them at once) until their space is needed.
+    size_t uploaded = 0;
+    for (size_t n = 0; n < wantedCount; n++)
+    {
+        size_t i = order[n];
+        Chunk& chunk = chunks[i];
+        if (chunk.state != State::Staged) continue;
+        if (uploaded > 0 && uploaded + chunk.dataSize > uploadLimit) break;
+
+        bool room = true;
+        while (room && stats.residentBytes > 0 && stats.residentBytes + chunk.dataSize > gpuBudget)
+        {
+            size_t victim = evictionVictim();
+            if (victim == chunks.size()) room = false;
+            else evict(victim);
+        }
+        if (!room) continue;
+
+        upload(i);
+        uploaded += chunk.dataSize;
+    }
+
+    // Start reads nearest first, within the staging budget.
+    for (size_t n = 0; n < wantedCount; n++)
+    {
+        size_t i = order[n];
+        if (chunks[i].state != State::Proxy) continue;
+        if (stats.stagedBytes > 0 && stats.stagedBytes + chunks[i].dataSize > cpuBudget) break;
+        startRead(i);
+    }
+
+    stats.visible = order.size();
+    stats.resident = stats.loading = 0;
+    for (const Chunk& chunk : chunks)
+    {
+        if (chunk.state == State::Resident) stats.resident++;
+        else if (chunk.state != State::Proxy) stats.loading++;
+    }
+}
+
+size_t StreamingGeometry::evictionVictim() const
+{
+    // Least recently wanted first; of those, the farthest.
+    size_t victim = chunks.size();
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        const Chunk& chunk = chunks[i];
+        if (chunk.state != State::Resident || chunk.lastWanted == frame) continue;
+        if (victim == chunks.size() || chunk.lastWanted < chunks[victim].lastWanted ||
+            (chunk.lastWanted == chunks[victim].lastWanted && chunk.distance > chunks[victim].distance))
+            victim = i;
+    }
+    return victim;
+}
+
+void StreamingGeometry::startRead(size_t index)
+{
+    Chunk& chunk = chunks[index];
+    std::shared_ptr<MappedFile> mapped = file;
+    uint64_t offset = chunk.dataOffset, size = chunk.dataSize;
+    std::string asset = sourcePath;
+    chunk.read = ThreadPool::Get().Submit([mapped, offset, size, asset]() {
+        LoadProfiler::Scope scope("chunk-read", asset, size);
+        std::vector<unsigned char> bytes(mapped->Data() + offset, mapped->Data() + offset + size);
+        // Keep one copy in RAM, not two: the page cache refills these if the
+        // chunk is read again after an eviction.
+        mapped->Discard(offset, size);
+        return bytes;
+    });
+    chunk.state = State::Loading;
+    stats.stagedBytes += size;
+    stats.loads++;
+}
+
+void StreamingGeometry::upload(size_t index)
+{
+    Chunk& chunk = chunks[index];
+    LoadProfiler::Scope scope("chunk-upload", sourcePath, chunk.dataSize);
+    const unsigned char* data = chunk.staged.data();
+    for (const Part& part : chunk.parts)
+    {
+        chunk.detail.emplace_back(reinterpret_cast<const Vertex*>(data + part.vertexOffset), part.vertexCount,
+                                  reinterpret_cast<const unsigned int*>(data + part.indexOffset), part.indexCount,
+                                  reinterpret_cast<const Meshlet*>(data + part.meshletOffset), part.meshletCount,
+                                  nullptr, 0, materials[part.material]);
+        chunk.gpuBytes += chunk.detail.back().GpuBytes();
+    }
+    stats.stagedBytes -= chunk.dataSize;
+    std::vector<unsigned char>().swap(chunk.staged);
+    stats.residentBytes += chunk.gpuBytes;
+    chunk.state = State::Resident;
+}
+
+void StreamingGeometry::evict(size_t index)
+{
+    Chunk& chunk = chunks[index];
+    for (Mesh& mesh : chunk.detail) mesh.Release();
+    chunk.detail.clear();
+    stats.residentBytes -= chunk.gpuBytes;
+    chunk.gpuBytes = 0;
+    chunk.state = State::Proxy;
+    stats.evictions++;
+}
+
+void StreamingGeometry::Draw(Shader& shader, const std::vector<Texture>& extraTextures, const glm::mat4* model)
+{
+    for (Chunk& chunk : chunks)
+    {
+        if (!chunk.visible) continue;
+        for (Mesh& mesh : chunk.state == State::Resident ? chunk.detail : chunk.proxy)
+            mesh.Draw(shader, extraTextures, model);
+    }
+}
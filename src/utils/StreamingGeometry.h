@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "MappedFile.h"
+#include "Mesh.h"
+#include "Shader.h"
+
+// Out-of-core drawing for models too large to keep on the GPU (or in RAM)
+// whole. Bake() cuts the model into spatially compact chunks (median splits
+// of the triangle centroids along the longest axis) and writes a chunk file
+// next to the mesh cache entries: per chunk its optimized detail meshes, one
+// per source material, and a simplified proxy about 1/16 the size. Open()
+// maps that file and uploads only the proxies. Update() then streams the
+// detail of the nearest chunks in view: reads run on the ThreadPool into
+// staging memory bounded by the CPU budget, uploads happen on the GL thread,
+// and chunks out of view or too far down the list to fit the GPU budget are
+// evicted. Draw() shows a chunk's proxy until its detail has arrived.
+// Chunks always carry tangents, so any material may use a normal map.
+class StreamingGeometry
+{
+public:
+    struct Stats {
+        size_t chunks = 0;
+        size_t visible = 0;
+        size_t resident = 0;      // chunks with their detail on the GPU
+        size_t loading = 0;       // reads in flight or waiting for upload
+        size_t residentBytes = 0; // detail meshes on the GPU
+        size_t proxyBytes = 0;    // proxies, always resident
+        size_t stagedBytes = 0;   // read but not yet uploaded
+        size_t loads = 0;
+        size_t evictions = 0;
+    };
+
+    // Maps the chunk file for `path`, baking it first if it is missing or
+    // stale. Null if the model can't be imported or streamed.
+    static std::shared_ptr<StreamingGeometry> Open(const std::string& path);
+    // Writes the chunk file without GL, e.g. ahead of time. False if the model
+    // can't be imported or has embedded textures.
+    static bool Bake(const std::string& path);
+
+    ~StreamingGeometry();
+
+    StreamingGeometry(const StreamingGeometry&) = delete;
+    StreamingGeometry& operator=(const StreamingGeometry&) = delete;
+
+    // Once per frame on the GL thread, before Draw(): culls the chunks against
+    // the view, finishes reads, uploads and evicts. `cameraPosition` is in
+    // world space.
+    void Update(const glm::mat4& viewProjection, const glm::mat4& model, const glm::vec3& cameraPosition);
+    // Draws the chunks found visible by the last Update().
+    void Draw(Shader& shader, const std::vector<Texture>& extraTextures = {}, const glm::mat4* model = nullptr);
+
+    // Staging memory for reads in flight, and GPU memory for detail meshes.
+    // At least one chunk is always let through, whatever its size.
+    void SetBudget(size_t cpuBytes, size_t gpuBytes);
+    // Bytes of detail uploaded per Update(), so a burst of arrivals doesn't
+    // stall one frame.
+    void SetUploadLimit(size_t bytes) { uploadLimit = bytes; }
+    const Stats& GetStats() const { return stats; }
+
+    // Bounding sphere of the whole model, mesh space.
+    glm::vec3 BoundsCenter() const { return boundsCenter; }
+    float BoundsRadius() const { return boundsRadius; }
+
+private:
+    enum class State { Proxy, Loading, Staged, Resident };
+
+    struct Part {
+        uint32_t material;
+        uint32_t vertexCount, indexCount, meshletCount;
+        uint64_t vertexOffset, indexOffset, meshletOffset; // from the chunk's data
+    };
+
+    struct Chunk {
+        glm::vec3 center;
+        float radius;
+        uint64_t dataOffset, dataSize;
+        std::vector<Part> parts;
+        std::vector<Mesh> proxy;
+        std::vector<Mesh> detail;
+        State state = State::Proxy;
+        std::future<std::vector<unsigned char>> read;
+        std::vector<unsigned char> staged;
+        size_t gpuBytes = 0;
+        bool visible = false;
+        float distance = 0.0f;
+        uint64_t lastWanted = 0; // frame number, 0 = never
+    };
+
+    std::string sourcePath;
+    std::shared_ptr<MappedFile> file; // shared with reads still in flight
+    std::vector<Chunk> chunks;
+    std::vector<std::vector<Texture>> materials;
+    glm::vec3 boundsCenter{0.0f};
+    float boundsRadius = 0.0f;
+    size_t cpuBudget = 256ull << 20;
+    size_t gpuBudget = 512ull << 20;
+    size_t uploadLimit = 32ull << 20;
+    uint64_t frame = 0;
+    Stats stats;
+
+    StreamingGeometry() = default;
+
+    bool open(const std::string& path);
+    static std::string chunkPath(const std::string& path);
+    void startRead(size_t index);
+    void upload(size_t index);
+    void evict(size_t index);
+    // Resident chunk not wanted this frame to evict next, or chunks.size()
+    // if none may go.
+    size_t evictionVictim() const;
+};
@@ -0,0 +1,516 @@
+#include "TextureBaker.h"
+#include "AssetPack.h"
+#include "Hash.h"
+#include "LoadProfiler.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include "stb_image.h"
+
+extern "C" {
+#include "image_DXT.h"
+}
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    const unsigned int kBakeTag = 0x42525452; // "RTRB"
+
+    struct TextureBakerData {
+        std::mutex mutex;
+        std::vector<TextureBaker::BakeRecord> records;
+        bool enabled = true;
+        bool compression = true;
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "rtr-opengl" / "texture-cache";
+    };
+
+    TextureBakerData s_Data;
+
+    unsigned int fourCC(char a, char b, char c, char d)
+    {
+        return unsigned(a) | (unsigned(b) << 8) | (unsigned(c) << 16) | (unsigned(d) << 24);
+    }
+
+    size_t blockBytes(TextureCompression compression)
+    {
+        return compression == TextureCompression::BC1 ? 8 : 16;
+    }
+
+    size_t levelSize(TextureCompression compression, int channels, int width, int height)
+    {
+        if (compression == TextureCompression::None) return size_t(width) * height * channels;
+        return size_t((width + 3) / 4) * size_t((height + 3) / 4) * blockBytes(compression);
+    }
+
+    const char* compressionName(TextureCompression compression)
+    {
+        switch (compression)
+        {
+        case TextureCompression::BC1: return "BC1";
+        case TextureCompression::BC3: return "BC3";
+        case TextureCompression::BC5: return "BC5";
+        default: return "RGBA8";
+        }
+    }
+
+    // Bits a shader fetches per texel. Drivers pad RGB8 to 32 bits.
+    int bitsPerTexel(TextureCompression compression, int channels)
+    {
+        switch (compression)
+        {
+        case TextureCompression::BC1: return 4;
+        case TextureCompression::BC3:
+        case TextureCompression::BC5: return 8;
+        default: return channels == 3 ? 32 : channels * 8;
+        }
+    }
+
+    // One BC4 block (8 bytes) from 16 values, using the 8-interpolant mode.
+    void encodeBC4Block(const unsigned char values[16], unsigned char out[8])
+    {
+        int hi = values[0], lo = values[0];
+        for (int i = 1; i < 16; i++)
+        {
+            hi = std::max<int>(hi, values[i]);
+            lo = std::min<int>(lo, values[i]);
+        }
+        out[0] = static_cast<unsigned char>(hi);
+        out[1] = static_cast<unsigned char>(lo);
+
+        uint64_t bits = 0;
+        if (hi != lo)
+        {
+            // Palette index order for a0 > a1: a0, a1, then six interpolants
+            // running from a0 towards a1.
+            static const int kIndexForStep[8] = {1, 7, 6, 5, 4, 3, 2, 0};
+            for (int i = 0; i < 16; i++)
+            {
+                int step = ((values[i] - lo) * 7 + (hi - lo) / 2) / (hi - lo);
+                bits |= uint64_t(kIndexForStep[step]) << (3 * i);
+            }
+        }
+        for (int i = 0; i < 6; i++)
+            out[2 + i] = static_cast<unsigned char>(bits >> (8 * i));
+    }
+
+    // BC5 stores two BC4 blocks: red then green. Normal map z is rebuilt in the shader.
+    std::vector<unsigned char> encodeBC5(const unsigned char* src, int width, int height, int channels)
+    {
+        int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+        std::vector<unsigned char> out(size_t(blocksX) * blocksY * 16);
+        unsigned char red[16], green[16];
+        for (int by = 0; by < blocksY; by++)
+        {
+            for (int bx = 0; bx < blocksX; bx++)
+            {
+                for (int i = 0; i < 16; i++)
+                {
+                    int x = std::min(bx * 4 + (i & 3), width - 1);
+                    int y = std::min(by * 4 + (i >> 2), height - 1);
+                    const unsigned char* p = src + (size_t(y) * width + x) * channels;
+                    red[i] = p[0];
+                    green[i] = channels > 1 ? p[1] : p[0];
+                }
+                unsigned char* block = out.data() + (size_t(by) * blocksX + bx) * 16;
+                encodeBC4Block(red, block);
+                encodeBC4Block(green, block + 8);
+            }
+        }
+        return out;
+    }
+
+    std::vector<unsigned char> compressStrip(const unsigned char* src, int width, int height, int channels,
+                                             TextureCompression compression)
+    {
+        if (compression == TextureCompression::BC5) return encodeBC5(src, width, height, channels);
+
+        int size = 0;
+        unsigned char* blocks = compression == TextureCompression::BC3
+                                    ? convert_image_to_DXT5(src, width, height, channels, &size)
+                                    : convert_image_to_DXT1(src, width, height, channels, &size);
+        std::vector<unsigned char> out;
+        if (blocks)
+        {
+            out.assign(blocks, blocks + size);
+            std::free(blocks);
+        }
+        return out;
+    }
+
+    // Block rows are independent, so the level is compressed in strips of
+    // whole blocks on the pool and the strips land back to back.
+    std::vector<unsigned char> compressLevel(const unsigned char* src, int width, int height, int channels,
+                                             TextureCompression compression)
+    {
+        const int stripRows = 64;
+        int strips = (height + stripRows - 1) / stripRows;
+        size_t stripBytes = levelSize(compression, channels, width, stripRows);
+        std::vector<unsigned char> out(levelSize(compression, channels, width, height));
+        std::atomic<bool> failed{false};
+
+        ThreadPool::Get().ParallelFor(strips, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                int y = static_cast<int>(i) * stripRows;
+                int rows = std::min(stripRows, height - y);
+                std::vector<unsigned char> blocks =
+                    compressStrip(src + size_t(y) * width * channels, width, rows, channels, compression);
+                if (blocks.size() != levelSize(compression, channels, width, rows))
+                {
+                    failed = true;
+                    continue;
+                }
+                std::copy(blocks.begin(), blocks.end(), out.begin() + i * stripBytes);
+            }
+        });
+        if (failed) out.clear();
+        return out;
+    }
+
+    bool statSource(const std::string& path, unsigned long long& size, long long& mtime)
+    {
+        if (AssetPack::Stat(path, size, mtime)) return true;
+
+        std::error_code ec;
+        auto fileSize = std::filesystem::file_size(path, ec);
+        if (ec) return false;
+        auto time = std::filesystem::last_write_time(path, ec);
+        if (ec) return false;
+        size = static_cast<unsigned long long>(fileSize);
+        mtime = static_cast<long long>(time.time_since_epoch().count());
+        return true;
+    }
+
+    std::filesystem::path entryPath(const std::string& path, TextureCompression compression, const MipSettings& mips)
+    {
+        std::error_code ec;
+        std::string key = std::filesystem::weakly_canonical(path, ec).generic_string();
+        if (ec) key = path;
+
+        uint64_t h = HashCombine(HashString(key), static_cast<uint64_t>(compression));
+        h = HashCombine(h, static_cast<uint64_t>(mips.filter) | (static_cast<uint64_t>(mips.colorSpace) << 8) |
+                               (static_cast<uint64_t>(mips.wrap) << 16));
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.dds", static_cast<unsigned long long>(h));
+        return s_Data.directory / name;
+    }
+
+    void record(const std::string& path, const TextureImage& image, bool fromCache)
+    {
+        size_t texels = size_t(image.width) * image.height;
+        TextureBaker::BakeRecord r;
+        r.path = path;
+        r.width = image.width;
+        r.height = image.height;
+        r.channels = image.channels;
+        r.compression = image.compression;
+        r.uncompressedBytes = texels * bitsPerTexel(TextureCompression::None, image.channels) / 8 * 4 / 3;
+        r.bakedBytes = image.data.size();
+        r.fromCache = fromCache;
+
+        std::lock_guard<std::mutex> lock(s_Data.mutex);
+        s_Data.records.push_back(r);
+    }
+}
+
+GLenum TextureImage::InternalFormat() const
+{
+    switch (compression)
+    {
+    case TextureCompression::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case TextureCompression::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case TextureCompression::BC5: return GL_COMPRESSED_RG_RGTC2;
+    default: return Format();
+    }
+}
+
+GLenum TextureImage::Format() const
+{
+    if (channels == 1) return GL_RED;
+    if (channels == 2) return GL_RG;
+    if (channels == 4) return GL_RGBA;
+    return GL_RGB;
+}
+
+void TextureBaker::SetEnabled(bool enabled)
+{
+    s_Data.enabled = enabled;
+}
+
+bool TextureBaker::IsEnabled()
+{
+    return s_Data.enabled;
+}
+
+void TextureBaker::SetCompressionEnabled(bool enabled)
+{
+    s_Data.compression = enabled;
+}
+
+void TextureBaker::SetDirectory(const std::filesystem::path& dir)
+{
+    s_Data.directory = dir;
+}
+
+const std::filesystem::path& TextureBaker::GetDirectory()
+{
+    return s_Data.directory;
+}
+
+TextureCompression TextureBaker::ChooseCompression(int channels, TexturePlaceholder usage)
+{
+    if (!s_Data.compression) return TextureCompression::None;
+    if (usage == TexturePlaceholder::FlatNormal) return TextureCompression::BC5;
+    return channels == 4 ? TextureCompression::BC3 : TextureCompression::BC1;
+}
+
+MipSettings TextureBaker::MipSettingsFor(TexturePlaceholder usage, bool wrap)
+{
+    MipSettings settings;
+    settings.wrap = wrap;
+    if (usage == TexturePlaceholder::FlatNormal) settings.colorSpace = MipColorSpace::Normal;
+    else if (usage == TexturePlaceholder::Black) settings.colorSpace = MipColorSpace::Linear;
+    return settings;
+}
+
+bool TextureBaker::Bake(const unsigned char* pixels, int width, int height, int channels,
+                        TextureCompression compression, const MipSettings& mips, TextureImage& out)
+{
+    if (!pixels || width < 1 || height < 1) return false;
+
+    TextureImage chain;
+    MipGenerator::Build(pixels, width, height, channels, mips, chain);
+    if (compression == TextureCompression::None)
+    {
+        out = std::move(chain);
+        return true;
+    }
+
+    TextureImage image;
+    image.width = width;
+    image.height = height;
+    image.channels = channels;
+    image.compression = compression;
+    for (const TextureLevel& level : chain.levels)
+    {
+        std::vector<unsigned char> blocks =
+            compressLevel(chain.data.data() + level.offset, level.width, level.height, channels, compression);
+        if (blocks.empty()) return false;
+
+        image.levels.push_back({level.width, level.height, image.data.size(), blocks.size()});
+        image.data.insert(image.data.end(), blocks.begin(), blocks.end());
+    }
+
+    out = std::move(image);
+    return true;
+}
+
+bool TextureBaker::WriteDDS(const std::filesystem::path& path, const TextureImage& image,
+                            unsigned long long sourceSize, long long sourceMtime)
+{
+    DDS_header header;
+    std::memset(&header, 0, sizeof(header));
+    header.dwMagic = fourCC('D', 'D', 'S', ' ');
+    header.dwSize = 124;
+    header.dwFlags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+    header.dwHeight = image.height;
+    header.dwWidth = image.width;
+    header.dwPitchOrLinearSize = image.levels.empty() ? 0 : static_cast<unsigned int>(image.levels[0].size);
+    header.dwMipMapCount = static_cast<unsigned int>(image.levels.size());
+    header.dwReserved1[0] = kBakeTag;
+    header.dwReserved1[1] = Version;
+    header.dwReserved1[2] = image.channels;
+    header.dwReserved1[3] = static_cast<unsigned int>(sourceSize);
+    header.dwReserved1[4] = static_cast<unsigned int>(sourceSize >> 32);
+    header.dwReserved1[5] = static_cast<unsigned int>(sourceMtime);
+    header.dwReserved1[6] = static_cast<unsigned int>(static_cast<unsigned long long>(sourceMtime) >> 32);
+    header.sPixelFormat.dwSize = 32;
+    header.sPixelFormat.dwFlags = DDPF_FOURCC;
+    switch (image.compression)
+    {
+    case TextureCompression::BC1: header.sPixelFormat.dwFourCC = fourCC('D', 'X', 'T', '1'); break;
+    case TextureCompression::BC3: header.sPixelFormat.dwFourCC = fourCC('D', 'X', 'T', '5'); break;
+    case TextureCompression::BC5: header.sPixelFormat.dwFourCC = fourCC('A', 'T', 'I', '2'); break;
+    default:
+        // Uncompressed chains keep the source channel order, R in the lowest byte.
+        header.sPixelFormat.dwFlags = DDPF_RGB | (image.channels == 4 ? DDPF_ALPHAPIXELS : 0);
+        header.sPixelFormat.dwRGBBitCount = 8 * image.channels;
+        header.sPixelFormat.dwRBitMask = 0x000000ff;
+        header.sPixelFormat.dwGBitMask = image.channels > 1 ? 0x0000ff00 : 0;
+        header.sPixelFormat.dwBBitMask = image.channels > 2 ? 0x00ff0000 : 0;
+        header.sPixelFormat.dwAlphaBitMask = image.channels > 3 ? 0xff000000 : 0;
+        break;
+    }
+    header.sCaps.dwCaps1 = DDSCAPS_TEXTURE | DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    // Several workers may bake the same file; the rename keeps readers from
+    // ever seeing a partial entry.
+    std::filesystem::path temp = path;
+    temp += "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(image.data.data()), static_cast<std::streamsize>(image.data.size()));
+        if (!out) return false;
+    }
+    std::filesystem::rename(temp, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+bool TextureBaker::ReadDDS(const std::filesystem::path& path, TextureImage& out, unsigned long long sourceSize,
+                           long long sourceMtime)
+{
+    MappedFile file;
+    if (!file.Open(path.string()) || file.Size() < sizeof(DDS_header)) return false;
+
+    DDS_header header;
+    std::memcpy(&header, file.Data(), sizeof(header));
+    unsigned long long size = header.dwReserved1[3] | (static_cast<unsigned long long>(header.dwReserved1[4]) << 32);
+    long long mtime = static_cast<long long>(header.dwReserved1[5] |
+                                             (static_cast<unsigned long long>(header.dwReserved1[6]) << 32));
+    if (header.dwMagic != fourCC('D', 'D', 'S', ' ') || header.dwReserved1[0] != kBakeTag ||
+        header.dwReserved1[1] != Version || size != sourceSize || mtime != sourceMtime)
+        return false;
+
+    TextureImage image;
+    image.width = static_cast<int>(header.dwWidth);
+    image.height = static_cast<int>(header.dwHeight);
+    image.channels = static_cast<int>(header.dwReserved1[2]);
+    if (header.sPixelFormat.dwFourCC == fourCC('D', 'X', 'T', '1')) image.compression = TextureCompression::BC1;
+    else if (header.sPixelFormat.dwFourCC == fourCC('D', 'X', 'T', '5')) image.compression = TextureCompression::BC3;
+    else if (header.sPixelFormat.dwFourCC == fourCC('A', 'T', 'I', '2')) image.compression = TextureCompression::BC5;
+    else if (header.sPixelFormat.dwFlags & DDPF_FOURCC) return false;
+    else image.compression = TextureCompression::None;
+    if (image.channels < 1 || image.channels > 4) return false;
+
+    size_t offset = 0;
+    int w = image.width, h = image.height;
+    for (unsigned int i = 0; i < std::max(1u, header.dwMipMapCount); i++)
+    {
+        size_t bytes = levelSize(image.compression, image.channels, w, h);
+        image.levels.push_back({w, h, offset, bytes});
+        offset += bytes;
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+    if (file.Size() - sizeof(DDS_header) < offset) return false;
+
+    image.data.assign(file.Data() + sizeof(DDS_header), file.Data() + sizeof(DDS_header) + offset);
+    out = std::move(image);
+    return true;
+}
+
+unsigned char* TextureBaker::DecodeFile(const std::string& path, int& width, int& height, int& channels,
+                                        int desiredChannels)
+{
+    LoadProfiler::Scope scope("stbi-load", path);
+    MappedFile file;
+    if (!file.Open(path) || file.Size() > INT_MAX) return nullptr;
+    unsigned char* pixels = stbi_load_from_memory(file.Data(), static_cast<int>(file.Size()), &width, &height,
+                                                  &channels, desiredChannels);
+    if (pixels) scope.AddBytes(size_t(width) * height * (desiredChannels ? desiredChannels : channels));
+    return pixels;
+}
+
+bool TextureBaker::LoadOrBake(const std::string& path, TexturePlaceholder usage, bool wrap, TextureImage& out)
+{
+    unsigned long long sourceSize;
+    long long sourceMtime;
+    if (!statSource(path, sourceSize, sourceMtime)) return false;
+
+    // The compression choice depends on the channel count, which the cheap
+    // header probe gives us without decoding.
+    MappedFile source;
+    if (!source.Open(path) || source.Size() > INT_MAX) return false;
+    int width, height, channels;
+    if (!stbi_info_from_memory(source.Data(), static_cast<int>(source.Size()), &width, &height, &channels))
+        return false;
+    TextureCompression compression = ChooseCompression(channels, usage);
+    MipSettings mips = MipSettingsFor(usage, wrap);
+    std::filesystem::path entry = entryPath(path, compression, mips);
+
+    {
+        LoadProfiler::Scope scope("dds-read", path);
+        if (ReadDDS(entry, out, sourceSize, sourceMtime))
+        {
+            scope.AddBytes(out.data.size());
+            record(path, out, true);
+            return true;
+        }
+    }
+
+    LoadProfiler::Clock::time_point start = LoadProfiler::Clock::now();
+    unsigned char* pixels =
+        stbi_load_from_memory(source.Data(), static_cast<int>(source.Size()), &width, &height, &channels, 0);
+    if (!pixels) return false;
+    LoadProfiler::Record("stbi-load", path, start, LoadProfiler::Clock::now(), size_t(width) * height * channels);
+#ifdef RTR_VALIDATE_MIPS
+    int diff = MipGenerator::CompareWithBaseline(pixels, width, height, channels);
+    if (diff > 1) std::cout << "ERROR::TEXTURE_BAKER:: mip level 1 differs from mipmap_image by " << diff << ": " << path << std::endl;
+#endif
+    start = LoadProfiler::Clock::now();
+    bool baked = Bake(pixels, width, height, channels, compression, mips, out);
+    stbi_image_free(pixels);
+    if (!baked) return false;
+    LoadProfiler::Record("bake", path, start, LoadProfiler::Clock::now(), out.data.size());
+
+    LoadProfiler::Scope scope("dds-write", path, out.data.size());
+    if (!WriteDDS(entry, out, sourceSize, sourceMtime))
+        std::cout << "ERROR::TEXTURE_BAKER:: cannot write " << entry.string() << std::endl;
+    record(path, out, false);
+    return true;
+}
+
+std::vector<TextureBaker::BakeRecord> TextureBaker::GetReport()
+{
+    std::lock_guard<std::mutex> lock(s_Data.mutex);
+    return s_Data.records;
+}
+
+void TextureBaker::LogReport()
+{
+    std::vector<BakeRecord> records = GetReport();
+    if (records.empty()) return;
+
+    size_t before = 0, after = 0;
+    double bitsBefore = 0.0, bitsAfter = 0.0, texels = 0.0;
+    std::cout << "Texture bake report:" << std::endl;
+    for (const BakeRecord& r : records)
+    {
+        double n = double(r.width) * r.height;
+        before += r.uncompressedBytes;
+        after += r.bakedBytes;
+        texels += n;
+        bitsBefore += n * bitsPerTexel(TextureCompression::None, r.channels);
+        bitsAfter += n * bitsPerTexel(r.compression, r.channels);
+
+        std::cout << "  " << std::setw(4) << compressionName(r.compression) << " " << r.width << "x" << r.height
+                  << (r.fromCache ? " (cached) " : " (baked)  ") << std::fixed << std::setprecision(2)
+                  << r.uncompressedBytes / 1048576.0 << " MB -> " << r.bakedBytes / 1048576.0 << " MB  "
+                  << r.path << std::endl;
+    }
+    std::cout << "  total VRAM " << before / 1048576.0 << " MB -> " << after / 1048576.0 << " MB, saved "
+              << (before - std::min(before, after)) / 1048576.0 << " MB" << std::endl;
+    if (texels > 0.0)
+        std::cout << "  texture fetch " << bitsBefore / texels << " -> " << bitsAfter / texels
+                  << " bits/texel" << std::endl;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "MipGenerator.h"
+#include "TextureLoader.h"
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+enum class TextureCompression {
+    None,
+    BC1,
+    BC3,
+    BC5
+};
+
+struct TextureLevel {
+    int width;
+    int height;
+    size_t offset;
+    size_t size;
+};
+
+// A full mip chain ready for upload, all levels back to back in `data`.
+struct TextureImage {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    TextureCompression compression = TextureCompression::None;
+    std::vector<TextureLevel> levels;
+    std::vector<unsigned char> data;
+
+    bool IsCompressed() const { return compression != TextureCompression::None; }
+    GLenum InternalFormat() const;
+    GLenum Format() const;
+};
+
+// Bakes source images into block-compressed mip chains and keeps them as DDS
+// files in a cache directory, so later runs upload with glCompressedTexImage2D
+// and never decode the JPEG/TGA again. Colour maps become BC1 (BC3 with alpha),
+// normal maps BC5. With compression disabled the MipGenerator chain is cached
+// as plain RGB(A)8 instead. Entries are validated against the source size and mtime.
+class TextureBaker
+{
+public:
+    static constexpr unsigned int Version = 2;
+
+    struct BakeRecord {
+        std::string path;
+        int width;
+        int height;
+        int channels;
+        TextureCompression compression;
+        size_t uncompressedBytes;
+        size_t bakedBytes;
+        bool fromCache;
+    };
+
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+    static void SetCompressionEnabled(bool enabled);
+    static void SetDirectory(const std::filesystem::path& dir);
+    static const std::filesystem::path& GetDirectory();
+
+    static TextureCompression ChooseCompression(int channels, TexturePlaceholder usage);
+    static MipSettings MipSettingsFor(TexturePlaceholder usage, bool wrap);
+
+    // Thread-safe; runs on loader workers. `wrap` selects how the mip filter
+    // treats the image edges and is part of the cache key.
+    static bool LoadOrBake(const std::string& path, TexturePlaceholder usage, bool wrap, TextureImage& out);
+    static bool Bake(const unsigned char* pixels, int width, int height, int channels, TextureCompression compression,
+                     const MipSettings& mips, TextureImage& out);
+
+    // stbi_load from a MappedFile, so images in a mounted AssetPack decode
+    // straight out of the pack. Free the pixels with stbi_image_free.
+    static unsigned char* DecodeFile(const std::string& path, int& width, int& height, int& channels,
+                                     int desiredChannels = 0);
+
+    static bool WriteDDS(const std::filesystem::path& path, const TextureImage& image, unsigned long long sourceSize,
+                         long long sourceMtime);
+    static bool ReadDDS(const std::filesystem::path& path, TextureImage& out, unsigned long long sourceSize,
+                        long long sourceMtime);
+
+    // Bytes saved and per-texel fetch cost before/after for everything baked or
+    // loaded from the bake cache so far.
+    static std::vector<BakeRecord> GetReport();
+    static void LogReport();
+};
@@ -0,0 +1,142 @@
+#include "TextureCache.h"
+
+#include <filesystem>
+#include <unordered_map>
+
+namespace
+{
+    struct Entry {
+        unsigned int textureID = 0;
+        size_t refCount = 0;
+    };
+
+    // How a texture loaded from a file was asked for, to decode it again.
+    struct FileSource {
+        std::string path;
+        TextureSettings settings;
+        TexturePlaceholder placeholder;
+    };
+
+    struct TextureCacheData {
+        std::unordered_map<std::string, Entry> entries;
+        std::unordered_map<unsigned int, std::string> keysById;
+        std::unordered_map<unsigned int, FileSource> sourcesById;
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+    TextureCacheData s_Data;
+
+    std::string canonicalPath(const std::string& path)
+    {
+        std::error_code ec;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(std::filesystem::absolute(path, ec), ec);
+        return ec ? path : canonical.generic_string();
+    }
+
+    std::string settingsKey(const TextureSettings& settings)
+    {
+        return "|" + std::to_string(settings.wrap) + "," + std::to_string(settings.minFilter) + "," +
+               std::to_string(settings.magFilter);
+    }
+}
+
+unsigned int TextureCache::acquire(const std::string& key, const std::function<unsigned int()>& load)
+{
+    auto it = s_Data.entries.find(key);
+    if (it != s_Data.entries.end())
+    {
+        s_Data.hits++;
+        it->second.refCount++;
+        return it->second.textureID;
+    }
+
+    s_Data.misses++;
+    unsigned int textureID = load();
+    if (textureID == 0) return 0;
+
+    s_Data.entries.emplace(key, Entry{textureID, 1});
+    s_Data.keysById.emplace(textureID, key);
+    return textureID;
+}
+
+unsigned int TextureCache::Acquire(const std::string& path, const TextureSettings& settings,
+                                   TexturePlaceholder placeholder)
+{
+    std::string canonical = canonicalPath(path);
+    unsigned int textureID = acquire(canonical + settingsKey(settings),
+                                     [&]() { return TextureLoader::LoadAsync(path, settings, placeholder); });
+    if (textureID != 0) s_Data.sourcesById.emplace(textureID, FileSource{canonical, settings, placeholder});
+    return textureID;
+}
+
+unsigned int TextureCache::AcquireFromMemory(const std::string& key, const unsigned char* data, size_t size,
+                                             const TextureSettings& settings, TexturePlaceholder placeholder)
+{
+    return acquire(key + settingsKey(settings),
+                   [&]() { return TextureLoader::LoadFromMemoryAsync(data, size, settings, placeholder); });
+}
+
+unsigned int TextureCache::AcquireCubemap(const std::vector<std::string>& faces, bool async)
+{
+    std::string key = "cube:";
+    for (const std::string& face : faces)
+        key += canonicalPath(face) + ";";
+
+    return acquire(key, [&]() {
+        return async ? TextureLoader::LoadCubemapAsync(faces) : TextureLoader::LoadCubemap(faces);
+    });
+}
+
+unsigned int TextureCache::AcquireEnvironment(const std::vector<std::string>& faces)
+{
+    std::string key = "ggx:";
+    for (const std::string& face : faces)
+        key += canonicalPath(face) + ";";
+
+    return acquire(key, [&]() { return TextureLoader::LoadEnvironment(faces); });
+}
+
+void TextureCache::Release(unsigned int textureID)
+{
+    auto byId = s_Data.keysById.find(textureID);
+    if (byId == s_Data.keysById.end()) return;
+
+    auto it = s_Data.entries.find(byId->second);
+    if (it != s_Data.entries.end() && --it->second.refCount > 0) return;
+
+    if (it != s_Data.entries.end()) s_Data.entries.erase(it);
+    s_Data.keysById.erase(byId);
+    s_Data.sourcesById.erase(textureID);
+    TextureLoader::Release(textureID);
+}
+
+std::vector<unsigned int> TextureCache::Reload(const std::string& path)
+{
+    std::string canonical = canonicalPath(path);
+    std::vector<unsigned int> reloaded;
+    for (const auto& [textureID, source] : s_Data.sourcesById)
+    {
+        if (source.path == canonical &&
+            TextureLoader::Reload(textureID, source.path, source.settings, source.placeholder))
+            reloaded.push_back(textureID);
+    }
+    return reloaded;
+}
+
+TextureCache::Stats TextureCache::GetStats()
+{
+    Stats stats;
+    stats.hits = s_Data.hits;
+    stats.misses = s_Data.misses;
+    stats.entries = s_Data.entries.size();
+    for (const auto& entry : s_Data.entries)
+        stats.residentBytes += TextureLoader::ResidentBytes(entry.second.textureID);
+    return stats;
+}
+
+void TextureCache::ResetStats()
+{
+    s_Data.hits = 0;
+    s_Data.misses = 0;
+}
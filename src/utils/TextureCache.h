@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "TextureLoader.h"
+
+// Process-wide, reference-counted texture registry. Every image is keyed by its
+// canonical absolute path plus sampler settings, so all Models, Skyboxes and
+// manual AddTexture calls share one GPU texture per image. Each Acquire must be
+// paired with a Release of the returned id.
+class TextureCache
+{
+public:
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t entries = 0;
+        size_t residentBytes = 0;
+    };
+
+    // Returns 0 if the file does not exist.
+    static unsigned int Acquire(const std::string& path, const TextureSettings& settings = {},
+                                TexturePlaceholder placeholder = TexturePlaceholder::Grey);
+    // `key` names the encoded bytes, e.g. "<model path>#<embedded name>".
+    static unsigned int AcquireFromMemory(const std::string& key, const unsigned char* data, size_t size,
+                                          const TextureSettings& settings = {},
+                                          TexturePlaceholder placeholder = TexturePlaceholder::Grey);
+    // `async` decodes in the background (see TextureLoader::LoadCubemapAsync);
+    // either way later calls for the same faces share the texture.
+    static unsigned int AcquireCubemap(const std::vector<std::string>& faces, bool async = false);
+    // The faces' GGX roughness chain, a separate texture from AcquireCubemap's.
+    static unsigned int AcquireEnvironment(const std::vector<std::string>& faces);
+
+    static void Release(unsigned int textureID);
+
+    // Decodes every texture Acquire()d from `path` again, in place (see
+    // TextureLoader::Reload). Returns the ids being reloaded.
+    static std::vector<unsigned int> Reload(const std::string& path);
+
+    static Stats GetStats();
+    static void ResetStats();
+
+private:
+    static unsigned int acquire(const std::string& key, const std::function<unsigned int()>& load);
+};
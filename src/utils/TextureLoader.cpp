@@ -0,0 +1,812 @@
+#include "TextureLoader.h"
+#include "AssetPack.h"
+#include "EnvironmentPrefilter.h"
+#include "LoadProfiler.h"
+#include "TextureBaker.h"
+#include "ThreadPool.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+    const size_t kSlotCount = 4;
+
+    struct DecodedImage {
+        unsigned int textureID = 0;
+        TextureSettings settings;
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        std::unique_ptr<unsigned char, void (*)(void*)> pixels{nullptr, stbi_image_free};
+        // Set instead of `pixels` when the image came through the TextureBaker.
+        TextureImage baked;
+        // Re-decoded for a texture that already shows an image (hot reload).
+        bool replace = false;
+        std::string source;
+
+        bool IsValid() const { return pixels || !baked.levels.empty(); }
+        size_t Bytes() const
+        {
+            if (!baked.levels.empty()) return baked.data.size();
+            return size_t(width) * height * channels;
+        }
+    };
+
+    // One cubemap face, decoded off the GL thread: a baked chain when the
+    // TextureBaker has one, else the stb_image pixels.
+    struct CubeFace {
+        TextureImage baked;
+        std::unique_ptr<unsigned char, void (*)(void*)> pixels{nullptr, stbi_image_free};
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+
+        size_t Bytes() const { return baked.levels.empty() ? size_t(width) * height * channels : baked.data.size(); }
+    };
+
+    struct DecodedCubemap {
+        unsigned int textureID = 0;
+        std::vector<std::string> paths;
+        std::vector<CubeFace> faces;
+
+        size_t Bytes() const
+        {
+            size_t bytes = 0;
+            for (const CubeFace& face : faces) bytes += face.Bytes();
+            return bytes;
+        }
+    };
+
+    struct UploadSlot {
+        GLuint pbo = 0;
+        GLsizeiptr capacity = 0;
+        GLsync fence = nullptr;
+    };
+
+    // A baked chain whose levels are uploaded smallest first across frames.
+    // `residentLevel` is the finest level on the GPU so far.
+    struct StreamingTexture {
+        unsigned int textureID = 0;
+        TextureImage image;
+        int residentLevel = 0;
+        std::string source;
+
+        const TextureLevel& NextLevel() const { return image.levels[residentLevel - 1]; }
+    };
+
+    struct TextureLoaderData {
+        std::mutex mutex;
+        std::deque<DecodedImage> ready;
+        std::deque<DecodedCubemap> readyCubemaps;
+        std::atomic<size_t> inFlight{0};
+
+        // GL thread only.
+        std::unordered_set<unsigned int> pending;
+        std::unordered_set<unsigned int> releasedWhilePending;
+        std::unordered_map<unsigned int, size_t> residentBytes;
+        std::vector<StreamingTexture> streaming;
+
+        UploadSlot slots[kSlotCount];
+        size_t nextSlot = 0;
+        size_t uploadBudget = 32 * 1024 * 1024;
+    };
+
+    TextureLoaderData s_Data;
+
+    GLenum formatFor(int channels)
+    {
+        if (channels == 1) return GL_RED;
+        if (channels == 2) return GL_RG;
+        if (channels == 4) return GL_RGBA;
+        return GL_RGB;
+    }
+
+    void setSamplerState(const TextureSettings& settings)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, settings.wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, settings.wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, settings.minFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, settings.magFilter);
+    }
+
+    size_t mipChainBytes(size_t baseBytes)
+    {
+        return baseBytes + baseBytes / 3;
+    }
+
+    void publish(DecodedImage image, const std::string& source)
+    {
+        if (!image.IsValid())
+            std::cout << "Texture failed to load at path: " << source << std::endl;
+
+        image.source = source;
+        std::lock_guard<std::mutex> lock(s_Data.mutex);
+        s_Data.ready.push_back(std::move(image));
+    }
+
+    // Returns false when the slot's previous upload is still being read by the GPU.
+    bool acquireSlot(UploadSlot& slot)
+    {
+        if (slot.fence)
+        {
+            GLenum status = glClientWaitSync(slot.fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED) return false;
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+        if (slot.pbo == 0) glGenBuffers(1, &slot.pbo);
+        return true;
+    }
+
+    // Levels at or below this size go up together with the storage allocation,
+    // so a streamed texture is never sampled before it has any level resident.
+    const size_t kTailBytes = 16 * 1024;
+
+    GLenum sizedFormat(const TextureImage& image)
+    {
+        if (image.IsCompressed()) return image.InternalFormat();
+        if (image.channels == 1) return GL_R8;
+        if (image.channels == 2) return GL_RG8;
+        if (image.channels == 4) return GL_RGBA8;
+        return GL_RGB8;
+    }
+
+    void setResidentLevel(StreamingTexture& texture, int level)
+    {
+        texture.residentLevel = level;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_LOD, static_cast<float>(level));
+    }
+
+    void uploadLevel(const TextureImage& image, int index, const void* src)
+    {
+        const TextureLevel& level = image.levels[index];
+        if (image.IsCompressed())
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, index, 0, 0, level.width, level.height, image.InternalFormat(),
+                                      static_cast<GLsizei>(level.size), src);
+        else
+            glTexSubImage2D(GL_TEXTURE_2D, index, 0, 0, level.width, level.height, image.Format(), GL_UNSIGNED_BYTE,
+                            src);
+    }
+
+    // Mutable storage for every level of the bound texture.
+    void defineLevels(const TextureImage& image)
+    {
+        for (size_t i = 0; i < image.levels.size(); i++)
+        {
+            const TextureLevel& level = image.levels[i];
+            GLint index = static_cast<GLint>(i);
+            if (image.IsCompressed())
+                glCompressedTexImage2D(GL_TEXTURE_2D, index, image.InternalFormat(), level.width, level.height, 0,
+                                       static_cast<GLsizei>(level.size), nullptr);
+            else
+                glTexImage2D(GL_TEXTURE_2D, index, sizedFormat(image), level.width, level.height, 0, image.Format(),
+                             GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+
+    // Replaces the placeholder with storage for the whole chain (immutable when
+    // the context has glTexStorage2D) and uploads the small tail levels.
+    // Returns the bytes uploaded.
+    size_t beginStreaming(StreamingTexture& texture, const TextureSettings& settings)
+    {
+        const TextureImage& image = texture.image;
+        GLsizei levelCount = static_cast<GLsizei>(image.levels.size());
+        LoadProfiler::Scope scope("tex-storage", texture.source);
+
+        glBindTexture(GL_TEXTURE_2D, texture.textureID);
+        if (GLAD_GL_VERSION_4_2 && glTexStorage2D)
+            glTexStorage2D(GL_TEXTURE_2D, levelCount, sizedFormat(image), image.width, image.height);
+        else
+            defineLevels(image);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+        setSamplerState(settings);
+
+        size_t bytes = 0;
+        int level = levelCount;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        while (level > 0 && (level == levelCount || image.levels[level - 1].size <= kTailBytes))
+        {
+            level--;
+            uploadLevel(image, level, image.data.data() + image.levels[level].offset);
+            bytes += image.levels[level].size;
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        setResidentLevel(texture, level);
+        s_Data.residentBytes[texture.textureID] = bytes;
+        scope.AddBytes(bytes);
+        return bytes;
+    }
+
+    void streamLevel(StreamingTexture& texture, UploadSlot& slot)
+    {
+        int index = texture.residentLevel - 1;
+        const TextureLevel& level = texture.image.levels[index];
+        GLsizeiptr bytes = static_cast<GLsizeiptr>(level.size);
+        LoadProfiler::Scope scope("stream-level", texture.source, level.size);
+        const unsigned char* pixels = texture.image.data.data() + level.offset;
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.pbo);
+        if (slot.capacity < bytes)
+        {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+            slot.capacity = bytes;
+        }
+        void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (dst)
+        {
+            std::memcpy(dst, pixels, level.size);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        else
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+
+        glBindTexture(GL_TEXTURE_2D, texture.textureID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        uploadLevel(texture.image, index, dst ? nullptr : pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        setResidentLevel(texture, index);
+        s_Data.residentBytes[texture.textureID] += level.size;
+
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    void finishLoad(unsigned int textureID)
+    {
+        s_Data.pending.erase(textureID);
+        s_Data.inFlight--;
+    }
+
+    // Uploads the globally smallest missing level first, so every streamed
+    // texture gets a usable low-res version before any one of them gets sharp.
+    void streamLevels(size_t& uploaded)
+    {
+        std::vector<StreamingTexture>& streaming = s_Data.streaming;
+        for (size_t i = 0; i < streaming.size();)
+        {
+            unsigned int id = streaming[i].textureID;
+            if (s_Data.releasedWhilePending.erase(id))
+            {
+                glDeleteTextures(1, &id);
+                s_Data.residentBytes.erase(id);
+                finishLoad(id);
+                streaming[i] = std::move(streaming.back());
+                streaming.pop_back();
+                continue;
+            }
+            i++;
+        }
+
+        while (!streaming.empty())
+        {
+            size_t next = 0;
+            for (size_t i = 1; i < streaming.size(); i++)
+            {
+                if (streaming[i].NextLevel().size < streaming[next].NextLevel().size) next = i;
+            }
+
+            size_t bytes = streaming[next].NextLevel().size;
+            if (uploaded > 0 && uploaded + bytes > s_Data.uploadBudget) break;
+            UploadSlot& slot = s_Data.slots[s_Data.nextSlot];
+            if (!acquireSlot(slot)) break;
+
+            streamLevel(streaming[next], slot);
+            s_Data.nextSlot = (s_Data.nextSlot + 1) % kSlotCount;
+            uploaded += bytes;
+
+            if (streaming[next].residentLevel == 0)
+            {
+                finishLoad(streaming[next].textureID);
+                streaming[next] = std::move(streaming.back());
+                streaming.pop_back();
+            }
+        }
+    }
+
+    // A reloaded image goes up whole in one frame, so the texture never shows
+    // a mix of old and new levels. Immutable storage can only take an image
+    // of the same size and format; anything else needs a restart. Returns
+    // true when handled here, false to go through upload().
+    bool replaceImage(DecodedImage& image, size_t& uploaded)
+    {
+        GLint immutable = 0;
+        glBindTexture(GL_TEXTURE_2D, image.textureID);
+        if (GLAD_GL_VERSION_4_2) glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_IMMUTABLE_FORMAT, &immutable);
+        const TextureImage& baked = image.baked;
+        if (baked.levels.empty() && !immutable) return false;
+
+        if (immutable)
+        {
+            GLint width = 0, height = 0, format = 0, levels = 0;
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &format);
+            glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_IMMUTABLE_LEVELS, &levels);
+            if (baked.levels.empty() || width != baked.width || height != baked.height ||
+                static_cast<GLenum>(format) != sizedFormat(baked) || static_cast<size_t>(levels) != baked.levels.size())
+            {
+                std::cout << "ERROR::TEXTURE_LOADER:: reloaded image no longer fits texture " << image.textureID
+                          << " (size or format changed); restart to see it" << std::endl;
+                return true;
+            }
+        }
+        else
+        {
+            defineLevels(baked);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(baked.levels.size()) - 1);
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (size_t i = 0; i < baked.levels.size(); i++)
+            uploadLevel(baked, static_cast<int>(i), baked.data.data() + baked.levels[i].offset);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_LOD, 0.0f);
+        setSamplerState(image.settings);
+        s_Data.residentBytes[image.textureID] = baked.data.size();
+        uploaded += baked.data.size();
+        return true;
+    }
+
+    // The timings are what the calls cost this thread; a driver that defers
+    // the copy or the mip build shows up on a later frame instead.
+    void upload(const DecodedImage& image, UploadSlot& slot)
+    {
+        GLsizeiptr bytes = GLsizeiptr(image.width) * image.height * image.channels;
+        LoadProfiler::Clock::time_point start = LoadProfiler::Clock::now();
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.pbo);
+        if (slot.capacity < bytes)
+        {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+            slot.capacity = bytes;
+        }
+
+        // The fence guarantees the previous transfer out of this slot finished.
+        void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (dst)
+        {
+            std::memcpy(dst, image.pixels.get(), static_cast<size_t>(bytes));
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+
+        GLenum format = formatFor(image.channels);
+        glBindTexture(GL_TEXTURE_2D, image.textureID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        if (dst)
+            glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+        else
+        {
+            // Mapping failed; fall back to a client-memory upload.
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE,
+                         image.pixels.get());
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        LoadProfiler::Clock::time_point uploaded = LoadProfiler::Clock::now();
+        LoadProfiler::Record("tex-upload", image.source, start, uploaded, static_cast<size_t>(bytes));
+        glGenerateMipmap(GL_TEXTURE_2D);
+        LoadProfiler::Record("generate-mipmap", image.source, uploaded, LoadProfiler::Clock::now(),
+                             mipChainBytes(static_cast<size_t>(bytes)) - static_cast<size_t>(bytes));
+        setSamplerState(image.settings);
+        s_Data.residentBytes[image.textureID] = mipChainBytes(static_cast<size_t>(bytes));
+
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    // All faces at once; each is an independent JPEG/TGA decode (or baked
+    // chain read), so six of them keep six workers busy.
+    std::vector<CubeFace> decodeFaces(const std::vector<std::string>& paths)
+    {
+        std::vector<CubeFace> faces(paths.size());
+        ThreadPool::Get().ParallelFor(paths.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                CubeFace& face = faces[i];
+                if (TextureBaker::IsEnabled() &&
+                    TextureBaker::LoadOrBake(paths[i], TexturePlaceholder::Grey, false, face.baked))
+                    continue;
+                face.pixels.reset(TextureBaker::DecodeFile(paths[i], face.width, face.height, face.channels));
+            }
+        });
+
+        // A cube map is complete only if its faces share one format and mip
+        // count. If the baker couldn't supply six alike (a face failed to
+        // bake, or was cached with other settings), decode all of them.
+        auto matchesFirst = [&faces](const CubeFace& face) {
+            const TextureImage& first = faces[0].baked;
+            return !face.baked.levels.empty() && face.baked.InternalFormat() == first.InternalFormat() &&
+                   face.baked.width == first.width && face.baked.height == first.height &&
+                   face.baked.levels.size() == first.levels.size();
+        };
+        if (faces.empty() || std::all_of(faces.begin(), faces.end(), matchesFirst)) return faces;
+
+        ThreadPool::Get().ParallelFor(paths.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                CubeFace& face = faces[i];
+                if (face.baked.levels.empty()) continue;
+                face.baked = TextureImage();
+                face.pixels.reset(TextureBaker::DecodeFile(paths[i], face.width, face.height, face.channels));
+            }
+        });
+        return faces;
+    }
+
+    // Uploads decoded faces into the bound cube map and sets its sampler
+    // state. Returns the bytes uploaded.
+    size_t uploadFaces(const std::vector<CubeFace>& faces, const std::vector<std::string>& paths)
+    {
+        LoadProfiler::Scope scope("cube-upload", paths.empty() ? std::string() : paths[0]);
+        size_t bytes = 0;
+        GLint maxLevel = 1000;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (unsigned int i = 0; i < faces.size(); i++)
+        {
+            const CubeFace& face = faces[i];
+            const TextureImage& baked = face.baked;
+            if (!baked.levels.empty())
+            {
+                for (size_t l = 0; l < baked.levels.size(); l++)
+                {
+                    const TextureLevel& level = baked.levels[l];
+                    const unsigned char* src = baked.data.data() + level.offset;
+                    if (baked.IsCompressed())
+                        glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, static_cast<GLint>(l),
+                                               baked.InternalFormat(), level.width, level.height, 0,
+                                               static_cast<GLsizei>(level.size), src);
+                    else
+                        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, static_cast<GLint>(l), baked.InternalFormat(),
+                                     level.width, level.height, 0, baked.Format(), GL_UNSIGNED_BYTE, src);
+                }
+                maxLevel = std::min(maxLevel, static_cast<GLint>(baked.levels.size()) - 1);
+                bytes += baked.data.size();
+                continue;
+            }
+            maxLevel = 0;
+
+            if (face.pixels)
+            {
+                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, face.width, face.height, 0,
+                             formatFor(face.channels), GL_UNSIGNED_BYTE, face.pixels.get());
+                bytes += size_t(face.width) * face.height * 3;
+            }
+            else
+            {
+                std::cout << "Cubemap tex failed to load at path: " << paths[i] << std::endl;
+            }
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        // decodeFaces() hands over either six matching baked chains or six
+        // decoded faces, which have no mips.
+        if (faces.empty()) maxLevel = 0;
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, maxLevel > 0 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, maxLevel);
+        scope.AddBytes(bytes);
+        return bytes;
+    }
+
+    // Cube maps that finished decoding. Whole cube maps only, since a
+    // partially filled one is incomplete and samples black.
+    void uploadCubemaps(size_t& uploaded)
+    {
+        for (;;)
+        {
+            DecodedCubemap cubemap;
+            {
+                std::lock_guard<std::mutex> lock(s_Data.mutex);
+                if (s_Data.readyCubemaps.empty()) break;
+                size_t bytes = s_Data.readyCubemaps.front().Bytes();
+                if (uploaded > 0 && uploaded + bytes > s_Data.uploadBudget) break;
+                cubemap = std::move(s_Data.readyCubemaps.front());
+                s_Data.readyCubemaps.pop_front();
+                uploaded += bytes;
+            }
+
+            if (s_Data.releasedWhilePending.erase(cubemap.textureID))
+            {
+                glDeleteTextures(1, &cubemap.textureID);
+                s_Data.residentBytes.erase(cubemap.textureID);
+            }
+            else
+            {
+                glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap.textureID);
+                s_Data.residentBytes[cubemap.textureID] = uploadFaces(cubemap.faces, cubemap.paths);
+            }
+            finishLoad(cubemap.textureID);
+        }
+    }
+}
+
+TexturePlaceholder TextureLoader::PlaceholderFor(const std::string& typeName)
+{
+    if (typeName == "texture_normal") return TexturePlaceholder::FlatNormal;
+    if (typeName == "texture_height") return TexturePlaceholder::Black;
+    return TexturePlaceholder::Grey;
+}
+
+unsigned int TextureLoader::createPlaceholder(TexturePlaceholder placeholder, const TextureSettings& settings)
+{
+    unsigned char texel[4] = {128, 128, 128, 255};
+    if (placeholder == TexturePlaceholder::FlatNormal)
+    {
+        texel[2] = 255;
+    }
+    else if (placeholder == TexturePlaceholder::Black)
+    {
+        texel[0] = texel[1] = texel[2] = 0;
+    }
+
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    setSamplerState(settings);
+    s_Data.residentBytes[textureID] = 4;
+    s_Data.pending.insert(textureID);
+    return textureID;
+}
+
+unsigned int TextureLoader::LoadAsync(const std::string& path, const TextureSettings& settings,
+                                      TexturePlaceholder placeholder)
+{
+    std::error_code ec;
+    AssetPack::Blob packed;
+    if (!AssetPack::Find(path, packed) && !std::filesystem::is_regular_file(path, ec))
+    {
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+        return 0;
+    }
+
+    unsigned int textureID = createPlaceholder(placeholder, settings);
+    decodeAsync(textureID, path, settings, placeholder, false);
+    return textureID;
+}
+
+bool TextureLoader::Reload(unsigned int textureID, const std::string& path, const TextureSettings& settings,
+                           TexturePlaceholder placeholder)
+{
+    // The first load may still have the old bytes in flight; let it land.
+    if (s_Data.pending.count(textureID) || !s_Data.residentBytes.count(textureID)) return false;
+
+    s_Data.pending.insert(textureID);
+    decodeAsync(textureID, path, settings, placeholder, true);
+    return true;
+}
+
+void TextureLoader::decodeAsync(unsigned int textureID, const std::string& path, const TextureSettings& settings,
+                                TexturePlaceholder placeholder, bool replace)
+{
+    s_Data.inFlight++;
+    ThreadPool::Get().Submit([textureID, settings, placeholder, path, replace]() {
+        DecodedImage image;
+        image.textureID = textureID;
+        image.settings = settings;
+        image.replace = replace;
+        if (TextureBaker::IsEnabled() && TextureBaker::LoadOrBake(path, placeholder, settings.wrap == GL_REPEAT, image.baked))
+        {
+            image.width = image.baked.width;
+            image.height = image.baked.height;
+            image.channels = image.baked.channels;
+            publish(std::move(image), path);
+            return;
+        }
+        image.pixels.reset(TextureBaker::DecodeFile(path, image.width, image.height, image.channels));
+        publish(std::move(image), path);
+    });
+}
+
+unsigned int TextureLoader::LoadFromMemoryAsync(const unsigned char* data, size_t size, const TextureSettings& settings,
+                                                TexturePlaceholder placeholder)
+{
+    unsigned int textureID = createPlaceholder(placeholder, settings);
+    auto encoded = std::make_shared<std::vector<unsigned char>>(data, data + size);
+    s_Data.inFlight++;
+    ThreadPool::Get().Submit([textureID, settings, encoded]() {
+        DecodedImage image;
+        image.textureID = textureID;
+        image.settings = settings;
+        image.pixels.reset(stbi_load_from_memory(encoded->data(), static_cast<int>(encoded->size()), &image.width,
+                                                 &image.height, &image.channels, 0));
+        publish(std::move(image), "embedded memory");
+    });
+    return textureID;
+}
+
+void TextureLoader::Update()
+{
+    size_t uploaded = 0;
+    for (;;)
+    {
+        DecodedImage image;
+        {
+            std::lock_guard<std::mutex> lock(s_Data.mutex);
+            if (s_Data.ready.empty()) break;
+
+            // Baked chains only cost their tail here; the rest streams below.
+            bool baked = !s_Data.ready.front().baked.levels.empty();
+            size_t bytes = baked ? 0 : s_Data.ready.front().Bytes();
+            if (uploaded > 0 && uploaded + bytes > s_Data.uploadBudget) break;
+
+            if (!baked && s_Data.ready.front().IsValid())
+            {
+                if (!acquireSlot(s_Data.slots[s_Data.nextSlot])) break;
+            }
+            image = std::move(s_Data.ready.front());
+            s_Data.ready.pop_front();
+            uploaded += bytes;
+        }
+
+        if (image.replace && image.IsValid() && !s_Data.releasedWhilePending.count(image.textureID) &&
+            replaceImage(image, uploaded))
+        {
+            finishLoad(image.textureID);
+            continue;
+        }
+
+        if (s_Data.releasedWhilePending.erase(image.textureID))
+        {
+            glDeleteTextures(1, &image.textureID);
+            s_Data.residentBytes.erase(image.textureID);
+        }
+        else if (!image.baked.levels.empty())
+        {
+            StreamingTexture texture;
+            texture.textureID = image.textureID;
+            texture.image = std::move(image.baked);
+            texture.source = std::move(image.source);
+            uploaded += beginStreaming(texture, image.settings);
+            if (texture.residentLevel > 0)
+            {
+                s_Data.streaming.push_back(std::move(texture));
+                continue;
+            }
+        }
+        else if (image.IsValid())
+        {
+            upload(image, s_Data.slots[s_Data.nextSlot]);
+            s_Data.nextSlot = (s_Data.nextSlot + 1) % kSlotCount;
+        }
+        finishLoad(image.textureID);
+    }
+
+    uploadCubemaps(uploaded);
+    streamLevels(uploaded);
+}
+
+unsigned int TextureLoader::LoadCubemap(const std::vector<std::string>& faces)
+{
+    std::vector<CubeFace> decoded = decodeFaces(faces);
+
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+    s_Data.residentBytes[textureID] = uploadFaces(decoded, faces);
+    return textureID;
+}
+
+unsigned int TextureLoader::LoadCubemapAsync(const std::vector<std::string>& faces)
+{
+    // 1x1 grey faces keep the cube map complete until the real ones land.
+    const unsigned char grey[3] = {128, 128, 128};
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+    for (unsigned int i = 0; i < 6; i++)
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, grey);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, 0);
+    s_Data.residentBytes[textureID] = 18;
+    s_Data.pending.insert(textureID);
+
+    s_Data.inFlight++;
+    ThreadPool::Get().Submit([textureID, faces]() {
+        DecodedCubemap cubemap;
+        cubemap.textureID = textureID;
+        cubemap.paths = faces;
+        cubemap.faces = decodeFaces(faces);
+        std::lock_guard<std::mutex> lock(s_Data.mutex);
+        s_Data.readyCubemaps.push_back(std::move(cubemap));
+    });
+    return textureID;
+}
+
+unsigned int TextureLoader::LoadEnvironment(const std::vector<std::string>& faces)
+{
+    std::vector<TextureImage> chains;
+    if (!EnvironmentPrefilter::LoadOrBake(faces, chains)) return 0;
+
+    std::vector<CubeFace> decoded(chains.size());
+    for (size_t i = 0; i < chains.size(); i++) decoded[i].baked = std::move(chains[i]);
+
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+    s_Data.residentBytes[textureID] = uploadFaces(decoded, faces);
+    return textureID;
+}
+
+void TextureLoader::Release(unsigned int textureID)
+{
+    if (textureID == 0) return;
+    if (s_Data.pending.count(textureID))
+    {
+        s_Data.releasedWhilePending.insert(textureID);
+        return;
+    }
+    glDeleteTextures(1, &textureID);
+    s_Data.residentBytes.erase(textureID);
+}
+
+size_t TextureLoader::ResidentBytes(unsigned int textureID)
+{
+    auto it = s_Data.residentBytes.find(textureID);
+    return it == s_Data.residentBytes.end() ? 0 : it->second;
+}
+
+void TextureLoader::Flush()
+{
+    while (s_Data.inFlight.load() > 0)
+    {
+        size_t before = s_Data.inFlight.load();
+        Update();
+        if (s_Data.inFlight.load() == before)
+        {
+            // Make sure pending fences actually reach the GPU before waiting.
+            glFlush();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+void TextureLoader::Shutdown()
+{
+    s_Data.streaming.clear();
+    for (UploadSlot& slot : s_Data.slots)
+    {
+        if (slot.fence) glDeleteSync(slot.fence);
+        if (slot.pbo) glDeleteBuffers(1, &slot.pbo);
+        slot = UploadSlot{};
+    }
+    s_Data.nextSlot = 0;
+}
+
+void TextureLoader::SetUploadBudget(size_t bytesPerFrame)
+{
+    s_Data.uploadBudget = bytesPerFrame;
+}
+
+bool TextureLoader::IsPending(unsigned int textureID)
+{
+    return s_Data.pending.count(textureID) != 0;
+}
+
+size_t TextureLoader::PendingCount()
+{
+    return s_Data.inFlight.load();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// What a texture shows until its real image has been decoded and uploaded.
+enum class TexturePlaceholder {
+    Grey,
+    FlatNormal,
+    Black
+};
+
+// Sampler state applied once the image is uploaded. Part of the TextureCache key,
+// since two users with different settings can't share one texture object.
+struct TextureSettings {
+    GLenum wrap = GL_REPEAT;
+    GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR;
+    GLenum magFilter = GL_LINEAR;
+
+    bool operator==(const TextureSettings& other) const
+    {
+        return wrap == other.wrap && minFilter == other.minFilter && magFilter == other.magFilter;
+    }
+};
+
+// Texture loading service. Decoding runs on the shared ThreadPool; the GL thread
+// streams finished images into their textures through a ring of pixel buffer
+// objects guarded by fences. The returned texture name is valid immediately and
+// keeps the same id once the real image replaces the placeholder.
+//
+// Baked mip chains are streamed progressively: the texture gets storage for the
+// whole chain, the smallest levels go up at once, and finer levels follow over
+// later frames with GL_TEXTURE_BASE_LEVEL/MIN_LOD clamped to what is resident.
+class TextureLoader
+{
+public:
+    static unsigned int LoadAsync(const std::string& path, const TextureSettings& settings = {},
+                                  TexturePlaceholder placeholder = TexturePlaceholder::Grey);
+    // Decodes `path` again into an existing texture, which keeps showing its
+    // current image until Update() replaces it whole. False while the texture
+    // is still loading.
+    static bool Reload(unsigned int textureID, const std::string& path, const TextureSettings& settings,
+                       TexturePlaceholder placeholder);
+    // The encoded bytes are copied, so the caller's buffer may go away.
+    static unsigned int LoadFromMemoryAsync(const unsigned char* data, size_t size, const TextureSettings& settings = {},
+                                            TexturePlaceholder placeholder = TexturePlaceholder::Grey);
+    // Faces in GL_TEXTURE_CUBE_MAP_POSITIVE_X order, decoded in parallel.
+    // Returns once the cube map is uploaded.
+    static unsigned int LoadCubemap(const std::vector<std::string>& faces);
+    // Same, but decoding runs in the background and the cube map shows grey
+    // until Update() uploads it, whole, within the frame budget.
+    static unsigned int LoadCubemapAsync(const std::vector<std::string>& faces);
+    // GGX-prefiltered roughness chain of the faces (see EnvironmentPrefilter),
+    // baked or read from the bake cache before returning. 0 on failure.
+    static unsigned int LoadEnvironment(const std::vector<std::string>& faces);
+
+    // Deletes the texture, deferring until its pending upload has landed.
+    static void Release(unsigned int textureID);
+    // GPU bytes currently held by a texture created through this loader.
+    static size_t ResidentBytes(unsigned int textureID);
+
+    // GL thread, once per frame. Uploads at most the per-frame byte budget
+    // (always at least one image or mip level) and never waits on the GPU.
+    static void Update();
+    // Blocks until every outstanding load has been uploaded, all levels included.
+    static void Flush();
+    static void Shutdown();
+
+    static void SetUploadBudget(size_t bytesPerFrame);
+    static size_t PendingCount();
+    // True while the texture still shows its placeholder or streams levels.
+    static bool IsPending(unsigned int textureID);
+
+    static TexturePlaceholder PlaceholderFor(const std::string& typeName);
+
+private:
+    static unsigned int createPlaceholder(TexturePlaceholder placeholder, const TextureSettings& settings);
+    static void decodeAsync(unsigned int textureID, const std::string& path, const TextureSettings& settings,
+                            TexturePlaceholder placeholder, bool replace);
+};